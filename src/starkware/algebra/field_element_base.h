@@ -26,11 +26,12 @@ class FieldElementBase {
   Derived operator/(const Derived& other) const;
   constexpr bool operator!=(const Derived& other) const;
 
-  static std::vector<Derived> UninitializedVector(size_t size) {
+  template <typename Allocator = std::allocator<Derived>>
+  static std::vector<Derived, Allocator> UninitializedVector(size_t size) {
 #ifdef NDEBUG
-    return std::vector<Derived>(size);  // for faster memory allocation.
+    return std::vector<Derived, Allocator>(size);  // for faster memory allocation.
 #else
-    return std::vector<Derived>(size, Derived::Uninitialized());
+    return std::vector<Derived, Allocator>(size, Derived::Uninitialized());
 #endif
   }
 
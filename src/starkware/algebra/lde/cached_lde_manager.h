@@ -8,6 +8,7 @@
 #include "starkware/algebra/fields/base_field_element.h"
 #include "starkware/algebra/fields/extension_field_element.h"
 #include "starkware/algebra/lde/lde_manager.h"
+#include "starkware/utils/large_buffer_allocator.h"
 #include "starkware/utils/maybe_owned_ptr.h"
 
 namespace starkware {
@@ -15,24 +16,30 @@ namespace starkware {
 /*
   A wrapper class for LdeManager. Caches EvalOnCoset calls.
   Cached results are used for future EvalOnCoset calls as well as for EvalAtPoints function calls.
+
+  If store_full_lde is false, coset evaluations are not kept in memory. Instead, a coset is
+  recomputed whenever it is needed, which bounds the peak memory to the cosets that are currently in
+  use by the caller, at the cost of repeating the FFTs.
 */
 template <typename FieldElementT>
 class CachedLdeManager {
+ public:
   /*
     LdeCacheEntry is a vector of n_columns_ vectors. Each FieldElementT vector is the same size as
     the trace domain. The first LdeCacheEntry index specifies the column, the second index specifies
-    the entry in the coset.
+    the entry in the coset. The columns are allocated with LargeBufferAllocator, so they may be
+    backed by huge pages.
   */
-  using LdeCacheEntry = std::vector<std::vector<FieldElementT>>;
+  using LdeCacheEntry = std::vector<LargeBufferVector<FieldElementT>>;
 
- public:
   CachedLdeManager(
       MaybeOwnedPtr<LdeManager<FieldElementT>> lde_manager,
-      std::vector<BaseFieldElement>&& coset_offsets)
+      std::vector<BaseFieldElement>&& coset_offsets, bool store_full_lde = true)
       : lde_manager_(std::move(lde_manager)),
         coset_offsets_(std::move(coset_offsets)),
         eval_in_natural_order_(lde_manager_->IsEvalNaturallyOrdered()),
         domain_size_(lde_manager_->GetDomainSize()),
+        store_full_lde_(store_full_lde),
         cache_(coset_offsets_.size()) {
     ASSERT_RELEASE(!coset_offsets_.empty(), "At least one coset offset is required.");
   }
@@ -62,9 +69,17 @@ class CachedLdeManager {
   */
   const LdeCacheEntry* EvalOnCoset(uint64_t coset_index);
 
+  /*
+    Same as EvalOnCoset(coset_index), but if store_full_lde is false, the coset is evaluated into
+    storage instead of the cache (storage is allocated if it is not of the correct size), and a
+    pointer to storage is returned. Reusing the same storage across calls avoids reallocations.
+  */
+  const LdeCacheEntry* EvalOnCoset(uint64_t coset_index, LdeCacheEntry* storage);
+
   /*
     Evaluates all columns at the given cosets and points. Takes pairs of (coset_index, point_index).
-    Note: this is a cached version, all requested cosets must already be cached.
+    Note: if store_full_lde is true, this is a cached version, and all requested cosets must already
+    be cached. Otherwise, each requested coset is recomputed once.
   */
   void EvalAtPoints(
       gsl::span<const std::pair<uint64_t, uint64_t>> coset_and_point_indices,
@@ -81,6 +96,7 @@ class CachedLdeManager {
   /*
     Indicates that no new uncached evaluations will occur anymore.
     This includes calls to EvalAtPointsNotCached() and EvalAtPoints() on a new uncached coset.
+    If store_full_lde is false, cosets are still recomputed on demand after this call.
   */
   void FinalizeEvaluations();
 
@@ -114,7 +130,9 @@ class CachedLdeManager {
   const std::vector<BaseFieldElement> coset_offsets_;
   const bool eval_in_natural_order_;
   const uint64_t domain_size_;
+  const bool store_full_lde_;
   bool done_adding_ = false;
+  bool done_evaluating_ = false;
   size_t n_columns_ = 0;
 
   /*
@@ -122,6 +140,7 @@ class CachedLdeManager {
     Indices are: coset_index, column_index, point_index.
 
     Vector items are optional, where nullopt means that the coset was not cached yet.
+    If store_full_lde_ is false, all the items are nullopt.
   */
   std::vector<std::optional<LdeCacheEntry>> cache_;
 };
@@ -1,5 +1,7 @@
 #include "starkware/algebra/lde/cached_lde_manager.h"
 
+#include <map>
+
 #include "starkware/utils/bit_reversal.h"
 
 namespace starkware {
@@ -7,6 +9,14 @@ namespace starkware {
 template <typename FieldElementT>
 const typename CachedLdeManager<FieldElementT>::LdeCacheEntry*
 CachedLdeManager<FieldElementT>::EvalOnCoset(uint64_t coset_index) {
+  ASSERT_RELEASE(
+      store_full_lde_, "EvalOnCoset() without storage requires store_full_lde to be true.");
+  return EvalOnCoset(coset_index, nullptr);
+}
+
+template <typename FieldElementT>
+const typename CachedLdeManager<FieldElementT>::LdeCacheEntry*
+CachedLdeManager<FieldElementT>::EvalOnCoset(uint64_t coset_index, LdeCacheEntry* storage) {
   ASSERT_RELEASE(done_adding_, "Must call FinalizeAdding() before calling EvalOnCoset().");
   ASSERT_RELEASE(coset_index < cache_.size(), "Coset index out of bounds.");
 
@@ -19,17 +29,29 @@ CachedLdeManager<FieldElementT>::EvalOnCoset(uint64_t coset_index) {
       lde_manager_.HasValue(),
       "Cannot evaluate new values after FinalizeEvaluations() was called.");
 
-  // Allocate a new cache entry.
-  cache_[coset_index] = AllocateEntry();
-  LdeCacheEntry* storage = &*cache_[coset_index];
+  if (store_full_lde_) {
+    // Allocate a new cache entry.
+    cache_[coset_index] = AllocateEntry();
+    storage = &*cache_[coset_index];
+  } else {
+    // Reuse the given storage if it has the correct shape.
+    ASSERT_RELEASE(storage != nullptr, "Storage must be given when store_full_lde is false.");
+    bool is_allocated = storage->size() == n_columns_;
+    for (const auto& column : *storage) {
+      is_allocated = is_allocated && column.size() == domain_size_;
+    }
+    if (!is_allocated) {
+      *storage = AllocateEntry();
+    }
+  }
   ASSERT_RELEASE(storage != nullptr, "Invalid storage");
 
-  // Evaluate on columns, store result in the new cache entry.
+  // Evaluate on columns, store result in the storage.
   const BaseFieldElement& coset_offset = coset_offsets_.at(coset_index);
   lde_manager_->EvalOnCoset(
       coset_offset, std::vector<gsl::span<FieldElementT>>(storage->begin(), storage->end()));
 
-  // Return a pointer to the cache entry containing the result.
+  // Return a pointer to the storage containing the result.
   return storage;
 }
 
@@ -45,23 +67,45 @@ void CachedLdeManager<FieldElementT>::EvalAtPoints(
         "Number of output points is different than number of input points.");
   }
 
-  // Look up values in cache and fill the outputs.
-  for (size_t i = 0; i < coset_and_point_indices.size(); ++i) {
-    const auto& [coset_index, point_index] = coset_and_point_indices[i];
-
-    // Check that the requested coset is cached and the point index is valid.
-    ASSERT_RELEASE(
-        cache_[coset_index].has_value(), "EvalAtPoints requested a coset that is not cached!");
+  // Copies the values of the i-th requested point from a coset evaluation to the outputs.
+  const auto copy_point = [&](size_t i, const LdeCacheEntry& coset_eval) {
+    const uint64_t point_index = coset_and_point_indices[i].second;
     ASSERT_RELEASE(point_index < domain_size_, "Point index out of range.");
 
     // Bit-reverse point_index if needed.
     const uint64_t fixed_point_index =
         eval_in_natural_order_ ? BitReverse(point_index, SafeLog2(domain_size_)) : point_index;
 
-    // Copy cached values.
     for (size_t column_index = 0; column_index < n_columns_; ++column_index) {
-      outputs.at(column_index).at(i) = (*cache_[coset_index])[column_index].at(fixed_point_index);
+      outputs.at(column_index).at(i) = coset_eval[column_index].at(fixed_point_index);
     }
+  };
+
+  if (!store_full_lde_) {
+    // Group the requested points by coset, and recompute each requested coset once.
+    std::map<uint64_t, std::vector<size_t>> coset_to_point_indices;
+    for (size_t i = 0; i < coset_and_point_indices.size(); ++i) {
+      coset_to_point_indices[coset_and_point_indices[i].first].push_back(i);
+    }
+
+    LdeCacheEntry storage;
+    for (const auto& [coset_index, indices] : coset_to_point_indices) {
+      const LdeCacheEntry* coset_eval = EvalOnCoset(coset_index, &storage);
+      for (const size_t i : indices) {
+        copy_point(i, *coset_eval);
+      }
+    }
+    return;
+  }
+
+  // Look up values in cache and fill the outputs.
+  for (size_t i = 0; i < coset_and_point_indices.size(); ++i) {
+    const uint64_t coset_index = coset_and_point_indices[i].first;
+
+    // Check that the requested coset is cached.
+    ASSERT_RELEASE(
+        cache_[coset_index].has_value(), "EvalAtPoints requested a coset that is not cached!");
+    copy_point(i, *cache_[coset_index]);
   }
 }
 
@@ -70,7 +114,7 @@ void CachedLdeManager<FieldElementT>::EvalAtPointsNotCached(
     size_t column_index, gsl::span<const ExtensionFieldElement> points,
     gsl::span<ExtensionFieldElement> output) {
   ASSERT_RELEASE(
-      lde_manager_.HasValue(),
+      lde_manager_.HasValue() && !done_evaluating_,
       "Cannot evaluate new values after FinalizeEvaluations() was called.");
   lde_manager_->EvalAtPoints(column_index, points, output);
 }
@@ -82,7 +126,9 @@ CachedLdeManager<FieldElementT>::AllocateEntry() const {
   const uint64_t coset_size = domain_size_;
   entry.reserve(n_columns_);
   for (size_t i = 0; i < n_columns_; ++i) {
-    entry.push_back(FieldElementT::UninitializedVector(coset_size));
+    entry.push_back(
+        FieldElementT::template UninitializedVector<LargeBufferAllocator<FieldElementT>>(
+            coset_size));
   }
   return entry;
 }
@@ -90,7 +136,11 @@ CachedLdeManager<FieldElementT>::AllocateEntry() const {
 template <typename FieldElementT>
 void CachedLdeManager<FieldElementT>::FinalizeEvaluations() {
   ASSERT_RELEASE(done_adding_, "Must call FinalizeAdding() before calling FinalizeEvaluations().");
-  lde_manager_.reset();
+  done_evaluating_ = true;
+  if (store_full_lde_) {
+    // All the cosets that will be needed are already cached, the LDE manager may be released.
+    lde_manager_.reset();
+  }
 }
 
 }  // namespace starkware
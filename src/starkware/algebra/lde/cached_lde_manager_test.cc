@@ -13,6 +13,7 @@ namespace starkware {
 namespace {
 
 using testing::_;
+using testing::ElementsAreArray;
 using testing::HasSubstr;
 using testing::StrictMock;
 
@@ -103,7 +104,7 @@ void CachedLdeManagerTest::StartTest() {
     // Test that we got the correct evaluation.
     ASSERT_EQ(result->size(), n_columns_);
     for (size_t column_index = 0; column_index < n_columns_; ++column_index) {
-      ASSERT_EQ((*result)[column_index], coset_evaluation[column_index]);
+      ASSERT_THAT((*result)[column_index], ElementsAreArray(coset_evaluation[column_index]));
     }
   }
 
@@ -117,7 +118,8 @@ TEST_F(CachedLdeManagerTest, EvalOnCoset_Cache) {
     auto result = cached_lde_manager_.EvalOnCoset(coset_index);
     ASSERT_EQ(result->size(), n_columns_);
     for (size_t column_index = 0; column_index < n_columns_; ++column_index) {
-      ASSERT_EQ((*result)[column_index], evaluations_[coset_index][column_index]);
+      ASSERT_THAT(
+          (*result)[column_index], ElementsAreArray(evaluations_[coset_index][column_index]));
     }
   }
 }
@@ -175,5 +177,45 @@ TEST_F(CachedLdeManagerTest, ComputeAfterFinalizeEvaluations) {
       HasSubstr("FinalizeEvaluations()"));
 }
 
+TEST(CachedLdeManager, NoStoreFullLde) {
+  const size_t coset_size = 16;
+  const size_t n_cosets = 4;
+  Prng prng;
+  const auto offsets = prng.RandomFieldElementVector<BaseFieldElement>(n_cosets);
+  StrictMock<LdeManagerMock> lde_manager(coset_size, BaseFieldElement::RandomElement(&prng));
+  CachedLdeManager<BaseFieldElement> cached_lde_manager(
+      UseOwned(&lde_manager), {offsets.begin(), offsets.end()}, /*store_full_lde=*/false);
+
+  const auto evaluation = prng.RandomFieldElementVector<BaseFieldElement>(coset_size);
+  EXPECT_CALL(lde_manager, AddEvaluation(_));
+  cached_lde_manager.AddEvaluation(gsl::span<const BaseFieldElement>(evaluation));
+  cached_lde_manager.FinalizeAdding();
+  cached_lde_manager.FinalizeEvaluations();
+
+  // Without storage, EvalOnCoset() is not supported.
+  EXPECT_ASSERT(cached_lde_manager.EvalOnCoset(0), HasSubstr("store_full_lde"));
+
+  // Cosets are recomputed on every call, into the given storage.
+  const std::vector<std::vector<BaseFieldElement>> coset_evaluation = {
+      prng.RandomFieldElementVector<BaseFieldElement>(coset_size)};
+  CachedLdeManager<BaseFieldElement>::LdeCacheEntry storage;
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_CALL(lde_manager, EvalOnCoset(offsets[1], _)).WillOnce(SetEvaluation(coset_evaluation));
+    const auto* result = cached_lde_manager.EvalOnCoset(1, &storage);
+    EXPECT_EQ(result, &storage);
+    ASSERT_EQ(result->size(), 1U);
+    EXPECT_THAT((*result)[0], ElementsAreArray(coset_evaluation[0]));
+  }
+
+  // EvalAtPoints() recomputes each requested coset once.
+  const std::vector<std::pair<uint64_t, uint64_t>> coset_point_indices = {{1, 3}, {1, 7}};
+  std::vector<BaseFieldElement> output = BaseFieldElement::UninitializedVector(2);
+  EXPECT_CALL(lde_manager, EvalOnCoset(offsets[1], _)).WillOnce(SetEvaluation(coset_evaluation));
+  cached_lde_manager.EvalAtPoints(
+      coset_point_indices, std::vector<gsl::span<BaseFieldElement>>{gsl::make_span(output)});
+  EXPECT_EQ(output[0], coset_evaluation[0][3]);
+  EXPECT_EQ(output[1], coset_evaluation[0][7]);
+}
+
 }  // namespace
 }  // namespace starkware
@@ -1,5 +1,7 @@
 #include "starkware/algebra/lde/lde_manager.h"
 
+#include <algorithm>
+
 #include "third_party/cppitertools/zip.hpp"
 
 #include "starkware/algebra/fft/fft.h"
@@ -102,7 +104,7 @@ void LdeManager<FieldElementT>::EvalAtPoints(
   const std::vector<FieldElementT>& polynomial_in_natural_order =
       eval_in_natural_order_ ? polynomials_natural_order_coefficients_vector_[evaluation_idx]
                              : polynomials_vector_[evaluation_idx];
-  BatchHornerEval<ExtFieldElementT, FieldElementT>(
+  ParallelBatchHornerEval<ExtFieldElementT, FieldElementT>(
       fixed_points, polynomial_in_natural_order, outputs);
 }
 
@@ -112,12 +114,18 @@ int64_t LdeManager<FieldElementT>::GetEvaluationDegree(size_t evaluation_idx) co
   const std::vector<FieldElementT>& polynomial_in_natural_order =
       eval_in_natural_order_ ? polynomials_natural_order_coefficients_vector_[evaluation_idx]
                              : polynomials_vector_[evaluation_idx];
-  for (int64_t deg = polynomial_in_natural_order.size() - 1; deg >= 0; deg--) {
-    if (polynomial_in_natural_order[deg] != FieldElementT::Zero()) {
-      return deg;
-    }
+  const int64_t size = polynomial_in_natural_order.size();
+  // Typically the leading coefficient is nonzero. Otherwise, find the last nonzero coefficient.
+  if (size == 0 || polynomial_in_natural_order[size - 1] != FieldElementT::Zero()) {
+    return size - 1;
   }
-  return -1;
+  return TaskManager::GetInstance().ParallelReduce(
+      0, size - 1, int64_t(-1),
+      [&polynomial_in_natural_order](uint64_t i) {
+        return polynomial_in_natural_order[i] != FieldElementT::Zero() ? static_cast<int64_t>(i)
+                                                                        : int64_t(-1);
+      },
+      [](int64_t a, int64_t b) { return std::max(a, b); });
 }
 
 template <typename FieldElementT>
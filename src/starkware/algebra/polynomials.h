@@ -5,6 +5,8 @@
 
 #include "third_party/gsl/gsl-lite.hpp"
 
+#include "starkware/utils/task_manager.h"
+
 namespace starkware {
 
 /*
@@ -26,6 +28,19 @@ void BatchHornerEval(
     gsl::span<const FieldElementPoints> points, gsl::span<const FieldElementCoefs> coefs,
     gsl::span<FieldElementPoints> outputs);
 
+/*
+  Same as BatchHornerEval(), but splits the coefficients into consecutive chunks of at least
+  min_chunk_size coefficients, evaluates the chunks in parallel and combines the results:
+    p(x) = p_0(x) + x^c * p_1(x) + x^(2c) * p_2(x) + ...
+  where c is the chunk size and p_i is the polynomial defined by the i-th chunk. The chunks are
+  evaluated on the threads of task_manager.
+*/
+template <typename FieldElementPoints, typename FieldElementCoefs>
+void ParallelBatchHornerEval(
+    gsl::span<const FieldElementPoints> points, gsl::span<const FieldElementCoefs> coefs,
+    gsl::span<FieldElementPoints> outputs, uint64_t min_chunk_size = 4096,
+    TaskManager* task_manager = &TaskManager::GetInstance());
+
 }  // namespace starkware
 
 #include "starkware/algebra/polynomials.inl"
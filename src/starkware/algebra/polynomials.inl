@@ -1,4 +1,7 @@
+#include <algorithm>
+
 #include "starkware/algebra/field_operations.h"
+#include "starkware/math/math.h"
 
 namespace starkware {
 
@@ -31,4 +34,46 @@ void BatchHornerEval(
   }
 }
 
+template <typename FieldElementPoints, typename FieldElementCoefs>
+void ParallelBatchHornerEval(
+    gsl::span<const FieldElementPoints> points, gsl::span<const FieldElementCoefs> coefs,
+    gsl::span<FieldElementPoints> outputs, uint64_t min_chunk_size, TaskManager* task_manager) {
+  ASSERT_RELEASE(min_chunk_size > 0, "min_chunk_size must be positive.");
+  const uint64_t max_n_chunks = std::min<uint64_t>(
+      task_manager->GetNumThreads(), std::max<uint64_t>(coefs.size() / min_chunk_size, 1));
+  if (max_n_chunks <= 1) {
+    BatchHornerEval<FieldElementPoints, FieldElementCoefs>(points, coefs, outputs);
+    return;
+  }
+  ASSERT_RELEASE(
+      points.size() == outputs.size(),
+      "The number of outputs must be the same as the number of points.");
+
+  const uint64_t chunk_size = DivCeil(coefs.size(), max_n_chunks);
+  const uint64_t n_chunks = DivCeil(coefs.size(), chunk_size);
+
+  // Evaluate each chunk separately. chunk_outputs[i] holds the evaluations of the i-th chunk.
+  std::vector<std::vector<FieldElementPoints>> chunk_outputs(n_chunks);
+  task_manager->ParallelFor(
+      n_chunks, [&points, &coefs, &chunk_outputs, chunk_size](const TaskInfo& task_info) {
+        const uint64_t chunk_idx = task_info.start_idx;
+        const uint64_t chunk_start = chunk_idx * chunk_size;
+        const uint64_t chunk_end = std::min<uint64_t>(chunk_start + chunk_size, coefs.size());
+        chunk_outputs[chunk_idx] = FieldElementPoints::UninitializedVector(points.size());
+        BatchHornerEval<FieldElementPoints, FieldElementCoefs>(
+            points, coefs.subspan(chunk_start, chunk_end - chunk_start),
+            chunk_outputs[chunk_idx]);
+      });
+
+  // Combine the chunk evaluations using Horner's rule with x^chunk_size.
+  for (size_t point_idx = 0; point_idx < points.size(); ++point_idx) {
+    const FieldElementPoints shift = Pow(points[point_idx], chunk_size);
+    FieldElementPoints res = FieldElementPoints::Zero();
+    for (uint64_t chunk_idx = n_chunks; chunk_idx-- > 0;) {
+      res = res * shift + chunk_outputs[chunk_idx][point_idx];
+    }
+    outputs[point_idx] = res;
+  }
+}
+
 }  // namespace starkware
@@ -36,5 +36,24 @@ TEST(BatchHornerEval, Correctness) {
   }
 }
 
+TEST(ParallelBatchHornerEval, Correctness) {
+  Prng prng;
+  // With 4 threads and at least 5 * min_chunk_size coefficients, the coefficients are split into 4
+  // chunks that are evaluated in parallel.
+  TaskManager task_manager = TaskManager::CreateInstanceForTesting(4);
+  const size_t min_chunk_size = prng.UniformInt(1, 10);
+  const size_t n_coefs = prng.UniformInt<size_t>(5 * min_chunk_size, 100);
+  const auto coefs = prng.RandomFieldElementVector<BaseFieldElement>(n_coefs);
+
+  const size_t n_points = prng.UniformInt(1, 10);
+  const auto points = prng.RandomFieldElementVector<BaseFieldElement>(n_points);
+  std::vector<BaseFieldElement> results(n_points, BaseFieldElement::Zero());
+  ParallelBatchHornerEval<BaseFieldElement, BaseFieldElement>(
+      points, coefs, results, min_chunk_size, &task_manager);
+  for (size_t i = 0; i < n_points; ++i) {
+    ASSERT_EQ(HornerEval(points[i], coefs), results[i]);
+  }
+}
+
 }  // namespace
 }  // namespace starkware
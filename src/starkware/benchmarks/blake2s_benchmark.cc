@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "starkware/crypt_tools/blake2s_160.h"
+#include "starkware/crypt_tools/blake2s_many.h"
+#include "starkware/randomness/prng.h"
+#include "starkware/utils/serialization.h"
+
+/*
+  Benchmarks of hashing Merkle tree nodes (two digests, 40 bytes), and of the proof of work search.
+  Each reports the number of nodes (or nonces) hashed per second (items_per_second).
+*/
+
+namespace starkware {
+namespace {
+
+constexpr size_t kNNodes = 1 << 16;
+constexpr uint64_t kNNonces = 1 << 16;
+
+/*
+  Hashes a node with the streaming API of Blake2s, as Blake2s160::Hash() did before it had a
+  dedicated path for nodes.
+*/
+Blake2s160 HashNodeStreaming(const Blake2s160& val1, const Blake2s160& val2) {
+  std::array<std::byte, 2 * Blake2s160::kDigestNumBytes> data{};
+  std::copy(val1.GetDigest().begin(), val1.GetDigest().end(), data.begin());
+  std::copy(
+      val2.GetDigest().begin(), val2.GetDigest().end(), data.begin() + Blake2s160::kDigestNumBytes);
+  return Blake2s160::HashBytesWithLength(data);
+}
+
+/*
+  Hashes kNNodes nodes in a chain (each node is the hash of the previous one and a random digest),
+  so the hashes cannot be computed in parallel.
+*/
+template <typename HashFunc>
+void HashNodeChain(benchmark::State& state, const HashFunc& hash_func) {
+  Prng prng;
+  std::vector<Blake2s160> digests(kNNodes);
+  for (Blake2s160& digest : digests) {
+    digest = prng.RandomHash();
+  }
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    Blake2s160 node = digests[0];
+    for (const Blake2s160& digest : digests) {
+      node = hash_func(node, digest);
+    }
+    benchmark::DoNotOptimize(node);
+  }
+  state.SetItemsProcessed(state.iterations() * kNNodes);
+}
+
+static void Blake2sNodeStreamingBenchmark(benchmark::State& state) {  // NOLINT
+  HashNodeChain(state, HashNodeStreaming);
+}
+
+static void Blake2sNodeHashBenchmark(benchmark::State& state) {  // NOLINT
+  HashNodeChain(state, Blake2s160::Hash);
+}
+
+/*
+  Hashes kNNodes independent nodes with HashMany(). state.range(0) is the backend.
+*/
+static void Blake2sNodeHashManyBenchmark(benchmark::State& state) {  // NOLINT
+  const auto backend = static_cast<blake2s_many::Backend>(state.range(0));
+  if (!blake2s_many::IsSupported(backend)) {
+    state.SkipWithError("The CPU does not support the backend.");
+    return;
+  }
+  Prng prng;
+  const std::vector<std::byte> data =
+      prng.RandomByteVector(kNNodes * 2 * Blake2s160::kDigestNumBytes);
+  std::vector<Blake2s160> output(kNNodes);
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    blake2s_many::HashMany(data, 2 * Blake2s160::kDigestNumBytes, output, backend);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNNodes);
+}
+
+/*
+  Searches kNNonces nonces for a proof of work that is not found, by hashing the input of each nonce
+  with the streaming API of Blake2s, as the proof of work prover did before it used SearchNonce().
+*/
+static void Blake2sSearchNonceStreamingBenchmark(benchmark::State& state) {  // NOLINT
+  Prng prng;
+  const Blake2s160 prefix = prng.RandomHash();
+  std::array<std::byte, Blake2s160::kDigestNumBytes + sizeof(uint64_t)> input{};
+  std::copy(prefix.GetDigest().begin(), prefix.GetDigest().end(), input.begin());
+  const auto nonce_span = gsl::make_span(input).last(sizeof(uint64_t));
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    for (uint64_t nonce = 0; nonce < kNNonces; ++nonce) {
+      Serialize(nonce, nonce_span);
+      const Blake2s160 hash = Blake2s160::HashBytesWithLength(input);
+      benchmark::DoNotOptimize(hash);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNNonces);
+}
+
+/*
+  Searches kNNonces nonces for a proof of work that is not found, with SearchNonce(). state.range(0)
+  is the backend.
+*/
+static void Blake2sSearchNonceBenchmark(benchmark::State& state) {  // NOLINT
+  const auto backend = static_cast<blake2s_many::Backend>(state.range(0));
+  if (!blake2s_many::IsSupported(backend)) {
+    state.SkipWithError("The CPU does not support the backend.");
+    return;
+  }
+  Prng prng;
+  const Blake2s160 prefix = prng.RandomHash();
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(blake2s_many::SearchNonce(prefix, 0, kNNonces, 64, backend));
+  }
+  state.SetItemsProcessed(state.iterations() * kNNonces);
+}
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sNodeStreamingBenchmark);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sNodeHashBenchmark);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sNodeHashManyBenchmark)
+    ->Arg(static_cast<int>(blake2s_many::Backend::kReference))
+    ->Arg(static_cast<int>(blake2s_many::Backend::kAvx2))
+    ->Arg(static_cast<int>(blake2s_many::Backend::kAvx512));
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sSearchNonceStreamingBenchmark);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sSearchNonceBenchmark)
+    ->Arg(static_cast<int>(blake2s_many::Backend::kReference))
+    ->Arg(static_cast<int>(blake2s_many::Backend::kAvx2))
+    ->Arg(static_cast<int>(blake2s_many::Backend::kAvx512));
+
+}  // namespace
+}  // namespace starkware
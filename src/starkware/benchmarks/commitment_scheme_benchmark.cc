@@ -0,0 +1,159 @@
+#include <map>
+#include <set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "starkware/algebra/fields/base_field_element.h"
+#include "starkware/channel/prover_channel.h"
+#include "starkware/channel/verifier_channel.h"
+#include "starkware/commitment_scheme/commitment_scheme_builder.h"
+#include "starkware/commitment_scheme/merkle/merkle.h"
+#include "starkware/commitment_scheme/table_prover_impl.h"
+#include "starkware/crypt_tools/blake2s_160.h"
+#include "starkware/crypt_tools/keccak_256.h"
+#include "starkware/math/math.h"
+#include "starkware/randomness/prng.h"
+#include "starkware/utils/maybe_owned_ptr.h"
+
+/*
+  Benchmarks of committing to a table with each of the hashes of the commitment scheme, and to a
+  table of field elements with TableProverImpl, which report the number of bytes of the table
+  committed per second (bytes_per_second), and of verifying a Merkle decommitment with each arity.
+*/
+
+namespace starkware {
+namespace {
+
+constexpr size_t kLogNRows = 16;
+constexpr size_t kNSegments = 16;
+
+/*
+  Commits to a random table of 2^kLogNRows rows, of state.range(0) bytes each.
+*/
+template <typename HashT>
+void CommitmentBenchmark(benchmark::State& state) {
+  const size_t row_size = state.range(0);
+  const uint64_t n_rows_per_segment = SafeDiv(Pow2(kLogNRows), kNSegments);
+  Prng prng;
+  const std::vector<std::byte> data = prng.RandomByteVector(row_size * Pow2(kLogNRows));
+  const auto segments = gsl::make_span(data);
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    ProverChannel channel(Prng{});
+    auto prover = MakeCommitmentSchemeProver<HashT>(
+        row_size, n_rows_per_segment, kNSegments, &channel);
+    for (size_t i = 0; i < kNSegments; ++i) {
+      prover.AddSegmentForCommitment(
+          segments.subspan(i * n_rows_per_segment * row_size, n_rows_per_segment * row_size), i);
+    }
+    prover.Commit();
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void Blake2sCommitmentBenchmark(benchmark::State& state) {  // NOLINT
+  CommitmentBenchmark<Blake2s160>(state);
+}
+
+static void Keccak256CommitmentBenchmark(benchmark::State& state) {  // NOLINT
+  CommitmentBenchmark<Keccak256>(state);
+}
+
+/*
+  Commits to a table of 2^kLogNRows rows of state.range(0) random base field elements with
+  TableProverImpl, whose rows are serialized and hashed by the commitment scheme.
+*/
+static void TableCommitmentBenchmark(benchmark::State& state) {  // NOLINT
+  const size_t n_columns = state.range(0);
+  const uint64_t n_rows_per_segment = SafeDiv(Pow2(kLogNRows), kNSegments);
+  Prng prng;
+  std::vector<std::vector<BaseFieldElement>> columns;
+  columns.reserve(n_columns);
+  for (size_t i = 0; i < n_columns; ++i) {
+    columns.push_back(prng.RandomFieldElementVector<BaseFieldElement>(Pow2(kLogNRows)));
+  }
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    ProverChannel channel(Prng{});
+    TableProverImpl<BaseFieldElement> table_prover(
+        n_columns,
+        UseMovedValue(MakeCommitmentSchemeProver<Blake2s160>(
+            n_columns * BaseFieldElement::SizeInBytes(), n_rows_per_segment, kNSegments,
+            &channel)),
+        &channel);
+    for (size_t i = 0; i < kNSegments; ++i) {
+      std::vector<gsl::span<const BaseFieldElement>> segment;
+      segment.reserve(n_columns);
+      for (const auto& column : columns) {
+        segment.push_back(
+            gsl::make_span(column).subspan(i * n_rows_per_segment, n_rows_per_segment));
+      }
+      table_prover.AddSegmentForCommitment(segment, i, 1);
+    }
+    table_prover.Commit();
+  }
+  state.SetBytesProcessed(
+      state.iterations() * n_columns * Pow2(kLogNRows) * BaseFieldElement::SizeInBytes());
+}
+
+/*
+  Verifies a decommitment of kNQueries random queries to a tree of 2^kLogNLeaves leaves, whose arity
+  is state.range(0), against its cap at depth state.range(1). Reports the size of the cap and the
+  decommitment in bytes (proof_bytes).
+*/
+static void MerkleVerifyDecommitmentBenchmark(benchmark::State& state) {  // NOLINT
+  constexpr size_t kLogNLeaves = 20;
+  constexpr size_t kNQueries = 256;
+  const size_t arity = state.range(0);
+  const size_t cap_depth = state.range(1);
+  Prng prng;
+  std::vector<Blake2s160> data;
+  data.reserve(Pow2(kLogNLeaves));
+  for (size_t i = 0; i < Pow2(kLogNLeaves); ++i) {
+    data.push_back(prng.RandomHash());
+  }
+  MerkleTree<Blake2s160> tree(data.size(), 0, arity, cap_depth);
+  tree.AddData(data, 0);
+  const std::vector<Blake2s160> cap = tree.GetCap(kLogNLeaves);
+
+  std::set<uint64_t> queries;
+  std::map<uint64_t, Blake2s160> query_data;
+  while (queries.size() < kNQueries) {
+    const uint64_t query = prng.UniformInt<uint64_t>(0, data.size() - 1);
+    queries.insert(query);
+    query_data[query] = data[query];
+  }
+  const Prng channel_prng;
+  ProverChannel prover_channel(channel_prng.Clone());
+  tree.GenerateDecommitment(queries, &prover_channel);
+  const std::vector<std::byte> proof = prover_channel.GetProof();
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    VerifierChannel verifier_channel(channel_prng.Clone(), proof);
+    verifier_channel.DisableAnnotations();
+    benchmark::DoNotOptimize(MerkleTree<Blake2s160>::VerifyDecommitment(
+        query_data, data.size(), gsl::make_span(cap), &verifier_channel, arity));
+  }
+  state.counters["proof_bytes"] = proof.size() + cap.size() * Blake2s160::kDigestNumBytes;
+}
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Blake2sCommitmentBenchmark)->Arg(32)->Arg(256)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(Keccak256CommitmentBenchmark)->Arg(32)->Arg(256)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(TableCommitmentBenchmark)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(MerkleVerifyDecommitmentBenchmark)
+    ->ArgsProduct({{2, 4, 8, 16}, {0, 4, 8}})
+    ->ArgNames({"arity", "cap_depth"});
+
+}  // namespace
+}  // namespace starkware
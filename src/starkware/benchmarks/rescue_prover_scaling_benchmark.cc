@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gflags/gflags.h"
+
+#include "starkware/main/prover_main_helper.h"
+#include "starkware/math/math.h"
+#include "starkware/statement/rescue/rescue_statement.h"
+#include "starkware/utils/input_utils.h"
+#include "starkware/utils/json_builder.h"
+#include "starkware/utils/profiling.h"
+#include "starkware/utils/task_manager.h"
+
+/*
+  Scaling benchmarks of the Rescue prover.
+
+  Each number of threads is measured on a TaskManager of its own, with exactly that many threads
+  (see TaskManager::CreateInstanceForTesting()), which the prover uses instead of the singleton
+  while the benchmark runs. The backend is chosen by --work_stealing.
+
+  Strong scaling: the trace length is fixed and the number of threads grows.
+  Weak scaling: the trace length grows with the number of threads (rounded up to a power of 2).
+
+  Besides the total time, each run reports the time of every stage of the prover (as measured by
+  ProfilingBlock) as a counter, in seconds per proof. Use --benchmark_format=json (or
+  --benchmark_out=<file>) for machine-readable output, and compute the parallel efficiency of
+  stage s with n threads as time(s, 1 thread) / (n * time(s, n threads)) for strong scaling.
+*/
+
+namespace starkware {
+namespace {
+
+/*
+  Returns the numbers of threads that are measured: the powers of 2 up to the number of threads of
+  the machine, and the number of threads of the machine.
+*/
+std::vector<int64_t> ThreadCounts() {
+  const int64_t max_threads = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  std::vector<int64_t> thread_counts;
+  for (int64_t n_threads = 1; n_threads < max_threads; n_threads *= 2) {
+    thread_counts.push_back(n_threads);
+  }
+  thread_counts.push_back(max_threads);
+  return thread_counts;
+}
+
+/*
+  Generates a random witness for the benchmark.
+*/
+JsonValue GetPrivateInput(size_t chain_length, Prng* prng) {
+  JsonBuilder private_input;
+  for (size_t i = 0; i < chain_length + 1; ++i) {
+    Json::Value value(Json::arrayValue);
+    for (size_t j = 0; j < 4; ++j) {
+      value.append(BaseFieldElement::RandomElement(prng).ToString());
+    }
+    private_input["witness"].Append(value);
+  }
+  return private_input.Build();
+}
+
+/*
+  Proves a Rescue hash chain with a trace of length 2^log_trace_length, using n_threads threads.
+*/
+void RunScalingBenchmark(benchmark::State& state, size_t n_threads, size_t log_trace_length) {
+  TaskManager task_manager = TaskManager::CreateInstanceForTesting(n_threads);
+  TaskManager::InstanceScopeForTesting instance_scope(&task_manager);
+
+  static Prng prng(MakeByteArray<0xca, 0xfe, 0xca, 0xfe>());
+  // The trace length is 32 * chain_length / 3, rounded up to a power of 2.
+  const size_t chain_length = 3 * (Pow2(log_trace_length) / 32) - 3;
+  const JsonValue private_input = GetPrivateInput(chain_length, &prng);
+  const JsonValue public_input =
+      RescueStatement::GetPublicInputJsonValueFromPrivateInput(private_input);
+  const JsonValue stark_config = GetProverConfigJson();
+  RescueStatement statement(public_input, private_input);
+  const JsonValue parameters = GetParametersJson(
+      /*trace_length=*/statement.GetAir().TraceLength(), /*log_n_cosets=*/2,
+      /*security_bits=*/80, /*proof_of_work_bits=*/18, /*fri_steps=*/{1, 3, 3, 3, 3});
+
+  // The job accounts the CPU time of the proofs.
+  TaskJob job(TaskJobOptions{/*priority=*/0, /*weight=*/1, /*max_threads=*/0, "scaling"});
+  ProfilingCollector collector;
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    ProverMainHelper(
+        &statement, parameters, stark_config, JsonValue::FromJsonCppValue(Json::Value()),
+        /*out_file_name=*/"", /*generate_annotations=*/false, &job);
+  }
+
+  for (const auto& [description, duration] : collector.Durations()) {
+    state.counters[description] =
+        benchmark::Counter(duration.count(), benchmark::Counter::kAvgIterations);
+  }
+  state.counters["n_threads"] = n_threads;
+  state.counters["log_trace_length"] = log_trace_length;
+  state.counters["cpu_time_per_proof"] = benchmark::Counter(
+      std::chrono::duration<double>(job.CpuTime()).count(), benchmark::Counter::kAvgIterations);
+}
+
+/*
+  state.range(0) is the number of threads, and state.range(1) is the log of the trace length.
+*/
+static void RescueProverStrongScalingBenchmark(benchmark::State& state) {  // NOLINT
+  RunScalingBenchmark(state, state.range(0), state.range(1));
+}
+
+/*
+  state.range(0) is the number of threads, and state.range(1) is the log of the trace length per
+  thread.
+*/
+static void RescueProverWeakScalingBenchmark(benchmark::State& state) {  // NOLINT
+  RunScalingBenchmark(state, state.range(0), state.range(1) + Log2Ceil(state.range(0)));
+}
+
+void StrongScalingArgs(benchmark::internal::Benchmark* benchmark) {
+  for (const int64_t log_trace_length : {14, 16, 18, 20, 22}) {
+    for (const int64_t n_threads : ThreadCounts()) {
+      benchmark->Args({n_threads, log_trace_length});
+    }
+  }
+}
+
+void WeakScalingArgs(benchmark::internal::Benchmark* benchmark) {
+  for (const int64_t log_trace_length_per_thread : {14, 16}) {
+    for (const int64_t n_threads : ThreadCounts()) {
+      if (log_trace_length_per_thread + Log2Ceil(n_threads) <= 22) {
+        benchmark->Args({n_threads, log_trace_length_per_thread});
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(RescueProverStrongScalingBenchmark)
+    ->Apply(StrongScalingArgs)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(RescueProverWeakScalingBenchmark)
+    ->Apply(WeakScalingArgs)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace starkware
@@ -0,0 +1,125 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gflags/gflags.h"
+
+#include "starkware/utils/task_manager.h"
+
+namespace starkware {
+namespace {
+
+/*
+  The values of --thread_affinity compared by the benchmark, indexed by state.range(0).
+*/
+const std::array<std::string, 3> kAffinities = {"none", "compact", "scatter"};
+
+/*
+  A memory-bound workload: the buffer is first touched with ParallelForNodeAffine, so that when the
+  threads are pinned each block is placed on the NUMA node of the threads that later read it. Each
+  iteration then sums the buffer with the same split. On a multi-socket machine, compare the "none"
+  run with the pinned ones to see the effect of local memory accesses.
+*/
+static void TaskManagerNodeAffineSumBenchmark(benchmark::State& state) {  // NOLINT
+  const std::string& affinity = kAffinities.at(state.range(0));
+  const size_t n_elements = size_t(1) << state.range(1);
+  TaskManager manager =
+      TaskManager::CreateInstanceForTesting(FLAGS_n_threads, /*work_stealing=*/true, affinity);
+
+  // Not value-initialized, so that the pages are first touched below.
+  std::unique_ptr<uint64_t[]> buffer(new uint64_t[n_elements]);  // NOLINT
+  manager.ParallelForNodeAffine(
+      0, n_elements,
+      [&buffer](const TaskInfo& task_info) {
+        for (size_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
+          buffer[i] = i;
+        }
+      },
+      n_elements);
+
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    std::atomic<uint64_t> sum = 0;
+    manager.ParallelForNodeAffine(
+        0, n_elements,
+        [&buffer, &sum](const TaskInfo& task_info) {
+          uint64_t local_sum = 0;
+          for (size_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
+            local_sum += buffer[i];
+          }
+          sum += local_sum;
+        },
+        n_elements);
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetLabel(affinity);
+  state.SetBytesProcessed(state.iterations() * n_elements * sizeof(uint64_t));
+}
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(TaskManagerNodeAffineSumBenchmark)
+    ->ArgsProduct({{0, 1, 2}, {24, 27}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/*
+  The idle policies compared by TaskManagerParallelForLatencyBenchmark, indexed by state.range(2):
+  sleep right away, spin for --idle_spin_us before going to sleep, and the latter with short calls
+  (see TaskManager::ShortCallScope).
+*/
+const std::array<std::string, 3> kIdlePolicies = {"park", "spin", "spin_short"};
+
+/*
+  The latency of back-to-back ParallelFor calls with little work, as in consecutive small parallel
+  loops of the prover. state.range(0) is the number of threads. If state.range(1) is 0, the calls
+  are empty (the chunks do nothing); otherwise each call sums 2^12 elements.
+*/
+static void TaskManagerParallelForLatencyBenchmark(benchmark::State& state) {  // NOLINT
+  const size_t n_threads = state.range(0);
+  const bool empty = state.range(1) == 0;
+  const std::string& idle_policy = kIdlePolicies.at(state.range(2));
+  TaskManager manager = TaskManager::CreateInstanceForTesting(n_threads, /*work_stealing=*/true);
+  manager.SetIdleSpinDuration(
+      idle_policy == "park" ? std::chrono::microseconds(0)
+                            : std::chrono::microseconds(FLAGS_idle_spin_us));
+  std::optional<TaskManager::ShortCallScope> scope;
+  if (idle_policy == "spin_short") {
+    scope.emplace();
+  }
+
+  const size_t n_elements = empty ? n_threads : size_t(1) << 12;
+  std::vector<uint64_t> values(n_elements, 1);
+  // NOLINTNEXTLINE: Suppressing warnings for unused variable '_'.
+  for (auto _ : state) {
+    std::atomic<uint64_t> sum = 0;
+    manager.ParallelFor(
+        n_elements,
+        [&](const TaskInfo& task_info) {
+          if (empty) {
+            return;
+          }
+          uint64_t local_sum = 0;
+          for (size_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
+            local_sum += values[i];
+          }
+          sum += local_sum;
+        },
+        n_elements);
+    benchmark::DoNotOptimize(sum.load());
+  }
+  state.SetLabel(std::string(empty ? "empty" : "tiny") + "/" + idle_policy);
+}
+
+// NOLINTNEXTLINE: cppcoreguidelines-owning-memory.
+BENCHMARK(TaskManagerParallelForLatencyBenchmark)
+    ->ArgsProduct({{8, 32, 128}, {0, 1}, {0, 1, 2}})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace starkware
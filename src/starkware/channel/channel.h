@@ -39,6 +39,7 @@ class Channel {
     UpdateAnnotationPrefix();
   }
   void DisableAnnotations() { annotations_enabled_ = false; }
+  bool AnnotationsEnabled() const;
 
   const ChannelStatistics& GetStatistics() const { return proof_statistics_; }
 
@@ -74,7 +75,6 @@ class Channel {
 
   std::string annotation_prefix_ = ": ";
   ChannelStatistics proof_statistics_;
-  bool AnnotationsEnabled() const;
   bool in_query_phase_ = false;
 
  private:
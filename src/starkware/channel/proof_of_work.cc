@@ -6,6 +6,7 @@
 
 #include "third_party/cppitertools/range.hpp"
 
+#include "starkware/crypt_tools/blake2s_many.h"
 #include "starkware/stl_utils/containers.h"
 #include "starkware/utils/profiling.h"
 #include "starkware/utils/serialization.h"
@@ -32,21 +33,15 @@ std::vector<std::byte> ProofOfWorkProver::Prove(
   return Prove(seed, work_bits, &TaskManager::GetInstance(), log_chunk_size);
 }
 
+/*
+  Returns the smallest nonce in [nonce_start, nonce_start + chunk_size) for which
+  hash(init_hash || nonce) has work_bits leading zeros, if there is one. The nonces are hashed in
+  the lanes of SIMD registers (see blake2s_many::SearchNonce()).
+*/
 std::optional<std::uint64_t> SearchChunk(
-    uint64_t nonce_start, uint64_t chunk_size, gsl::span<std::byte> thread_bytes,
-    uint64_t work_limit) {
-  const gsl::span<std::byte> nonce_span = thread_bytes.last(sizeof(uint64_t));
-  for (uint64_t nonce = nonce_start; nonce < nonce_start + chunk_size; ++nonce) {
-    Serialize(nonce, nonce_span);
-    const Blake2s160 hash = Blake2s160::HashBytesWithLength(thread_bytes);
-    const uint64_t digest_word =
-        Deserialize(gsl::make_span(hash.GetDigest()).first(sizeof(uint64_t)));
-    // Check that we have enough zero bits.
-    if (digest_word < work_limit) {
-      return nonce;
-    }
-  }
-  return std::nullopt;
+    const Blake2s160& init_hash, uint64_t nonce_start, uint64_t chunk_size, size_t work_bits) {
+  return blake2s_many::SearchNonce(
+      init_hash, nonce_start, chunk_size, work_bits, blake2s_many::GetBestBackend());
 }
 
 std::vector<std::byte> ProofOfWorkProver::Prove(
@@ -58,10 +53,7 @@ std::vector<std::byte> ProofOfWorkProver::Prove(
   ProfilingBlock profiling_block("Proof of work");
 
   const Blake2s160 init_hash = InitHash(seed, work_bits);
-  std::array<std::byte, Blake2s160::kDigestNumBytes + sizeof(uint64_t)> bytes{};
-  std::copy(init_hash.GetDigest().begin(), init_hash.GetDigest().end(), bytes.begin());
 
-  const uint64_t work_limit = Pow2(64 - work_bits);
   const uint64_t chunk_size = Pow2(log_chunk_size);
   const size_t thread_count = (work_bits > log_chunk_size) ? task_manager->GetNumThreads() : 1;
 
@@ -73,14 +65,13 @@ std::vector<std::byte> ProofOfWorkProver::Prove(
   std::atomic_uint64_t next_chunk_to_search = nonce_bound;
   std::atomic_uint64_t lowest_nonce_found = std::numeric_limits<uint64_t>::max();
   task_manager->ParallelFor(
-      thread_count, [&lowest_nonce_found, &next_chunk_to_search, &bytes, work_limit, chunk_size,
+      thread_count, [&lowest_nonce_found, &next_chunk_to_search, &init_hash, work_bits, chunk_size,
                      nonce_bound](const TaskInfo& task_info) {
         uint64_t thread_id = task_info.start_idx;
-        std::array<std::byte, Blake2s160::kDigestNumBytes + sizeof(uint64_t)> thread_bytes(bytes);
         uint64_t nonce_start = thread_id * chunk_size;
         do {
           std::optional<uint64_t> nonce =
-              SearchChunk(nonce_start, chunk_size, thread_bytes, work_limit);
+              SearchChunk(init_hash, nonce_start, chunk_size, work_bits);
           if (nonce.has_value()) {
             // If a valid nonce was found, check if it is smaller than lowest_nonce_found, and if it
             // is, loop until one of the following happens:
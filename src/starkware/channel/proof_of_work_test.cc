@@ -1,6 +1,7 @@
 #include "starkware/channel/proof_of_work.h"
 
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -8,6 +9,7 @@
 #include "starkware/channel/verifier_channel.h"
 #include "starkware/crypt_tools/blake2s_160.h"
 #include "starkware/error_handling/test_utils.h"
+#include "starkware/utils/serialization.h"
 
 namespace starkware {
 namespace {
@@ -64,6 +66,30 @@ TEST(ProofOfWork, ParallelCompleteness) {
   EXPECT_TRUE(pow_verifier.Verify(prng.GetPrngState(), work_bits, witness));
 }
 
+TEST(ProofOfWork, LowestNonce) {
+  Prng prng;
+  ProofOfWorkProver pow_prover;
+  ProofOfWorkVerifier pow_verifier;
+  auto task_manager = TaskManager::CreateInstanceForTesting(4);
+  const size_t work_bits = 10;
+
+  // The nonce is the smallest one that the verifier accepts, regardless of the chunks and the
+  // threads.
+  std::vector<std::byte> expected_nonce(ProofOfWorkVerifier::kNonceBytes);
+  for (uint64_t nonce = 0;; ++nonce) {
+    Serialize(nonce, expected_nonce);
+    if (pow_verifier.Verify(prng.GetPrngState(), work_bits, expected_nonce)) {
+      break;
+    }
+  }
+  EXPECT_EQ(expected_nonce, pow_prover.Prove(prng.GetPrngState(), work_bits));
+  for (const uint64_t log_chunk_size : {0, 3, 5}) {
+    EXPECT_EQ(
+        expected_nonce,
+        pow_prover.Prove(prng.GetPrngState(), work_bits, &task_manager, log_chunk_size));
+  }
+}
+
 TEST(ProofOfWork, BadInput) {
   Prng prng;
   ProofOfWorkProver pow_prover;
@@ -55,11 +55,12 @@ class ProverChannel : public Channel {
     proof_statistics_.field_element_count += values.size();
   }
 
-  void SendCommitmentHash(const Blake2s160& hash, const std::string& annotation = "") {
+  template <typename HashT>
+  void SendCommitmentHash(const HashT& hash, const std::string& annotation = "") {
     SendBytes(hash.GetDigest());
     if (AnnotationsEnabled()) {
       AnnotateProverToVerifier(
-          annotation + ": Hash(" + hash.ToString() + ")", Blake2s160::kDigestNumBytes);
+          annotation + ": Hash(" + hash.ToString() + ")", HashT::kDigestNumBytes);
     }
     proof_statistics_.commitment_count += 1;
     proof_statistics_.hash_count += 1;
@@ -77,11 +78,12 @@ class ProverChannel : public Channel {
     return ReceiveFieldElement(annotation);
   }
 
-  void SendDecommitmentNode(const Blake2s160& hash_node, const std::string& annotation = "") {
+  template <typename HashT>
+  void SendDecommitmentNode(const HashT& hash_node, const std::string& annotation = "") {
     SendBytes(hash_node.GetDigest());
     if (AnnotationsEnabled()) {
       AnnotateProverToVerifier(
-          annotation + ": Hash(" + hash_node.ToString() + ")", Blake2s160::kDigestNumBytes);
+          annotation + ": Hash(" + hash_node.ToString() + ")", HashT::kDigestNumBytes);
     }
     proof_statistics_.hash_count++;
   }
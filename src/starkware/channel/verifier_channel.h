@@ -59,11 +59,12 @@ class VerifierChannel : public Channel {
     return GetAndSendRandomFieldElement(annotation);
   }
 
-  Blake2s160 ReceiveCommitmentHash(const std::string& annotation = "") {
-    Blake2s160 hash = Blake2s160::InitDigestTo(ReceiveBytes(Blake2s160::kDigestNumBytes));
+  template <typename HashT = Blake2s160>
+  HashT ReceiveCommitmentHash(const std::string& annotation = "") {
+    HashT hash = HashT::InitDigestTo(ReceiveBytes(HashT::kDigestNumBytes));
     if (AnnotationsEnabled()) {
       AnnotateProverToVerifier(
-          annotation + ": Hash(" + hash.ToString() + ")", Blake2s160::kDigestNumBytes);
+          annotation + ": Hash(" + hash.ToString() + ")", HashT::kDigestNumBytes);
     }
     proof_statistics_.commitment_count += 1;
     proof_statistics_.hash_count += 1;
@@ -101,11 +102,12 @@ class VerifierChannel : public Channel {
     proof_statistics_.field_element_count += span.size();
   }
 
-  Blake2s160 ReceiveDecommitmentNode(const std::string& annotation = "") {
-    Blake2s160 hash = Blake2s160::InitDigestTo(ReceiveBytes(Blake2s160::kDigestNumBytes));
+  template <typename HashT = Blake2s160>
+  HashT ReceiveDecommitmentNode(const std::string& annotation = "") {
+    HashT hash = HashT::InitDigestTo(ReceiveBytes(HashT::kDigestNumBytes));
     if (AnnotationsEnabled()) {
       AnnotateProverToVerifier(
-          annotation + ": Hash(" + hash.ToString() + ")", Blake2s160::kDigestNumBytes);
+          annotation + ": Hash(" + hash.ToString() + ")", HashT::kDigestNumBytes);
     }
 
     proof_statistics_.hash_count++;
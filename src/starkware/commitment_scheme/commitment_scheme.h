@@ -2,6 +2,7 @@
 #define STARKWARE_COMMITMENT_SCHEME_COMMITMENT_SCHEME_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <set>
@@ -64,6 +65,27 @@ class CommitmentSchemeProver {
   virtual void AddSegmentForCommitment(
       gsl::span<const std::byte> segment_data, size_t segment_index) = 0;
 
+  /*
+    Writes the elements first_element, first_element + 1, ... of a segment to output, whose size is
+    a multiple of the size of an element.
+  */
+  using ElementsSerializer =
+      std::function<void(uint64_t first_element, gsl::span<std::byte> output)>;
+
+  /*
+    Same as AddSegmentForCommitment(), where the data of the segment is written by
+    serialize_elements on demand, rather than given. This allows an implementation to serialize the
+    segment in parts, without holding all of it. By default, the whole segment is serialized at
+    once and passed to AddSegmentForCommitment().
+  */
+  virtual void AddStreamedSegmentForCommitment(
+      size_t size_of_element, const ElementsSerializer& serialize_elements,
+      size_t segment_index) {
+    std::vector<std::byte> segment_data(SegmentLengthInElements() * size_of_element);
+    serialize_elements(0, segment_data);
+    AddSegmentForCommitment(segment_data, segment_index);
+  }
+
   /*
     Commits to the data by sending the commitment on the channel (may be interactive).
     Method to compute commitment, assuming all data was passed to the commitment-scheme (using
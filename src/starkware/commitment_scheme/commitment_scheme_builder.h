@@ -10,22 +10,32 @@
 #include "starkware/channel/prover_channel.h"
 #include "starkware/commitment_scheme/commitment_scheme.h"
 #include "starkware/commitment_scheme/packaging_commitment_scheme.h"
+#include "starkware/crypt_tools/blake2s_160.h"
 
 namespace starkware {
 
 /*
-  Creates a packaging commitment scheme prover.
+  Creates a packaging commitment scheme prover, over a Merkle tree of HashT with the given arity
+  (see MerkleTree), which is committed to by its cap at merkle_cap_depth (its root by default). If
+  n_stored_merkle_layers is positive, the tree keeps only its top n_stored_merkle_layers layers.
 */
-PackagingCommitmentSchemeProver MakeCommitmentSchemeProver(
+template <typename HashT = Blake2s160>
+PackagingCommitmentSchemeProver<HashT> MakeCommitmentSchemeProver(
     size_t size_of_element, size_t n_elements_in_segment, size_t n_segments,
-    ProverChannel* channel);
+    ProverChannel* channel, size_t n_stored_merkle_layers = 0, size_t merkle_arity = 2,
+    size_t merkle_cap_depth = 0);
 
 /*
-  Creates a packaging commitment scheme verifier.
+  Creates a packaging commitment scheme verifier, over a Merkle tree of HashT with the given arity
+  and cap depth.
 */
-PackagingCommitmentSchemeVerifier MakeCommitmentSchemeVerifier(
-    size_t size_of_element, uint64_t n_elements, VerifierChannel* channel);
+template <typename HashT = Blake2s160>
+PackagingCommitmentSchemeVerifier<HashT> MakeCommitmentSchemeVerifier(
+    size_t size_of_element, uint64_t n_elements, VerifierChannel* channel,
+    size_t merkle_arity = 2, size_t merkle_cap_depth = 0);
 
 }  // namespace starkware
 
+#include "starkware/commitment_scheme/commitment_scheme_builder.inl"
+
 #endif  // STARKWARE_COMMITMENT_SCHEME_COMMITMENT_SCHEME_BUILDER_H_
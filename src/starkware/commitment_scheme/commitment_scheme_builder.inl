@@ -0,0 +1,41 @@
+#include "starkware/commitment_scheme/commitment_scheme_builder.h"
+
+#include <memory>
+
+#include "starkware/commitment_scheme/merkle/merkle_commitment_scheme.h"
+
+namespace starkware {
+
+template <typename HashT>
+PackagingCommitmentSchemeProver<HashT> MakeCommitmentSchemeProver(
+    size_t size_of_element, size_t n_elements_in_segment, size_t n_segments,
+    ProverChannel* channel, size_t n_stored_merkle_layers, size_t merkle_arity,
+    size_t merkle_cap_depth) {
+  PackagingCommitmentSchemeProver<HashT> commitment_scheme_prover(
+      size_of_element, n_elements_in_segment, n_segments, channel,
+      [n_segments, channel, n_stored_merkle_layers, merkle_arity,
+       merkle_cap_depth](size_t n_elements) {
+        return std::make_unique<MerkleCommitmentSchemeProver<HashT>>(
+            n_elements, n_segments, channel, n_stored_merkle_layers, merkle_arity,
+            merkle_cap_depth);
+      });
+
+  return commitment_scheme_prover;
+}
+
+template <typename HashT>
+PackagingCommitmentSchemeVerifier<HashT> MakeCommitmentSchemeVerifier(
+    size_t size_of_element, uint64_t n_elements, VerifierChannel* channel, size_t merkle_arity,
+    size_t merkle_cap_depth) {
+  PackagingCommitmentSchemeVerifier<HashT> commitment_scheme_verifier(
+      size_of_element, n_elements, channel,
+      [channel, merkle_arity,
+       merkle_cap_depth](size_t n_elements) -> std::unique_ptr<CommitmentSchemeVerifier> {
+        return std::make_unique<MerkleCommitmentSchemeVerifier<HashT>>(
+            n_elements, channel, merkle_arity, merkle_cap_depth);
+      });
+
+  return commitment_scheme_verifier;
+}
+
+}  // namespace starkware
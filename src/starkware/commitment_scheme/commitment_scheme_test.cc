@@ -9,12 +9,14 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "starkware/channel/channel_statistics.h"
 #include "starkware/channel/prover_channel.h"
 #include "starkware/channel/verifier_channel.h"
 #include "starkware/commitment_scheme/commitment_scheme_builder.h"
 #include "starkware/commitment_scheme/merkle/merkle_commitment_scheme.h"
 #include "starkware/commitment_scheme/packaging_commitment_scheme.h"
 #include "starkware/crypt_tools/blake2s_160.h"
+#include "starkware/crypt_tools/keccak_256.h"
 #include "starkware/error_handling/test_utils.h"
 #include "starkware/math/math.h"
 #include "starkware/randomness/prng.h"
@@ -24,49 +26,71 @@ namespace {
 
 using testing::HasSubstr;
 
+/*
+  HashT is the hash of the Merkle tree, MerkleArity is its arity and MerkleCapDepth is the depth of
+  its cap. If NStoredMerkleLayers is positive, the prover uses a compact Merkle tree (see
+  MerkleTree).
+*/
+template <
+    typename HashT = Blake2s160, size_t NStoredMerkleLayers = 0, size_t MerkleArity = 2,
+    size_t MerkleCapDepth = 0>
 struct MerkleCommitmentSchemePairT {
-  using ProverT = MerkleCommitmentSchemeProver;
-  using VerifierT = MerkleCommitmentSchemeVerifier;
+  using ProverT = MerkleCommitmentSchemeProver<HashT>;
+  using VerifierT = MerkleCommitmentSchemeVerifier<HashT>;
 
   static ProverT CreateProver(
       ProverChannel* prover_channel, size_t /*size_of_element*/, size_t n_elements_in_segment,
       size_t n_segments) {
-    return ProverT(n_elements_in_segment * n_segments, n_segments, prover_channel);
+    return ProverT(
+        n_elements_in_segment * n_segments, n_segments, prover_channel, NStoredMerkleLayers,
+        MerkleArity, MerkleCapDepth);
   }
 
   static VerifierT CreateVerifier(
       VerifierChannel* verifier_channel, size_t /*size_of_element*/, size_t n_elements) {
-    return VerifierT(n_elements, verifier_channel);
+    return VerifierT(n_elements, verifier_channel, MerkleArity, MerkleCapDepth);
   }
 
-  static size_t DrawSizeOfElement(Prng* /*prng*/) { return Blake2s160::kDigestNumBytes; }
+  static size_t DrawSizeOfElement(Prng* /*prng*/) { return HashT::kDigestNumBytes; }
 
-  static constexpr size_t kMinElementSize = Blake2s160::kDigestNumBytes;
+  static constexpr size_t kMinElementSize = HashT::kDigestNumBytes;
 };
 
+template <
+    typename HashT = Blake2s160, size_t NStoredMerkleLayers = 0, size_t MerkleArity = 2,
+    size_t MerkleCapDepth = 0>
 struct PackagingCommitmentSchemePairT {
-  using ProverT = PackagingCommitmentSchemeProver;
-  using VerifierT = PackagingCommitmentSchemeVerifier;
+  using ProverT = PackagingCommitmentSchemeProver<HashT>;
+  using VerifierT = PackagingCommitmentSchemeVerifier<HashT>;
   static ProverT CreateProver(
       ProverChannel* prover_channel, size_t size_of_element, size_t n_elements_in_segment,
       size_t n_segments) {
-    return MakeCommitmentSchemeProver(
-        size_of_element, n_elements_in_segment, n_segments, prover_channel);
+    return MakeCommitmentSchemeProver<HashT>(
+        size_of_element, n_elements_in_segment, n_segments, prover_channel, NStoredMerkleLayers,
+        MerkleArity, MerkleCapDepth);
   }
 
   static VerifierT CreateVerifier(
       VerifierChannel* verifier_channel, size_t size_of_element, size_t n_elements) {
-    return MakeCommitmentSchemeVerifier(size_of_element, n_elements, verifier_channel);
+    return MakeCommitmentSchemeVerifier<HashT>(
+        size_of_element, n_elements, verifier_channel, MerkleArity, MerkleCapDepth);
   }
 
   static size_t DrawSizeOfElement(Prng* prng) {
-    return prng->UniformInt<size_t>(1, sizeof(Blake2s160) * 5);
+    return prng->UniformInt<size_t>(1, sizeof(HashT) * 5);
   }
 
   static constexpr size_t kMinElementSize = 1;
 };
 
-using TestTypes = ::testing::Types<MerkleCommitmentSchemePairT, PackagingCommitmentSchemePairT>;
+using TestTypes = ::testing::Types<
+    MerkleCommitmentSchemePairT<>, MerkleCommitmentSchemePairT<Blake2s160, 2>,
+    MerkleCommitmentSchemePairT<Keccak256>, MerkleCommitmentSchemePairT<Blake2s160, 0, 4>,
+    MerkleCommitmentSchemePairT<Blake2s160, 3, 8>, MerkleCommitmentSchemePairT<Blake2s160, 0, 2, 3>,
+    PackagingCommitmentSchemePairT<>, PackagingCommitmentSchemePairT<Blake2s160, 2>,
+    PackagingCommitmentSchemePairT<Keccak256>, PackagingCommitmentSchemePairT<Blake2s160, 0, 4>,
+    PackagingCommitmentSchemePairT<Keccak256, 3, 16>,
+    PackagingCommitmentSchemePairT<Blake2s160, 2, 4, 3>>;
 
 /*
   Returns number of segments to use, N, such that:
@@ -196,6 +220,18 @@ class CommitmentScheme : public ::testing::Test {
     // Verify consistency of data_ with commitment.
     return verifier.VerifyIntegrity(elements_to_verify);
   }
+
+  /*
+    Returns the number of bytes at the beginning of the proof that hold the commitment, if it is a
+    Merkle cap of more than one node, and 0 otherwise.
+  */
+  size_t CommitmentCapNumBytes(const std::vector<std::byte>& proof) {
+    VerifierChannel verifier_channel = GetVerifierChannel(proof);
+    auto verifier = T::CreateVerifier(&verifier_channel, size_of_element_, GetNumElements());
+    verifier.ReadCommitment();
+    const ChannelStatistics& statistics = verifier_channel.GetStatistics();
+    return statistics.commitment_count > 1 ? statistics.byte_count : 0;
+  }
 };
 
 TYPED_TEST_CASE(CommitmentScheme, TestTypes);
@@ -218,9 +254,18 @@ TYPED_TEST(CommitmentScheme, CorruptedProof) {
   // Fetch data_ in queried locations.
   const std::map<uint64_t, std::vector<std::byte>> elements_to_verify = this->GetElementsToVerify();
 
+  // The nodes of a Merkle cap that are not on the path of any query are not checked by the
+  // decommitment (in a proof, the queries are drawn after they are sent to the channel), so only
+  // the decommitment is corrupted in this case.
+  const size_t first_byte = this->CommitmentCapNumBytes(proof);
+  if (first_byte == proof.size()) {
+    return;
+  }
+
   // Construct corrupted proof.
   std::vector<std::byte> corrupted_proof = proof;
-  corrupted_proof[this->prng_.template UniformInt<size_t>(0, proof.size() - 1)] ^= std::byte(1);
+  corrupted_proof[this->prng_.template UniformInt<size_t>(first_byte, proof.size() - 1)] ^=
+      std::byte(1);
 
   // Verify integrity of queried data_ with commitment using CommitmentSchemeVerifier instance.
   EXPECT_FALSE(this->VerifyProof(corrupted_proof, elements_to_verify));
@@ -277,8 +322,8 @@ TYPED_TEST(CommitmentScheme, OutOfRangeQuery) {
       std::make_pair(query, std::vector<std::byte>(this->size_of_element_))};
 
   // Verify consistency.
-  // Proof string must be long enough to contain the commitment.
-  const std::vector<std::byte> dummy_proof(100);
+  // Proof string must be long enough to contain the commitment (which may be a Merkle cap).
+  const std::vector<std::byte> dummy_proof(1000);
   EXPECT_ASSERT(this->VerifyProof(dummy_proof, elements_to_verify), HasSubstr("out of range"));
 }
 
@@ -15,27 +15,60 @@
 
 #include "starkware/channel/prover_channel.h"
 #include "starkware/channel/verifier_channel.h"
+#include "starkware/utils/large_buffer_allocator.h"
 
 namespace starkware {
 
 /*
   Merkle Tree.
+
+  Every inner node is the hash of the concatenation of its arity children (arity is 2, i.e. a binary
+  tree, by default). A tree of higher arity has fewer layers, so its authentication paths have fewer
+  nodes to hash, but each of these hashes is over more children, which are sent unless they are
+  known. If the height of the binary tree is not a multiple of log2(arity), the root has fewer
+  children than the other inner nodes.
+
+  The nodes are indexed as the nodes of the binary tree with the same leaves (i.e. the root is at
+  index 1 and node i is at depth Log2Floor(i)), and the layers that a tree of higher arity does not
+  have are skipped. Thus, the children of a node are consecutive.
+
+  HashT is the hash of the nodes, e.g. Blake2s160 or Keccak256. It has to provide the interface of
+  these classes: kDigestNumBytes, InitDigestTo(), GetDigest(), Hash() of two nodes,
+  HashBytesWithLength() of more nodes, HashMany() of consecutive inputs of the same size,
+  comparison, and ToString() and operator<< for annotations.
 */
+template <typename HashT>
 class MerkleTree {
  public:
-  explicit MerkleTree(uint64_t data_length) : data_length_(data_length), nodes_(2 * data_length) {
-    ASSERT_RELEASE(IsPowerOfTwo(data_length), "Data length is not a power of 2.");
-    VLOG(3) << "Constructing a Merkle tree for data length = " << data_length;
-    // We use an array that has one extra cell we never use at the beginning, to make indexing
-    // nicer.
-  }
+  /*
+    Constructs a tree with data_length leaves. By default, all the 2 * data_length nodes of the tree
+    are kept in memory. If n_stored_layers is positive, only the top n_stored_layers layers are kept
+    (the root is the top layer), i.e. 2^n_stored_layers nodes. The tree is then compact: the nodes
+    below the stored layers are recomputed for the decommitment, from the leaves of the subtrees
+    that contain the queries (see MissingLeavesForDecommitment()). The number of stored layers is
+    increased if needed, so that the lowest stored layer is a layer of a tree of the given arity,
+    and so that the cap is stored.
+
+    The cap of the tree is its layer at depth CapDepth(data_length, cap_depth, arity) (see
+    GetCap()). Its decommitments end at the cap rather than at the root.
+  */
+  explicit MerkleTree(
+      uint64_t data_length, size_t n_stored_layers = 0, size_t arity = 2, size_t cap_depth = 0);
+
+  /*
+    Returns the depth of the cap of a tree with data_length leaves of the given arity: the largest
+    depth that is at most cap_depth (and at most the height of the tree) at which the tree has a
+    layer.
+  */
+  static size_t CapDepth(uint64_t data_length, size_t cap_depth, size_t arity);
 
   /*
     Adds data to the tree. The start_index argument is used so that data may be fed
     into the tree in any order, and by different threads.
     start_index + data.size() has to be smaller than the data length declared at construction.
+    If the tree is compact, the data must consist of whole subtrees below the stored layers.
   */
-  void AddData(gsl::span<const Blake2s160> data, uint64_t start_index);
+  void AddData(gsl::span<const HashT> data, uint64_t start_index);
 
   /*
     Retrieves the root of the tree.
@@ -51,33 +84,123 @@ class MerkleTree {
     since the leaves were fed in pairs. Similarly, calling GetRoot(0) causes no hash operations to
     be performed, and simply returns the root stored from the last time it was computed.
   */
-  Blake2s160 GetRoot(size_t min_depth_assumed_correct);
+  HashT GetRoot(size_t min_depth_assumed_correct);
+
+  /*
+    Same as GetRoot(), but returns the nodes of the cap of the tree, from left to right, instead of
+    the root. The tree may be committed to by its cap, in which case the authentication paths of the
+    decommitment end at the cap and are shorter.
+  */
+  std::vector<HashT> GetCap(size_t min_depth_assumed_correct);
 
   /*
-    Generates and sends to the channel minimal consistency proof between the Merkle tree root
-    and the values in the queried indices.
+    Returns the leaves that GenerateDecommitment() needs in order to recompute the nodes that are
+    not stored: the leaves of the subtrees below the stored layers that contain the queries, except
+    for the queries themselves. Returns an empty vector if the tree is not compact.
+  */
+  std::vector<uint64_t> MissingLeavesForDecommitment(const std::set<uint64_t>& queries) const;
+
+  /*
+    Generates and sends to the channel minimal consistency proof between the Merkle tree cap (which
+    is the root, unless the tree is constructed with a positive cap_depth) and the values in the
+    queried indices.
     The proof does not include the values of those indices, nor the Merkle root.
+    missing_leaves are the values of the leaves returned by MissingLeavesForDecommitment(queries),
+    in the same order.
   */
-  void GenerateDecommitment(const std::set<uint64_t>& queries, ProverChannel* channel) const;
+  void GenerateDecommitment(
+      const std::set<uint64_t>& queries, ProverChannel* channel,
+      gsl::span<const HashT> missing_leaves = {}) const;
 
   /*
     Given a Merkle root, and claimed values of a subset of its leaves (data_to_verify),
     reads and verifies a proof of consistency from the channel (generated by an invocation of
-    GenerateDecommitment()). 'total_data_length' is the total number of leaves in the Merkle tree.
+    GenerateDecommitment()). 'total_data_length' is the total number of leaves in the Merkle tree,
+    and 'arity' is its arity.
+  */
+  static bool VerifyDecommitment(
+      const std::map<uint64_t, HashT>& data_to_verify, uint64_t total_data_length,
+      const HashT& merkle_root, VerifierChannel* channel, size_t arity = 2);
+
+  /*
+    Same as above, for a tree that is committed to by its cap (see GetCap()). The depth of the cap
+    is log2(cap.size()), and must be a depth that CapDepth() returns.
+  */
+  static bool VerifyDecommitment(
+      const std::map<uint64_t, HashT>& data_to_verify, uint64_t total_data_length,
+      gsl::span<const HashT> cap, VerifierChannel* channel, size_t arity = 2);
+
+  /*
+    Same as above, where the claimed value of the leaf queries[i] is leaves[i], and the queries are
+    sorted and distinct. The nodes are verified layer by layer: the nodes of each layer are hashed
+    together (see HashT::HashMany()), and the only allocations are of a few buffers per call.
   */
   static bool VerifyDecommitment(
-      const std::map<uint64_t, Blake2s160>& data_to_verify, uint64_t total_data_length,
-      const Blake2s160& merkle_root, VerifierChannel* channel);
+      gsl::span<const uint64_t> queries, gsl::span<const HashT> leaves, uint64_t total_data_length,
+      gsl::span<const HashT> cap, VerifierChannel* channel, size_t arity = 2);
 
   uint64_t GetDataLength() const;
 
  private:
   const uint64_t data_length_;
-  std::vector<Blake2s160> nodes_;
+  const size_t log_arity_;
+  const size_t cap_depth_;
+  // The number of layers of the tree that are kept in nodes_, and the height of the subtrees below
+  // them (0 if the tree is not compact).
+  const size_t n_stored_layers_;
+  const size_t subtree_height_;
+  // We use an array that has one extra cell we never use at the beginning, to make indexing nicer.
+  LargeBufferVector<HashT> nodes_;
 
-  void SendDecommitmentNode(uint64_t node_index, ProverChannel* channel) const;
+  /*
+    The number of nodes of a layer that a single task hashes. Layers of fewer than twice this number
+    of nodes are hashed by the calling thread.
+  */
+  static constexpr uint64_t kNodesPerTask = 512;
+
+  /*
+    Returns the number of binary layers between the nodes at the given depth (which must be a layer
+    of the tree) and their children.
+  */
+  size_t ChildrenShift(size_t depth) const;
+
+  /*
+    Returns true if the nodes at the given depth form a layer of the tree, i.e. it is not a layer of
+    the binary tree that the arity of the tree skips.
+  */
+  bool IsLayer(size_t depth) const;
+
+  /*
+    Computes the layers of the tree above min_depth_assumed_correct, up to (and including) the layer
+    at depth top_depth (see GetRoot()).
+  */
+  void ComputeLayers(size_t min_depth_assumed_correct, size_t top_depth);
+
+  /*
+    Computes the nodes start, ..., start + length - 1 (all in the same layer) from their children.
+  */
+  void ComputeNodes(uint64_t start, uint64_t length);
+
+  /*
+    Hashes every group of consecutive children to a node in parents, in parallel if there are enough
+    of them. The number of children of each node is children.size() / parents.size().
+  */
+  static void HashLayer(gsl::span<const HashT> children, gsl::span<HashT> parents);
+
+  /*
+    Recomputes the nodes that are not stored, of the subtrees that contain the queries (see
+    GenerateDecommitment()). Returns a map from the index of each node to its hash.
+  */
+  std::map<uint64_t, HashT> RecomputeSubtrees(
+      const std::set<uint64_t>& queries, gsl::span<const HashT> missing_leaves) const;
+
+  void SendDecommitmentNode(
+      uint64_t node_index, const std::map<uint64_t, HashT>& recomputed_nodes,
+      ProverChannel* channel) const;
 };
 
 }  // namespace starkware
 
+#include "starkware/commitment_scheme/merkle/merkle.inl"
+
 #endif  // STARKWARE_COMMITMENT_SCHEME_MERKLE_MERKLE_H_
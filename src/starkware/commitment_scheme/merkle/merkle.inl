@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "starkware/commitment_scheme/merkle/merkle.h"
+#include "starkware/math/math.h"
+#include "starkware/stl_utils/containers.h"
+#include "starkware/utils/task_manager.h"
+
+namespace starkware {
+
+namespace merkle {
+namespace details {
+
+inline size_t LogArity(size_t arity) {
+  ASSERT_RELEASE(
+      arity >= 2 && IsPowerOfTwo(arity), "The arity of a Merkle tree must be a power of 2.");
+  return SafeLog2(arity);
+}
+
+/*
+  See MerkleTree::CapDepth().
+*/
+inline size_t CapDepth(uint64_t data_length, size_t cap_depth, size_t log_arity) {
+  ASSERT_RELEASE(IsPowerOfTwo(data_length), "Data length is not a power of 2.");
+  const size_t height = SafeLog2(data_length);
+  if (cap_depth >= height) {
+    return height;
+  }
+  // The layers of the tree are at the depths height - i * log_arity, and at depth 0.
+  const size_t distance_from_leaves = DivCeil(height - cap_depth, log_arity) * log_arity;
+  return distance_from_leaves <= height ? height - distance_from_leaves : 0;
+}
+
+/*
+  Returns the number of layers of the binary tree with data_length leaves that a tree stores, given
+  the n_stored_layers argument of its constructor. The height of the subtrees below the stored
+  layers is a multiple of log_arity, so that the lowest stored layer is a layer of the tree, and the
+  layer at cap_depth is stored.
+*/
+inline size_t NumStoredLayers(
+    uint64_t data_length, size_t n_stored_layers, size_t log_arity, size_t cap_depth) {
+  ASSERT_RELEASE(IsPowerOfTwo(data_length), "Data length is not a power of 2.");
+  const size_t n_layers = SafeLog2(data_length) + 1;
+  if (n_stored_layers == 0 || n_stored_layers >= n_layers) {
+    return n_layers;
+  }
+  const size_t subtree_height = n_layers - std::max(n_stored_layers, cap_depth + 1);
+  return n_layers - (subtree_height - subtree_height % log_arity);
+}
+
+/*
+  Returns the number of binary layers between the nodes at the given depth (which must be a layer
+  of the tree) and their parents. All the layers are log_arity apart, except for the children of the
+  root, which may be closer.
+*/
+inline size_t ParentShift(size_t depth, size_t log_arity) { return std::min(depth, log_arity); }
+
+/*
+  Returns the annotation of a decommitment node. It is only built if the annotations of the channel
+  are enabled.
+*/
+inline std::string DecommitmentNodeAnnotation(const Channel& channel, uint64_t node_index) {
+  return channel.AnnotationsEnabled() ? "For node " + std::to_string(node_index) : "";
+}
+
+}  // namespace details
+}  // namespace merkle
+
+template <typename HashT>
+MerkleTree<HashT>::MerkleTree(
+    uint64_t data_length, size_t n_stored_layers, size_t arity, size_t cap_depth)
+    : data_length_(data_length),
+      log_arity_(merkle::details::LogArity(arity)),
+      cap_depth_(merkle::details::CapDepth(data_length, cap_depth, log_arity_)),
+      n_stored_layers_(merkle::details::NumStoredLayers(
+          data_length, n_stored_layers, log_arity_, cap_depth_)),
+      subtree_height_(SafeLog2(data_length) + 1 - n_stored_layers_),
+      nodes_(Pow2(n_stored_layers_)) {
+  VLOG(3) << "Constructing a Merkle tree for data length = " << data_length << ", arity = " << arity
+          << ", storing " << n_stored_layers_ << " layers";
+}
+
+template <typename HashT>
+size_t MerkleTree<HashT>::CapDepth(uint64_t data_length, size_t cap_depth, size_t arity) {
+  return merkle::details::CapDepth(data_length, cap_depth, merkle::details::LogArity(arity));
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::AddData(gsl::span<const HashT> data, uint64_t start_index) {
+  ASSERT_RELEASE(
+      start_index + data.size() <= data_length_,
+      "Data of length " + std::to_string(data.size()) + ", starting at " +
+          std::to_string(start_index) + " exceeds the data length declared at tree construction, " +
+          std::to_string(data_length_) + ".");
+  const uint64_t subtree_size = Pow2(subtree_height_);
+  ASSERT_RELEASE(
+      start_index % subtree_size == 0 && data.size() % subtree_size == 0,
+      "Data of a compact tree must consist of whole subtrees of " + std::to_string(subtree_size) +
+          " leaves.");
+  VLOG(5) << "Adding data at start_index = " << start_index << ", of size " << data.size();
+
+  // If the tree is compact, hash the data up to the lowest stored layer, without storing it.
+  gsl::span<const HashT> layer = data;
+  std::vector<HashT> layer_buffer;
+  for (size_t i = 0; i < subtree_height_; i += log_arity_) {
+    std::vector<HashT> parents(layer.size() >> log_arity_);
+    HashLayer(layer, parents);
+    layer_buffer = std::move(parents);
+    layer = layer_buffer;
+  }
+
+  // Copy the layer to the tree (in a tree that is not compact, these are the leaves).
+  const uint64_t first_node = Pow2(n_stored_layers_ - 1) + (start_index >> subtree_height_);
+  std::copy(layer.begin(), layer.end(), nodes_.begin() + first_node);
+  // Hash to compute all internal nodes that can be derived solely from the given data.
+  uint64_t cur = first_node;
+  uint64_t length = layer.size();
+  for (size_t depth = n_stored_layers_ - 1; depth > 0;) {
+    const size_t shift = merkle::details::ParentShift(depth, log_arity_);
+    // Based on the given data, we compute its parent nodes' hashes (referred to here as
+    // "sub_layer").
+    const uint64_t sub_layer_length = length >> shift;
+    if (sub_layer_length == 0) {
+      break;
+    }
+    cur >>= shift;
+    depth -= shift;
+    length = sub_layer_length;
+    ComputeNodes(cur, sub_layer_length);
+  }
+}
+
+template <typename HashT>
+HashT MerkleTree<HashT>::GetRoot(size_t min_depth_assumed_correct) {
+  VLOG(4) << "Computing root, assuming correctness of nodes at depth " << min_depth_assumed_correct;
+  ComputeLayers(min_depth_assumed_correct, 0);
+  return nodes_[1];
+}
+
+template <typename HashT>
+std::vector<HashT> MerkleTree<HashT>::GetCap(size_t min_depth_assumed_correct) {
+  VLOG(4) << "Computing cap at depth " << cap_depth_ << ", assuming correctness of nodes at depth "
+          << min_depth_assumed_correct;
+  ComputeLayers(min_depth_assumed_correct, cap_depth_);
+  const auto cap_begin = nodes_.begin() + Pow2(cap_depth_);
+  return {cap_begin, cap_begin + Pow2(cap_depth_)};
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::ComputeLayers(size_t min_depth_assumed_correct, size_t top_depth) {
+  ASSERT_RELEASE(
+      min_depth_assumed_correct < SafeLog2(nodes_.size()),
+      "Depth should not exceed tree's height.");
+  // Iterating nodes in reverse order to traverse up the tree layer by layer.
+  for (size_t depth = min_depth_assumed_correct; depth > top_depth; --depth) {
+    if (IsLayer(depth - 1)) {
+      ComputeNodes(Pow2(depth - 1), Pow2(depth - 1));
+    }
+  }
+}
+
+template <typename HashT>
+uint64_t MerkleTree<HashT>::GetDataLength() const { return data_length_; }
+
+template <typename HashT>
+size_t MerkleTree<HashT>::ChildrenShift(size_t depth) const {
+  const size_t root_shift = SafeLog2(data_length_) % log_arity_;
+  return depth == 0 && root_shift != 0 ? root_shift : log_arity_;
+}
+
+template <typename HashT>
+bool MerkleTree<HashT>::IsLayer(size_t depth) const {
+  return depth == 0 || (SafeLog2(data_length_) - depth) % log_arity_ == 0;
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::ComputeNodes(uint64_t start, uint64_t length) {
+  const size_t shift = ChildrenShift(Log2Floor(start));
+  HashLayer(
+      gsl::make_span(nodes_).subspan(start << shift, length << shift),
+      gsl::make_span(nodes_).subspan(start, length));
+  VLOG(6) << "Wrote to inner nodes #" << start << " to #" << start + length - 1;
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::HashLayer(gsl::span<const HashT> children, gsl::span<HashT> parents) {
+  ASSERT_RELEASE(
+      !parents.empty() && children.size() % parents.size() == 0, "Wrong number of children.");
+  const size_t n_children = children.size() / parents.size();
+  // The children of the nodes are consecutive, so they are hashed as inputs of n_children digests.
+  const auto hash_nodes = [children, parents, n_children](uint64_t start, uint64_t length) {
+    HashT::HashMany(
+        children.subspan(n_children * start, n_children * length)
+            .template as_span<const std::byte>(),
+        n_children * HashT::kDigestNumBytes, parents.subspan(start, length));
+  };
+  const uint64_t length = parents.size();
+  if (length < 2 * kNodesPerTask) {
+    hash_nodes(0, length);
+    return;
+  }
+  // Every node depends only on its children, so the order in which the tasks run does not affect
+  // the result.
+  const uint64_t n_tasks = DivCeil(length, kNodesPerTask);
+  TaskManager::GetInstance().ParallelFor(
+      n_tasks,
+      [&hash_nodes, length](const TaskInfo& task_info) {
+        const uint64_t chunk_start = task_info.start_idx * kNodesPerTask;
+        const uint64_t chunk_end = std::min(task_info.end_idx * kNodesPerTask, length);
+        hash_nodes(chunk_start, chunk_end - chunk_start);
+      },
+      n_tasks);
+}
+
+template <typename HashT>
+std::vector<uint64_t> MerkleTree<HashT>::MissingLeavesForDecommitment(
+    const std::set<uint64_t>& queries) const {
+  std::vector<uint64_t> missing_leaves;
+  if (subtree_height_ == 0) {
+    return missing_leaves;
+  }
+  const uint64_t subtree_size = Pow2(subtree_height_);
+  std::set<uint64_t> subtrees;
+  for (uint64_t query : queries) {
+    ASSERT_RELEASE(query < data_length_, "Query out of range.");
+    subtrees.insert(query / subtree_size);
+  }
+  for (uint64_t subtree : subtrees) {
+    for (uint64_t leaf = subtree * subtree_size; leaf < (subtree + 1) * subtree_size; ++leaf) {
+      if (queries.count(leaf) == 0) {
+        missing_leaves.push_back(leaf);
+      }
+    }
+  }
+  return missing_leaves;
+}
+
+template <typename HashT>
+std::map<uint64_t, HashT> MerkleTree<HashT>::RecomputeSubtrees(
+    const std::set<uint64_t>& queries, gsl::span<const HashT> missing_leaves) const {
+  std::map<uint64_t, HashT> nodes;
+  const std::vector<uint64_t> missing_indices = MissingLeavesForDecommitment(queries);
+  ASSERT_RELEASE(
+      missing_leaves.size() == missing_indices.size(),
+      "Expected " + std::to_string(missing_indices.size()) + " missing leaves, got " +
+          std::to_string(missing_leaves.size()) + ".");
+  if (subtree_height_ == 0) {
+    return nodes;
+  }
+
+  // The values of the queried leaves are not known here. Only nodes that are not on the path of
+  // any query are sent, so a placeholder may be used instead.
+  const std::array<std::byte, HashT::kDigestNumBytes> zeros{};
+  const HashT placeholder = HashT::InitDigestTo(zeros);
+  const uint64_t subtree_size = Pow2(subtree_height_);
+  size_t missing_idx = 0;
+  for (auto it = queries.begin(); it != queries.end();) {
+    const uint64_t subtree = *it / subtree_size;
+    // The nodes of the subtree, indexed as the nodes of a tree (i.e. its root is at index 1).
+    std::vector<HashT> subtree_nodes(2 * subtree_size, placeholder);
+    for (; missing_idx < missing_indices.size() &&
+           missing_indices[missing_idx] < (subtree + 1) * subtree_size;
+         ++missing_idx) {
+      subtree_nodes[subtree_size + missing_indices[missing_idx] % subtree_size] =
+          missing_leaves[missing_idx];
+    }
+    for (uint64_t length = subtree_size >> log_arity_; length > 0; length >>= log_arity_) {
+      HashLayer(
+          gsl::make_span(subtree_nodes).subspan(length << log_arity_, length << log_arity_),
+          gsl::make_span(subtree_nodes).subspan(length, length));
+    }
+
+    // Translate the indices of the nodes of the layers of the subtree to the indices of the tree.
+    // The root of the subtree is stored.
+    const uint64_t subtree_root = Pow2(n_stored_layers_ - 1) + subtree;
+    for (uint64_t node = 2; node < 2 * subtree_size; ++node) {
+      const size_t depth = Log2Floor(node);
+      if (depth % log_arity_ == 0) {
+        nodes.emplace((subtree_root << depth) + node - Pow2(depth), subtree_nodes[node]);
+      }
+    }
+
+    // Skip to the first query of the next subtree.
+    it = queries.lower_bound((subtree + 1) * subtree_size);
+  }
+  return nodes;
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::GenerateDecommitment(
+    const std::set<uint64_t>& queries, ProverChannel* channel,
+    gsl::span<const HashT> missing_leaves) const {
+  ASSERT_RELEASE(!queries.empty(), "Empty input queries.");
+  const std::map<uint64_t, HashT> recomputed_nodes = RecomputeSubtrees(queries, missing_leaves);
+
+  // The indices of the nodes of the current layer that the verifier knows, in increasing order.
+  // Fix offset (the user of the function gives queries w.r.t. the data, we use them as indices of
+  // the tree's leaves).
+  std::vector<uint64_t> known_nodes;
+  known_nodes.reserve(queries.size());
+  for (auto query_idx : queries) {
+    ASSERT_RELEASE(query_idx < data_length_, "Query out of range.");
+    known_nodes.push_back(query_idx + data_length_);
+  }
+  std::vector<uint64_t> parents;
+  parents.reserve(queries.size());
+
+  // Go over the layers from the leaves up to the cap. In each layer, send the children of the
+  // parents of the known nodes that the verifier does not know.
+  for (size_t depth = SafeLog2(data_length_); depth > cap_depth_;) {
+    const size_t shift = merkle::details::ParentShift(depth, log_arity_);
+    parents.clear();
+    for (size_t i = 0; i < known_nodes.size();) {
+      const uint64_t parent_index = known_nodes[i] >> shift;
+      for (uint64_t sibling_node_index = parent_index << shift;
+           sibling_node_index < (parent_index + 1) << shift; ++sibling_node_index) {
+        if (i < known_nodes.size() && known_nodes[i] == sibling_node_index) {
+          // The sibling is known - Need to skip it.
+          ++i;
+        } else {
+          // The sibling is not known - Add it to the decommitment.
+          SendDecommitmentNode(sibling_node_index, recomputed_nodes, channel);
+        }
+      }
+      parents.push_back(parent_index);
+    }
+    std::swap(known_nodes, parents);
+    depth -= shift;
+  }
+}
+
+template <typename HashT>
+void MerkleTree<HashT>::SendDecommitmentNode(
+    uint64_t node_index, const std::map<uint64_t, HashT>& recomputed_nodes,
+    ProverChannel* channel) const {
+  const HashT& node =
+      node_index < nodes_.size() ? nodes_[node_index] : recomputed_nodes.at(node_index);
+  channel->SendDecommitmentNode(
+      node, merkle::details::DecommitmentNodeAnnotation(*channel, node_index));
+}
+
+template <typename HashT>
+bool MerkleTree<HashT>::VerifyDecommitment(
+    const std::map<uint64_t, HashT>& data_to_verify, uint64_t total_data_length,
+    const HashT& merkle_root, VerifierChannel* channel, size_t arity) {
+  return VerifyDecommitment(
+      data_to_verify, total_data_length, gsl::make_span(&merkle_root, 1), channel, arity);
+}
+
+template <typename HashT>
+bool MerkleTree<HashT>::VerifyDecommitment(
+    const std::map<uint64_t, HashT>& data_to_verify, uint64_t total_data_length,
+    gsl::span<const HashT> cap, VerifierChannel* channel, size_t arity) {
+  std::vector<uint64_t> queries;
+  std::vector<HashT> leaves;
+  queries.reserve(data_to_verify.size());
+  leaves.reserve(data_to_verify.size());
+  for (const auto& to_verify : data_to_verify) {
+    queries.push_back(to_verify.first);
+    leaves.push_back(to_verify.second);
+  }
+  return VerifyDecommitment(queries, leaves, total_data_length, cap, channel, arity);
+}
+
+template <typename HashT>
+bool MerkleTree<HashT>::VerifyDecommitment(
+    gsl::span<const uint64_t> queries, gsl::span<const HashT> leaves, uint64_t total_data_length,
+    gsl::span<const HashT> cap, VerifierChannel* channel, size_t arity) {
+  ASSERT_RELEASE(
+      total_data_length > 0, "Data length has to be at least 1 (i.e. tree cannot be empty).");
+  ASSERT_RELEASE(!queries.empty(), "Empty input queries.");
+  ASSERT_RELEASE(queries.size() == leaves.size(), "Expected a leaf for every query.");
+  const size_t log_arity = merkle::details::LogArity(arity);
+  const size_t cap_depth = SafeLog2(cap.size());
+  ASSERT_RELEASE(
+      cap_depth == merkle::details::CapDepth(total_data_length, cap_depth, log_arity),
+      "Invalid Merkle cap size.");
+
+  // The indices and the hashes of the known nodes of the current layer, i.e. the ones given in
+  // leaves or computed from known nodes, in increasing order of index.
+  std::vector<uint64_t> indices;
+  indices.reserve(queries.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    ASSERT_RELEASE(queries[i] < total_data_length, "Query out of range.");
+    ASSERT_RELEASE(i == 0 || queries[i - 1] < queries[i], "Queries must be sorted and distinct.");
+    // Fix offset of query enumeration.
+    indices.push_back(queries[i] + total_data_length);
+  }
+  std::vector<HashT> nodes(leaves.begin(), leaves.end());
+  // The children of the parents of the known nodes, consecutively, and the indices of the parents.
+  std::vector<HashT> children;
+  children.reserve(arity * queries.size());
+  std::vector<uint64_t> parent_indices;
+  parent_indices.reserve(queries.size());
+
+  // Go over the layers from the leaves up to the cap. In each layer, complete the children of the
+  // parents of the known nodes using the decommitment nodes, and hash all of them together.
+  for (size_t depth = SafeLog2(total_data_length); depth > cap_depth;) {
+    const size_t shift = merkle::details::ParentShift(depth, log_arity);
+    children.clear();
+    parent_indices.clear();
+    for (size_t i = 0; i < indices.size();) {
+      const uint64_t parent_index = indices[i] >> shift;
+      for (uint64_t sibling_node_index = parent_index << shift;
+           sibling_node_index < (parent_index + 1) << shift; ++sibling_node_index) {
+        if (i < indices.size() && indices[i] == sibling_node_index) {
+          // The sibling is already known.
+          children.push_back(nodes[i]);
+          ++i;
+        } else {
+          // The sibling is part of the authentication nodes. Read it from the channel.
+          children.push_back(channel->ReceiveDecommitmentNode<HashT>(
+              merkle::details::DecommitmentNodeAnnotation(*channel, sibling_node_index)));
+        }
+      }
+      parent_indices.push_back(parent_index);
+    }
+    nodes.resize(parent_indices.size());
+    HashT::HashMany(
+        gsl::make_span(children).template as_span<const std::byte>(),
+        Pow2(shift) * HashT::kDigestNumBytes, nodes);
+    std::swap(indices, parent_indices);
+    depth -= shift;
+  }
+
+  // The remaining nodes are nodes of the cap.
+  for (size_t i = 0; i < indices.size(); ++i) {
+    if (nodes[i] != cap[indices[i] - cap.size()]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace starkware
@@ -13,16 +13,24 @@
 #include "starkware/channel/verifier_channel.h"
 #include "starkware/commitment_scheme/commitment_scheme.h"
 #include "starkware/commitment_scheme/merkle/merkle.h"
-#include "starkware/crypt_tools/blake2s_160.h"
 
 namespace starkware {
 
+template <typename HashT>
 class MerkleCommitmentSchemeProver : public CommitmentSchemeProver {
  public:
-  static constexpr size_t kMinSegmentBytes = 2 * Blake2s160::kDigestNumBytes;
-  static constexpr size_t kSizeOfElement = Blake2s160::kDigestNumBytes;
-
-  MerkleCommitmentSchemeProver(size_t n_elements, size_t n_segments, ProverChannel* channel);
+  static constexpr size_t kMinSegmentBytes = 2 * HashT::kDigestNumBytes;
+  static constexpr size_t kSizeOfElement = HashT::kDigestNumBytes;
+
+  /*
+    Commits using a Merkle tree of the given arity. If n_stored_layers is positive, the tree keeps
+    only its top n_stored_layers layers (see MerkleTree). It is increased if needed, so that the
+    roots of the segments are stored. If cap_depth is positive, the commitment is the cap of the
+    tree at that depth (see MerkleTree::GetCap()) rather than its root.
+  */
+  MerkleCommitmentSchemeProver(
+      size_t n_elements, size_t n_segments, ProverChannel* channel, size_t n_stored_layers = 0,
+      size_t arity = 2, size_t cap_depth = 0);
 
   size_t NumSegments() const override;
   uint64_t SegmentLengthInElements() const override;
@@ -40,13 +48,20 @@ class MerkleCommitmentSchemeProver : public CommitmentSchemeProver {
   const uint64_t n_elements_;
   const size_t n_segments_;
   ProverChannel* channel_;
-  MerkleTree tree_;
+  MerkleTree<HashT> tree_;
   std::set<uint64_t> queries_;
+  std::vector<uint64_t> missing_leaves_;
 };
 
+template <typename HashT>
 class MerkleCommitmentSchemeVerifier : public CommitmentSchemeVerifier {
  public:
-  MerkleCommitmentSchemeVerifier(uint64_t n_elements, VerifierChannel* channel);
+  /*
+    Verifies a commitment of MerkleCommitmentSchemeProver with a Merkle tree of the given arity and
+    cap depth.
+  */
+  MerkleCommitmentSchemeVerifier(
+      uint64_t n_elements, VerifierChannel* channel, size_t arity = 2, size_t cap_depth = 0);
 
   void ReadCommitment() override;
   bool VerifyIntegrity(
@@ -55,9 +70,13 @@ class MerkleCommitmentSchemeVerifier : public CommitmentSchemeVerifier {
  private:
   uint64_t n_elements_;
   VerifierChannel* channel_;
-  std::optional<Blake2s160> commitment_;
+  size_t arity_;
+  size_t cap_depth_;
+  std::optional<std::vector<HashT>> commitment_;
 };
 
 }  // namespace starkware
 
+#include "starkware/commitment_scheme/merkle/merkle_commitment_scheme.inl"
+
 #endif  // STARKWARE_COMMITMENT_SCHEME_MERKLE_MERKLE_COMMITMENT_SCHEME_H_
@@ -0,0 +1,128 @@
+#include "starkware/commitment_scheme/merkle/merkle_commitment_scheme.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "starkware/error_handling/error_handling.h"
+#include "starkware/math/math.h"
+#include "starkware/stl_utils/containers.h"
+
+namespace starkware {
+
+namespace merkle_commitment_scheme {
+namespace details {
+
+/*
+  Returns the annotation of the node of the commitment at the given index. A commitment to the root
+  is annotated as before caps were introduced.
+*/
+inline std::string CommitmentAnnotation(size_t index, size_t cap_size) {
+  return cap_size == 1 ? "Commitment" : "Commitment, cap node " + std::to_string(index);
+}
+
+}  // namespace details
+}  // namespace merkle_commitment_scheme
+
+template <typename HashT>
+MerkleCommitmentSchemeProver<HashT>::MerkleCommitmentSchemeProver(
+    size_t n_elements, size_t n_segments, ProverChannel* channel, size_t n_stored_layers,
+    size_t arity, size_t cap_depth)
+    : n_elements_(n_elements),
+      n_segments_(n_segments),
+      channel_(channel),
+      // Initialize the tree with the number of elements, each element is the hash stored in a leaf.
+      tree_(MerkleTree<HashT>(
+          n_elements_,
+          n_stored_layers == 0 ? 0 : std::max<size_t>(n_stored_layers, SafeLog2(n_segments_) + 1),
+          arity, cap_depth)) {}
+
+template <typename HashT>
+size_t MerkleCommitmentSchemeProver<HashT>::NumSegments() const { return n_segments_; }
+
+template <typename HashT>
+uint64_t MerkleCommitmentSchemeProver<HashT>::SegmentLengthInElements() const {
+  return SafeDiv(n_elements_, n_segments_);
+}
+
+template <typename HashT>
+void MerkleCommitmentSchemeProver<HashT>::AddSegmentForCommitment(
+    gsl::span<const std::byte> segment_data, size_t segment_index) {
+  ASSERT_RELEASE(
+      segment_data.size() == SegmentLengthInElements() * kSizeOfElement,
+      "Segment size is " + std::to_string(segment_data.size()) + " instead of the expected " +
+          std::to_string(kSizeOfElement * SegmentLengthInElements()) + ".");
+  ASSERT_RELEASE(segment_index < n_segments_, "segment_index must be smaller than n_segments_.");
+  tree_.AddData(segment_data.as_span<const HashT>(), segment_index * SegmentLengthInElements());
+}
+
+template <typename HashT>
+void MerkleCommitmentSchemeProver<HashT>::Commit() {
+  // After adding all segments, all inner tree nodes that are at least (tree_height -
+  // log2(n_elements_in_segment_)) far from the root - were already computed.
+  size_t tree_height = SafeLog2(tree_.GetDataLength());
+  const std::vector<HashT> commitment =
+      tree_.GetCap(tree_height - SafeLog2(SegmentLengthInElements()));
+  for (size_t i = 0; i < commitment.size(); ++i) {
+    channel_->SendCommitmentHash(
+        commitment[i],
+        merkle_commitment_scheme::details::CommitmentAnnotation(i, commitment.size()));
+  }
+}
+
+template <typename HashT>
+std::vector<uint64_t> MerkleCommitmentSchemeProver<HashT>::StartDecommitmentPhase(
+    const std::set<uint64_t>& queries) {
+  queries_ = queries;
+  // A compact tree needs the leaves of the subtrees of the queries that it does not store.
+  missing_leaves_ = tree_.MissingLeavesForDecommitment(queries);
+  return missing_leaves_;
+}
+
+template <typename HashT>
+void MerkleCommitmentSchemeProver<HashT>::Decommit(gsl::span<const std::byte> elements_data) {
+  ASSERT_RELEASE(
+      elements_data.size() == missing_leaves_.size() * kSizeOfElement,
+      "element_data is expected to contain the " + std::to_string(missing_leaves_.size()) +
+          " elements requested by StartDecommitmentPhase().");
+  tree_.GenerateDecommitment(queries_, channel_, elements_data.as_span<const HashT>());
+}
+
+template <typename HashT>
+MerkleCommitmentSchemeVerifier<HashT>::MerkleCommitmentSchemeVerifier(
+    uint64_t n_elements, VerifierChannel* channel, size_t arity, size_t cap_depth)
+    : n_elements_(n_elements), channel_(channel), arity_(arity), cap_depth_(cap_depth) {}
+
+template <typename HashT>
+void MerkleCommitmentSchemeVerifier<HashT>::ReadCommitment() {
+  const uint64_t cap_size = Pow2(MerkleTree<HashT>::CapDepth(n_elements_, cap_depth_, arity_));
+  commitment_.emplace();
+  commitment_->reserve(cap_size);
+  for (size_t i = 0; i < cap_size; ++i) {
+    commitment_->push_back(channel_->ReceiveCommitmentHash<HashT>(
+        merkle_commitment_scheme::details::CommitmentAnnotation(i, cap_size)));
+  }
+}
+
+template <typename HashT>
+bool MerkleCommitmentSchemeVerifier<HashT>::VerifyIntegrity(
+    const std::map<uint64_t, std::vector<std::byte>>& elements_to_verify) {
+  // Convert data to hashes, sorted by the queries (as the map is).
+  std::vector<uint64_t> queries;
+  std::vector<HashT> hashes_to_verify;
+  queries.reserve(elements_to_verify.size());
+  hashes_to_verify.reserve(elements_to_verify.size());
+
+  for (auto const& element : elements_to_verify) {
+    ASSERT_RELEASE(element.first < n_elements_, "Query out of range.");
+    ASSERT_RELEASE(
+        element.second.size() == HashT::kDigestNumBytes, "Element size mismatches.");
+    queries.push_back(element.first);
+    hashes_to_verify.push_back(HashT::InitDigestTo(element.second));
+  }
+  // Verify decommitment.
+  return MerkleTree<HashT>::VerifyDecommitment(
+      queries, hashes_to_verify, n_elements_, gsl::make_span(*commitment_), channel_, arity_);
+}
+
+}  // namespace starkware
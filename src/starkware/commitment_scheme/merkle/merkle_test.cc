@@ -1,5 +1,9 @@
 #include <algorithm>
 #include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -8,10 +12,12 @@
 #include "starkware/channel/verifier_channel.h"
 #include "starkware/commitment_scheme/merkle/merkle.h"
 #include "starkware/crypt_tools/blake2s_160.h"
+#include "starkware/crypt_tools/keccak_256.h"
 #include "starkware/error_handling/test_utils.h"
 #include "starkware/math/math.h"
 #include "starkware/randomness/prng.h"
 #include "starkware/stl_utils/containers.h"
+#include "starkware/utils/task_manager.h"
 
 namespace starkware {
 namespace {
@@ -19,62 +25,344 @@ namespace {
 /*
   Auxiliary function to generate random hashes for the data given to the tree.
 */
-std::vector<Blake2s160> GetRandomData(uint64_t length, Prng* prng) {
-  std::vector<Blake2s160> data;
+template <typename HashT>
+std::vector<HashT> GetRandomData(uint64_t length, Prng* prng) {
+  std::vector<HashT> data;
   data.reserve(length);
   for (uint64_t i = 0; i < length; ++i) {
     std::vector<std::byte> digest;
-    data.push_back(Blake2s160::InitDigestTo(prng->RandomByteVector(Blake2s160::kDigestNumBytes)));
+    data.push_back(HashT::InitDigestTo(prng->RandomByteVector(HashT::kDigestNumBytes)));
   }
   return data;
 }
 
+template <typename HashT>
+class MerkleTreeTest : public ::testing::Test {};
+
+using HashTypes = ::testing::Types<Blake2s160, Keccak256>;
+TYPED_TEST_CASE(MerkleTreeTest, HashTypes);
+
 // Compute root twice, make sure we're consistent.
-TEST(MerkleTreeTest, ComputeRootTwice) {
+TYPED_TEST(MerkleTreeTest, ComputeRootTwice) {
   Prng prng;
   size_t tree_height = prng.UniformInt(0, 10);
-  std::vector<Blake2s160> data = GetRandomData(Pow2(tree_height), &prng);
-  MerkleTree tree(data.size());
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(Pow2(tree_height), &prng);
+  MerkleTree<TypeParam> tree(data.size());
   tree.AddData(data, 0);
-  Blake2s160 root1 = tree.GetRoot(tree_height);
-  Blake2s160 root2 = tree.GetRoot(tree_height);
+  TypeParam root1 = tree.GetRoot(tree_height);
+  TypeParam root2 = tree.GetRoot(tree_height);
   EXPECT_EQ(root1, root2);
 }
 
 // Check that starting computation from different depths gets the same value.
-TEST(MerkleTreeTest, GetRootFromDifferentDepths) {
+TYPED_TEST(MerkleTreeTest, GetRootFromDifferentDepths) {
   Prng prng;
   size_t tree_height = prng.UniformInt(1, 10);
   // Just to make things interesting - we don't feed the data in one go, but in two segments.
-  std::vector<Blake2s160> data = GetRandomData(Pow2(tree_height - 1), &prng);
-  MerkleTree tree(data.size() * 2);
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(Pow2(tree_height - 1), &prng);
+  MerkleTree<TypeParam> tree(data.size() * 2);
   tree.AddData(data, 0);
   tree.AddData(data, data.size());
   for (size_t i = 0; i < 20; ++i) {
-    Blake2s160 root1 = tree.GetRoot(prng.UniformInt<size_t>(1, tree_height));
-    Blake2s160 root2 = tree.GetRoot(prng.UniformInt<size_t>(1, tree_height));
+    TypeParam root1 = tree.GetRoot(prng.UniformInt<size_t>(1, tree_height));
+    TypeParam root2 = tree.GetRoot(prng.UniformInt<size_t>(1, tree_height));
     EXPECT_EQ(root1, root2);
   }
 }
 
-TEST(MerkleTreeTest, GetRootWithInvalidDepth) {
+// Check that the root computed in parallel (the tree is large enough for the layers to be split to
+// tasks) is the same as a serial computation of the tree, whether the segments are added serially
+// or in parallel.
+TYPED_TEST(MerkleTreeTest, ParallelRootMatchesSerial) {
+  Prng prng;
+  const size_t tree_height = 14;
+  const size_t log_n_segments = prng.UniformInt(0, 4);
+  std::vector<TypeParam> layer = GetRandomData<TypeParam>(Pow2(tree_height), &prng);
+  const size_t segment_length = layer.size() >> log_n_segments;
+
+  MerkleTree<TypeParam> serial_tree(layer.size());
+  MerkleTree<TypeParam> parallel_tree(layer.size());
+  for (size_t i = 0; i < layer.size(); i += segment_length) {
+    serial_tree.AddData(gsl::make_span(layer).subspan(i, segment_length), i);
+  }
+  TaskManager::GetInstance().ParallelFor(
+      Pow2(log_n_segments), [&](const TaskInfo& task_info) {
+        for (size_t segment = task_info.start_idx; segment < task_info.end_idx; ++segment) {
+          parallel_tree.AddData(
+              gsl::make_span(layer).subspan(segment * segment_length, segment_length),
+              segment * segment_length);
+        }
+      });
+
+  while (layer.size() > 1) {
+    std::vector<TypeParam> next_layer;
+    for (size_t i = 0; i < layer.size(); i += 2) {
+      next_layer.push_back(TypeParam::Hash(layer[i], layer[i + 1]));
+    }
+    layer = std::move(next_layer);
+  }
+  EXPECT_EQ(layer[0], serial_tree.GetRoot(log_n_segments));
+  EXPECT_EQ(layer[0], parallel_tree.GetRoot(log_n_segments));
+  EXPECT_EQ(layer[0], parallel_tree.GetRoot(tree_height));
+}
+
+/*
+  Checks that a compact tree, which stores only its top layers, has the same root and generates the
+  same decommitment as a tree that stores all of its nodes.
+*/
+TYPED_TEST(MerkleTreeTest, CompactTreeMatchesFullTree) {
+  Prng prng;
+  const size_t tree_height = prng.UniformInt(1, 10);
+  const size_t n_stored_layers = prng.UniformInt<size_t>(1, tree_height + 1);
+  const uint64_t data_length = Pow2(tree_height);
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(data_length, &prng);
+
+  MerkleTree<TypeParam> full_tree(data_length);
+  MerkleTree<TypeParam> compact_tree(data_length, n_stored_layers);
+  full_tree.AddData(data, 0);
+  // Add the data of the compact tree in segments, one for each node of the lowest stored layer.
+  const size_t segment_length = Pow2(tree_height + 1 - n_stored_layers);
+  for (uint64_t i = 0; i < data_length; i += segment_length) {
+    compact_tree.AddData(gsl::make_span(data).subspan(i, segment_length), i);
+  }
+  EXPECT_EQ(full_tree.GetRoot(0), compact_tree.GetRoot(n_stored_layers - 1));
+
+  std::set<uint64_t> queries;
+  const size_t n_queries = prng.UniformInt<size_t>(1, 10);
+  for (size_t i = 0; i < n_queries; ++i) {
+    queries.insert(prng.UniformInt<uint64_t>(0, data_length - 1));
+  }
+  EXPECT_TRUE(full_tree.MissingLeavesForDecommitment(queries).empty());
+  std::vector<TypeParam> missing_leaves;
+  for (uint64_t leaf : compact_tree.MissingLeavesForDecommitment(queries)) {
+    EXPECT_EQ(0U, queries.count(leaf));
+    missing_leaves.push_back(data[leaf]);
+  }
+
+  const Prng channel_prng;
+  ProverChannel full_tree_channel(channel_prng.Clone());
+  full_tree.GenerateDecommitment(queries, &full_tree_channel);
+  ProverChannel compact_tree_channel(channel_prng.Clone());
+  compact_tree.GenerateDecommitment(queries, &compact_tree_channel, missing_leaves);
+  EXPECT_EQ(full_tree_channel.GetProof(), compact_tree_channel.GetProof());
+
+  if (!missing_leaves.empty()) {
+    missing_leaves.pop_back();
+    EXPECT_ASSERT(
+        compact_tree.GenerateDecommitment(queries, &compact_tree_channel, missing_leaves),
+        testing::HasSubstr("missing leaves"));
+  }
+}
+
+TYPED_TEST(MerkleTreeTest, CompactTreeInvalidDataSize) {
+  Prng prng;
+  // A tree with 8 leaves that stores 2 layers, i.e. subtrees of 4 leaves.
+  MerkleTree<TypeParam> tree(Pow2(3), 2);
+  EXPECT_ASSERT(
+      tree.AddData(GetRandomData<TypeParam>(2, &prng), 0),
+      testing::HasSubstr("whole subtrees of 4 leaves"));
+  EXPECT_ASSERT(
+      tree.AddData(GetRandomData<TypeParam>(4, &prng), 2),
+      testing::HasSubstr("whole subtrees of 4 leaves"));
+}
+
+/*
+  Computes the root of a tree of the given arity over data, hashing the concatenation of the
+  children of each node. The root has fewer children if needed.
+*/
+template <typename HashT>
+HashT NaiveRoot(std::vector<HashT> layer, size_t arity) {
+  while (layer.size() > 1) {
+    const size_t n_children = std::min(arity, layer.size());
+    std::vector<HashT> next_layer;
+    for (size_t i = 0; i < layer.size(); i += n_children) {
+      next_layer.push_back(HashT::HashBytesWithLength(
+          gsl::make_span(layer).subspan(i, n_children).template as_span<const std::byte>()));
+    }
+    layer = std::move(next_layer);
+  }
+  return layer[0];
+}
+
+/*
+  Checks the root of a tree of higher arity, and that its decommitment (also when it is compact)
+  passes verification, and only with the right data and arity.
+*/
+TYPED_TEST(MerkleTreeTest, HigherArity) {
+  Prng prng;
+  const size_t arity = Pow2(prng.UniformInt(2, 4));
+  const size_t tree_height = prng.UniformInt(0, 10);
+  const size_t log_n_segments = prng.UniformInt<size_t>(0, tree_height);
+  const size_t n_stored_layers = prng.UniformInt<size_t>(log_n_segments + 1, tree_height + 1);
+  const uint64_t data_length = Pow2(tree_height);
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(data_length, &prng);
+
+  MerkleTree<TypeParam> full_tree(data_length, 0, arity);
+  MerkleTree<TypeParam> compact_tree(data_length, n_stored_layers, arity);
+  const size_t segment_length = Pow2(tree_height - log_n_segments);
+  for (uint64_t i = 0; i < data_length; i += segment_length) {
+    full_tree.AddData(gsl::make_span(data).subspan(i, segment_length), i);
+    compact_tree.AddData(gsl::make_span(data).subspan(i, segment_length), i);
+  }
+  const TypeParam root = NaiveRoot(data, arity);
+  EXPECT_EQ(root, full_tree.GetRoot(log_n_segments));
+  EXPECT_EQ(root, compact_tree.GetRoot(log_n_segments));
+
+  std::set<uint64_t> queries;
+  std::map<uint64_t, TypeParam> query_data;
+  const size_t n_queries = prng.UniformInt<size_t>(1, 10);
+  for (size_t i = 0; i < n_queries; ++i) {
+    const uint64_t query = prng.UniformInt<uint64_t>(0, data_length - 1);
+    queries.insert(query);
+    query_data[query] = data[query];
+  }
+  std::vector<TypeParam> missing_leaves;
+  for (uint64_t leaf : compact_tree.MissingLeavesForDecommitment(queries)) {
+    missing_leaves.push_back(data[leaf]);
+  }
+
+  const Prng channel_prng;
+  ProverChannel full_tree_channel(channel_prng.Clone());
+  full_tree.GenerateDecommitment(queries, &full_tree_channel);
+  ProverChannel compact_tree_channel(channel_prng.Clone());
+  compact_tree.GenerateDecommitment(queries, &compact_tree_channel, missing_leaves);
+  const std::vector<std::byte> proof = full_tree_channel.GetProof();
+  EXPECT_EQ(proof, compact_tree_channel.GetProof());
+
+  VerifierChannel verifier_channel(channel_prng.Clone(), proof);
+  EXPECT_TRUE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, root, &verifier_channel, arity));
+
+  // Change one item in the query data.
+  auto it = query_data.begin();
+  std::advance(it, prng.UniformInt<size_t>(0, query_data.size() - 1));
+  it->second = GetRandomData<TypeParam>(1, &prng)[0];
+  VerifierChannel bad_data_verifier_channel(channel_prng.Clone(), proof);
+  EXPECT_FALSE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, root, &bad_data_verifier_channel, arity));
+}
+
+/*
+  Checks that the cap of a tree is its layer at depth cap_depth (the 2^CapDepth(cap_depth) nodes),
+  and that a decommitment to the cap (also of a compact tree) passes verification against the cap,
+  and only against it.
+*/
+TYPED_TEST(MerkleTreeTest, Cap) {
+  Prng prng;
+  const size_t arity = Pow2(prng.UniformInt(1, 3));
+  const size_t tree_height = prng.UniformInt(0, 10);
+  const size_t cap_depth = prng.UniformInt<size_t>(0, tree_height + 1);
+  const size_t n_stored_layers = prng.UniformInt<size_t>(0, tree_height + 1);
+  const uint64_t data_length = Pow2(tree_height);
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(data_length, &prng);
+
+  MerkleTree<TypeParam> tree(data_length, n_stored_layers, arity, cap_depth);
+  tree.AddData(data, 0);
+  const std::vector<TypeParam> cap = tree.GetCap(0);
+  const size_t actual_cap_depth = MerkleTree<TypeParam>::CapDepth(data_length, cap_depth, arity);
+  EXPECT_EQ(Pow2(actual_cap_depth), cap.size());
+  EXPECT_LE(cap.size(), Pow2(std::min(cap_depth, tree_height)));
+  EXPECT_EQ(NaiveRoot(cap, arity), NaiveRoot(data, arity));
+
+  std::set<uint64_t> queries;
+  std::map<uint64_t, TypeParam> query_data;
+  const size_t n_queries = prng.UniformInt<size_t>(1, 10);
+  for (size_t i = 0; i < n_queries; ++i) {
+    const uint64_t query = prng.UniformInt<uint64_t>(0, data_length - 1);
+    queries.insert(query);
+    query_data[query] = data[query];
+  }
+  std::vector<TypeParam> missing_leaves;
+  for (uint64_t leaf : tree.MissingLeavesForDecommitment(queries)) {
+    missing_leaves.push_back(data[leaf]);
+  }
+  const Prng channel_prng;
+  ProverChannel prover_channel(channel_prng.Clone());
+  tree.GenerateDecommitment(queries, &prover_channel, missing_leaves);
+  const std::vector<std::byte> proof = prover_channel.GetProof();
+
+  VerifierChannel verifier_channel(channel_prng.Clone(), proof);
+  EXPECT_TRUE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, gsl::make_span(cap), &verifier_channel, arity));
+
+  // Change the node of the cap on the path of one of the queries.
+  std::vector<TypeParam> bad_cap = cap;
+  bad_cap[*queries.begin() >> (tree_height - actual_cap_depth)] =
+      GetRandomData<TypeParam>(1, &prng)[0];
+  VerifierChannel bad_cap_verifier_channel(channel_prng.Clone(), proof);
+  EXPECT_FALSE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, gsl::make_span(bad_cap), &bad_cap_verifier_channel, arity));
+}
+
+TYPED_TEST(MerkleTreeTest, InvalidCapSize) {
+  Prng prng;
+  const std::vector<TypeParam> data = GetRandomData<TypeParam>(Pow2(3), &prng);
+  const std::map<uint64_t, TypeParam> query_data = {{0, data[0]}};
+  VerifierChannel verifier_channel(Prng(), {});
+  // A tree of arity 4 and height 3 has layers at depths 0, 1 and 3.
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          query_data, data.size(), gsl::make_span(data).subspan(0, 4), &verifier_channel, 4),
+      testing::HasSubstr("Invalid Merkle cap size."));
+}
+
+TYPED_TEST(MerkleTreeTest, InvalidVerifyDecommitmentInput) {
+  Prng prng;
+  const std::vector<TypeParam> data = GetRandomData<TypeParam>(Pow2(3), &prng);
+  const TypeParam root = GetRandomData<TypeParam>(1, &prng)[0];
+  const auto cap = gsl::make_span(&root, 1);
+  const auto leaves = gsl::make_span(data).subspan(0, 2);
+  VerifierChannel verifier_channel(Prng(), {});
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          std::vector<uint64_t>{}, {}, data.size(), cap, &verifier_channel),
+      testing::HasSubstr("Empty input queries."));
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          std::vector<uint64_t>{5, 2}, leaves, data.size(), cap, &verifier_channel),
+      testing::HasSubstr("Queries must be sorted and distinct."));
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          std::vector<uint64_t>{2, 2}, leaves, data.size(), cap, &verifier_channel),
+      testing::HasSubstr("Queries must be sorted and distinct."));
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          std::vector<uint64_t>{2, 8}, leaves, data.size(), cap, &verifier_channel),
+      testing::HasSubstr("Query out of range."));
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam>::VerifyDecommitment(
+          std::vector<uint64_t>{2}, leaves, data.size(), cap, &verifier_channel),
+      testing::HasSubstr("Expected a leaf for every query."));
+}
+
+TYPED_TEST(MerkleTreeTest, InvalidArity) {
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam> tree(Pow2(3), 0, 3),
+      testing::HasSubstr("The arity of a Merkle tree must be a power of 2."));
+  EXPECT_ASSERT(
+      MerkleTree<TypeParam> tree(Pow2(3), 0, 1),
+      testing::HasSubstr("The arity of a Merkle tree must be a power of 2."));
+}
+
+TYPED_TEST(MerkleTreeTest, GetRootWithInvalidDepth) {
   const size_t tree_height = Pow2(3);
-  MerkleTree tree(tree_height);
+  MerkleTree<TypeParam> tree(tree_height);
   EXPECT_ASSERT(tree.GetRoot(4), testing::HasSubstr("Depth should not exceed tree's height."));
   EXPECT_ASSERT(tree.GetRoot(-1), testing::HasSubstr("Depth should not exceed tree's height."));
 }
 
-TEST(MerkleTreeTest, InvalidMerkleConstructorInput) {
+TYPED_TEST(MerkleTreeTest, InvalidMerkleConstructorInput) {
   const size_t tree_height = Pow2(3) + 1;
   EXPECT_ASSERT(
-      MerkleTree tree(tree_height), testing::HasSubstr("Data length is not a power of 2."));
+      MerkleTree<TypeParam> tree(tree_height),
+      testing::HasSubstr("Data length is not a power of 2."));
 }
 
-TEST(MerkleTreeTest, InvalidGenerateDecommitmentInput) {
+TYPED_TEST(MerkleTreeTest, InvalidGenerateDecommitmentInput) {
   const std::set<uint64_t> empty_queries;
   const Prng channel_prng;
   ProverChannel prover_channel(channel_prng.Clone());
-  MerkleTree tree(Pow2(3));
+  MerkleTree<TypeParam> tree(Pow2(3));
   EXPECT_ASSERT(
       tree.GenerateDecommitment(empty_queries, &prover_channel),
       testing::HasSubstr("Empty input queries."));
@@ -84,47 +372,47 @@ TEST(MerkleTreeTest, InvalidGenerateDecommitmentInput) {
       testing::HasSubstr("Query out of range."));
 }
 
-TEST(MerkleTreeTest, InvalidDataSize) {
+TYPED_TEST(MerkleTreeTest, InvalidDataSize) {
   Prng prng;
   size_t tree_size = Pow2(3);
-  std::vector<Blake2s160> data1 = GetRandomData(tree_size + 1, &prng);
-  MerkleTree tree1(tree_size);
+  std::vector<TypeParam> data1 = GetRandomData<TypeParam>(tree_size + 1, &prng);
+  MerkleTree<TypeParam> tree1(tree_size);
   EXPECT_ASSERT(
       tree1.AddData(data1, 0),
       testing::HasSubstr("exceeds the data length declared at tree construction"));
-  std::vector<Blake2s160> data2 = GetRandomData(tree_size, &prng);
-  MerkleTree tree2(tree_size);
+  std::vector<TypeParam> data2 = GetRandomData<TypeParam>(tree_size, &prng);
+  MerkleTree<TypeParam> tree2(tree_size);
   EXPECT_ASSERT(
       tree2.AddData(data2, 2),
       testing::HasSubstr("exceeds the data length declared at tree construction"));
 }
 
 // Check that different trees get different roots.
-TEST(MerkleTreeTest, DifferentRootForDifferentTrees) {
+TYPED_TEST(MerkleTreeTest, DifferentRootForDifferentTrees) {
   Prng prng;
   size_t tree_height = prng.UniformInt(0, 10);
-  std::vector<Blake2s160> data = GetRandomData(Pow2(tree_height), &prng);
-  MerkleTree tree(data.size());
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(Pow2(tree_height), &prng);
+  MerkleTree<TypeParam> tree(data.size());
   tree.AddData(data, 0);
-  Blake2s160 root1 = tree.GetRoot(0);
-  tree.AddData(GetRandomData(1, &prng), 0);
-  Blake2s160 root2 = tree.GetRoot(tree_height);
+  TypeParam root1 = tree.GetRoot(0);
+  tree.AddData(GetRandomData<TypeParam>(1, &prng), 0);
+  TypeParam root2 = tree.GetRoot(tree_height);
   EXPECT_NE(root1, root2);
 }
 
 /*
   Generates random queries to a random tree, and checks that the decommitment passes verification.
 */
-TEST(MerkleTreeTest, QueryVerificationPositive) {
+TYPED_TEST(MerkleTreeTest, QueryVerificationPositive) {
   Prng prng;
   uint64_t data_length = Pow2(prng.UniformInt(0, 10));
-  std::vector<Blake2s160> data = GetRandomData(data_length, &prng);
-  MerkleTree tree(data.size());
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(data_length, &prng);
+  MerkleTree<TypeParam> tree(data.size());
   tree.AddData(data, 0);
-  Blake2s160 root = tree.GetRoot(0);
+  TypeParam root = tree.GetRoot(0);
   std::set<uint64_t> queries;
   size_t num_queries = prng.UniformInt(static_cast<size_t>(1), std::min<size_t>(10, data_length));
-  std::map<uint64_t, Blake2s160> query_data;
+  std::map<uint64_t, TypeParam> query_data;
   while (queries.size() < num_queries) {
     uint64_t query = prng.UniformInt(static_cast<uint64_t>(0), data_length - 1);
     queries.insert(query);
@@ -135,7 +423,8 @@ TEST(MerkleTreeTest, QueryVerificationPositive) {
   ProverChannel prover_channel(channel_prng.Clone());
   tree.GenerateDecommitment(queries, &prover_channel);
   VerifierChannel verifier_channel(channel_prng.Clone(), prover_channel.GetProof());
-  EXPECT_TRUE(MerkleTree::VerifyDecommitment(query_data, data_length, root, &verifier_channel));
+  EXPECT_TRUE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, root, &verifier_channel));
 }
 
 /*
@@ -143,17 +432,17 @@ TEST(MerkleTreeTest, QueryVerificationPositive) {
   decommitment with data that differs a bit from the one initially given to the tree. We expect it
   to fail.
 */
-TEST(MerkleTreeTest, QueryVerificationNegative) {
+TYPED_TEST(MerkleTreeTest, QueryVerificationNegative) {
   Prng prng;
   uint64_t data_length = Pow2(prng.UniformInt(0, 10));
-  std::vector<Blake2s160> data = GetRandomData(data_length, &prng);
-  MerkleTree tree(data.size());
+  std::vector<TypeParam> data = GetRandomData<TypeParam>(data_length, &prng);
+  MerkleTree<TypeParam> tree(data.size());
   tree.AddData(data, 0);
-  Blake2s160 root = tree.GetRoot(0);
+  TypeParam root = tree.GetRoot(0);
   std::set<uint64_t> queries;
   size_t num_queries =
       prng.UniformInt(static_cast<uint64_t>(1), std::min<uint64_t>(10, data_length));
-  std::map<uint64_t, Blake2s160> query_data;
+  std::map<uint64_t, TypeParam> query_data;
   while (queries.size() < num_queries) {
     uint64_t query = prng.UniformInt(static_cast<uint64_t>(0), data_length - 1);
     queries.insert(query);
@@ -162,13 +451,14 @@ TEST(MerkleTreeTest, QueryVerificationNegative) {
   // Change one item in the query data.
   auto it = query_data.begin();
   std::advance(it, prng.template UniformInt<size_t>(0, query_data.size() - 1));
-  it->second = GetRandomData(1, &prng)[0];
+  it->second = GetRandomData<TypeParam>(1, &prng)[0];
 
   const Prng channel_prng;
   ProverChannel prover_channel(channel_prng.Clone());
   tree.GenerateDecommitment(queries, &prover_channel);
   VerifierChannel verifier_channel(channel_prng.Clone(), prover_channel.GetProof());
-  EXPECT_FALSE(MerkleTree::VerifyDecommitment(query_data, data_length, root, &verifier_channel));
+  EXPECT_FALSE(MerkleTree<TypeParam>::VerifyDecommitment(
+      query_data, data_length, root, &verifier_channel));
 }
 
 }  // namespace
@@ -32,11 +32,13 @@ using PackagingCommitmentSchemeVerifierFactory =
 /*
   One component in the flow of commit and decommit. Incharge for packing elements in packages and
   communicate with the next component in the flow, which is stored as a member of the class
-  merkle_commitment_scheme_.
+  merkle_commitment_scheme_. HashT is the hash of the packages (see MerkleTree), which is usually
+  the hash of merkle_commitment_scheme_ as well.
 */
+template <typename HashT>
 class PackagingCommitmentSchemeProver : public CommitmentSchemeProver {
  public:
-  static constexpr size_t kMinSegmentBytes = 2 * Blake2s160::kDigestNumBytes;
+  static constexpr size_t kMinSegmentBytes = 2 * HashT::kDigestNumBytes;
 
   PackagingCommitmentSchemeProver(
       size_t size_of_element, uint64_t n_elements_in_segment, size_t n_segments,
@@ -55,6 +57,14 @@ class PackagingCommitmentSchemeProver : public CommitmentSchemeProver {
   void AddSegmentForCommitment(
       gsl::span<const std::byte> segment_data, size_t segment_index) override;
 
+  /*
+    Same as above, where the packages are serialized by serialize_elements and hashed batch by
+    batch (see PackerHasher::PackAndHash()), and the segment is never serialized as a whole.
+  */
+  void AddStreamedSegmentForCommitment(
+      size_t size_of_element, const ElementsSerializer& serialize_elements,
+      size_t segment_index) override;
+
   /*
     Commit to data by calling commit of merkle_commitment_scheme_.
   */
@@ -74,7 +84,7 @@ class PackagingCommitmentSchemeProver : public CommitmentSchemeProver {
   const uint64_t n_elements_in_segment_;
   const size_t n_segments_;
   ProverChannel* channel_;
-  const PackerHasher packer_;
+  const PackerHasher<HashT> packer_;
   std::unique_ptr<CommitmentSchemeProver> merkle_commitment_scheme_;
 
   std::set<uint64_t> queries_;
@@ -95,6 +105,7 @@ class PackagingCommitmentSchemeProver : public CommitmentSchemeProver {
 /*
   Verifier's corresponding code of PackagingCommitmentSchemeProver.
 */
+template <typename HashT>
 class PackagingCommitmentSchemeVerifier : public CommitmentSchemeVerifier {
  public:
   PackagingCommitmentSchemeVerifier(
@@ -119,10 +130,12 @@ class PackagingCommitmentSchemeVerifier : public CommitmentSchemeVerifier {
   const size_t size_of_element_;
   const uint64_t n_elements_;
   VerifierChannel* channel_;
-  const PackerHasher packer_;
+  const PackerHasher<HashT> packer_;
   std::unique_ptr<CommitmentSchemeVerifier> merkle_commitment_scheme_;
 };
 
 }  // namespace starkware
 
+#include "starkware/commitment_scheme/packaging_commitment_scheme.inl"
+
 #endif  // STARKWARE_COMMITMENT_SCHEME_PACKAGING_COMMITMENT_SCHEME_H_
@@ -5,14 +5,15 @@
 #include <utility>
 
 #include "starkware/commitment_scheme/packer_hasher.h"
-#include "starkware/crypt_tools/blake2s_160.h"
 #include "starkware/error_handling/error_handling.h"
 #include "starkware/math/math.h"
 #include "starkware/stl_utils/containers.h"
+#include "starkware/utils/buffer_pool.h"
 
 namespace starkware {
 
-PackagingCommitmentSchemeProver::PackagingCommitmentSchemeProver(
+template <typename HashT>
+PackagingCommitmentSchemeProver<HashT>::PackagingCommitmentSchemeProver(
     size_t size_of_element, uint64_t n_elements_in_segment, size_t n_segments,
     ProverChannel* channel,
     const MerkleCommitmentSchemeProverFactory& merkle_commitment_scheme_factory)
@@ -20,19 +21,25 @@ PackagingCommitmentSchemeProver::PackagingCommitmentSchemeProver(
       n_elements_in_segment_(n_elements_in_segment),
       n_segments_(n_segments),
       channel_(channel),
-      packer_(PackerHasher(size_of_element_, n_segments_ * n_elements_in_segment_)),
+      packer_(PackerHasher<HashT>(size_of_element_, n_segments_ * n_elements_in_segment_)),
       merkle_commitment_scheme_(merkle_commitment_scheme_factory(packer_.k_n_packages)),
       missing_element_queries_({}) {}
 
-size_t PackagingCommitmentSchemeProver::NumSegments() const { return n_segments_; }
+template <typename HashT>
+size_t PackagingCommitmentSchemeProver<HashT>::NumSegments() const { return n_segments_; }
 
-size_t PackagingCommitmentSchemeProver::GetNumOfPackages() const { return packer_.k_n_packages; }
+template <typename HashT>
+size_t PackagingCommitmentSchemeProver<HashT>::GetNumOfPackages() const {
+  return packer_.k_n_packages;
+}
 
-uint64_t PackagingCommitmentSchemeProver::SegmentLengthInElements() const {
+template <typename HashT>
+uint64_t PackagingCommitmentSchemeProver<HashT>::SegmentLengthInElements() const {
   return n_elements_in_segment_;
 }
 
-void PackagingCommitmentSchemeProver::AddSegmentForCommitment(
+template <typename HashT>
+void PackagingCommitmentSchemeProver<HashT>::AddSegmentForCommitment(
     gsl::span<const std::byte> segment_data, size_t segment_index) {
   ASSERT_RELEASE(
       segment_data.size() == n_elements_in_segment_ * size_of_element_,
@@ -42,9 +49,25 @@ void PackagingCommitmentSchemeProver::AddSegmentForCommitment(
       packer_.PackAndHash(segment_data), segment_index);
 }
 
-void PackagingCommitmentSchemeProver::Commit() { merkle_commitment_scheme_->Commit(); }
+template <typename HashT>
+void PackagingCommitmentSchemeProver<HashT>::AddStreamedSegmentForCommitment(
+    size_t size_of_element, const ElementsSerializer& serialize_elements, size_t segment_index) {
+  ASSERT_RELEASE(
+      size_of_element == size_of_element_,
+      "Element size is " + std::to_string(size_of_element) + " instead of the expected " +
+          std::to_string(size_of_element_));
+  // The hashes of the packages are the elements of the segment of merkle_commitment_scheme_.
+  PooledBuffer<HashT> hashes(SafeDiv(n_elements_in_segment_, packer_.k_n_elements_in_package));
+  packer_.PackAndHash(serialize_elements, hashes.Span());
+  merkle_commitment_scheme_->AddSegmentForCommitment(
+      hashes.Span().template as_span<const std::byte>(), segment_index);
+}
+
+template <typename HashT>
+void PackagingCommitmentSchemeProver<HashT>::Commit() { merkle_commitment_scheme_->Commit(); }
 
-std::vector<uint64_t> PackagingCommitmentSchemeProver::StartDecommitmentPhase(
+template <typename HashT>
+std::vector<uint64_t> PackagingCommitmentSchemeProver<HashT>::StartDecommitmentPhase(
     const std::set<uint64_t>& queries) {
   queries_ = queries;
   // Compute the missing elements required to compute hashes for the current layer.
@@ -77,7 +100,8 @@ std::vector<uint64_t> PackagingCommitmentSchemeProver::StartDecommitmentPhase(
   return all_missing_elements;
 }
 
-void PackagingCommitmentSchemeProver::Decommit(gsl::span<const std::byte> elements_data) {
+template <typename HashT>
+void PackagingCommitmentSchemeProver<HashT>::Decommit(gsl::span<const std::byte> elements_data) {
   ASSERT_RELEASE(
       elements_data.size() == size_of_element_ * (missing_element_queries_.size() +
                                                   n_missing_elements_for_merkle_layer_),
@@ -100,20 +124,23 @@ void PackagingCommitmentSchemeProver::Decommit(gsl::span<const std::byte> elemen
   merkle_commitment_scheme_->Decommit(data_for_merkle_layer);
 }
 
-PackagingCommitmentSchemeVerifier::PackagingCommitmentSchemeVerifier(
+template <typename HashT>
+PackagingCommitmentSchemeVerifier<HashT>::PackagingCommitmentSchemeVerifier(
     size_t size_of_element, uint64_t n_elements, VerifierChannel* channel,
     const PackagingCommitmentSchemeVerifierFactory& merkle_commitment_scheme_factory)
     : size_of_element_(size_of_element),
       n_elements_(n_elements),
       channel_(channel),
-      packer_(PackerHasher(size_of_element, n_elements_)),
+      packer_(PackerHasher<HashT>(size_of_element, n_elements_)),
       merkle_commitment_scheme_(merkle_commitment_scheme_factory(packer_.k_n_packages)) {}
 
-void PackagingCommitmentSchemeVerifier::ReadCommitment() {
+template <typename HashT>
+void PackagingCommitmentSchemeVerifier<HashT>::ReadCommitment() {
   merkle_commitment_scheme_->ReadCommitment();
 }
 
-bool PackagingCommitmentSchemeVerifier::VerifyIntegrity(
+template <typename HashT>
+bool PackagingCommitmentSchemeVerifier<HashT>::VerifyIntegrity(
     const std::map<uint64_t, std::vector<std::byte>>& elements_to_verify) {
   // Get missing elements (i.e., ones in the same packages as at least one element in
   // elements_to_verify, but that are not elements that the verifier actually asked about) by
@@ -135,6 +162,9 @@ bool PackagingCommitmentSchemeVerifier::VerifyIntegrity(
   return merkle_commitment_scheme_->VerifyIntegrity(bytes_to_verify);
 }
 
-size_t PackagingCommitmentSchemeVerifier::GetNumOfPackages() const { return packer_.k_n_packages; }
+template <typename HashT>
+size_t PackagingCommitmentSchemeVerifier<HashT>::GetNumOfPackages() const {
+  return packer_.k_n_packages;
+}
 
 }  // namespace starkware
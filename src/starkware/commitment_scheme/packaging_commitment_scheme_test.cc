@@ -1,5 +1,6 @@
 #include "starkware/commitment_scheme/packaging_commitment_scheme.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -27,7 +28,7 @@ size_t GetNumOfPackages(
   // Prover.
   StrictMock<ProverChannelMock> prover_channel;
   size_t prover_factory_input;
-  const PackagingCommitmentSchemeProver packaging_prover(
+  const PackagingCommitmentSchemeProver<Blake2s160> packaging_prover(
       size_of_element, n_elements_in_segment, n_segments, &prover_channel,
       [&prover_factory_input](
           size_t n_elements_inner_layer) -> std::unique_ptr<CommitmentSchemeProver> {
@@ -40,7 +41,7 @@ size_t GetNumOfPackages(
   // Verifier.
   StrictMock<VerifierChannelMock> verifier_channel;
   size_t verifier_factory_input;
-  const PackagingCommitmentSchemeVerifier packaging_verifier(
+  const PackagingCommitmentSchemeVerifier<Blake2s160> packaging_verifier(
       size_of_element, n_elements_in_segment * n_segments, &verifier_channel,
       [&verifier_factory_input](
           size_t n_elements_inner_layer) -> std::unique_ptr<CommitmentSchemeVerifier> {
@@ -88,7 +89,7 @@ TEST(PackagingCommitmentSchemeProver, NumSegments) {
   Prng prng;
   const size_t n_segments = Pow2(prng.UniformInt<size_t>(1, 10));
   StrictMock<ProverChannelMock> prover_channel;
-  const PackagingCommitmentSchemeProver packaging_prover(
+  const PackagingCommitmentSchemeProver<Blake2s160> packaging_prover(
       prng.UniformInt<size_t>(1, sizeof(Blake2s160) * 5), Pow2(prng.UniformInt<size_t>(1, 10)),
       n_segments, &prover_channel,
       [](size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeProver> {
@@ -99,29 +100,42 @@ TEST(PackagingCommitmentSchemeProver, NumSegments) {
 
 /*
   Given parameters for PackagingCommitmentSchemeProver, creates PackagingCommitmentSchemeProver
-  instance and tests the functions AddSegmentForCommitment and Commit.
+  instance and tests the functions AddSegmentForCommitment (or AddStreamedSegmentForCommitment, if
+  streamed is true) and Commit.
 */
 void TestAddSegmentForCommitmentAndCommit(
-    const size_t size_of_element, const uint64_t n_elements_in_segment, const size_t n_segments) {
+    const size_t size_of_element, const uint64_t n_elements_in_segment, const size_t n_segments,
+    const bool streamed = false) {
   Prng prng;
   StrictMock<ProverChannelMock> prover_channel;
   const size_t segment_index = prng.UniformInt<size_t>(0, n_segments);
   const size_t size_of_data = size_of_element * n_elements_in_segment;
   const std::vector<std::byte> data = prng.RandomByteVector(size_of_data);
-  const PackerHasher packer(size_of_element, n_segments * n_elements_in_segment);
+  const PackerHasher<Blake2s160> packer(size_of_element, n_segments * n_elements_in_segment);
   std::vector<std::byte> packed = packer.PackAndHash(data);
   auto inner_commitment_scheme = std::make_unique<StrictMock<CommitmentSchemeProverMock>>();
   EXPECT_CALL(
       *inner_commitment_scheme,
       AddSegmentForCommitment(gsl::span<const std::byte>(packed), segment_index));
   EXPECT_CALL(*inner_commitment_scheme, Commit());
-  PackagingCommitmentSchemeProver packaging_prover(
+  PackagingCommitmentSchemeProver<Blake2s160> packaging_prover(
       size_of_element, n_elements_in_segment, n_segments, &prover_channel,
       [&inner_commitment_scheme](
           size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeProver> {
         return std::move(inner_commitment_scheme);
       });
-  packaging_prover.AddSegmentForCommitment(data, segment_index);
+  if (streamed) {
+    packaging_prover.AddStreamedSegmentForCommitment(
+        size_of_element,
+        [&data, size_of_element](uint64_t first_element, gsl::span<std::byte> output) {
+          const auto elements =
+              gsl::make_span(data).subspan(first_element * size_of_element, output.size());
+          std::copy(elements.begin(), elements.end(), output.begin());
+        },
+        segment_index);
+  } else {
+    packaging_prover.AddSegmentForCommitment(data, segment_index);
+  }
   packaging_prover.Commit();
 }
 
@@ -137,13 +151,25 @@ TEST(PackagingCommitmentSchemeProver, AddSegmentForCommitmentAndCommit) {
   TestAddSegmentForCommitmentAndCommit(4 * Blake2s160::kDigestNumBytes, 1, 8);
 }
 
+TEST(PackagingCommitmentSchemeProver, AddStreamedSegmentForCommitmentAndCommit) {
+  TestAddSegmentForCommitmentAndCommit(2 * Blake2s160::kDigestNumBytes, 8, 16, true);
+  TestAddSegmentForCommitmentAndCommit(1, 128, 16, true);
+  TestAddSegmentForCommitmentAndCommit(11, 32, 4, true);
+  TestAddSegmentForCommitmentAndCommit(33, 2, 1, true);
+  TestAddSegmentForCommitmentAndCommit(2 * Blake2s160::kDigestNumBytes + 15, 1, 32, true);
+  // Segments that are hashed in several batches, the last of which is partial.
+  TestAddSegmentForCommitmentAndCommit(8, 8192, 2, true);
+  TestAddSegmentForCommitmentAndCommit(24, 4096, 4, true);
+  TestAddSegmentForCommitmentAndCommit(200, 1024, 1, true);
+}
+
 TEST(PackagingCommitmentSchemeProver, AddSegmentForCommitment_AssertsChecks) {
   const size_t size_of_element = 2 * Blake2s160::kDigestNumBytes;
   const uint64_t n_elements_in_segment = 8;
   const size_t n_segments = 16;
   Prng prng;
   StrictMock<ProverChannelMock> prover_channel;
-  PackagingCommitmentSchemeProver packaging_prover(
+  PackagingCommitmentSchemeProver<Blake2s160> packaging_prover(
       size_of_element, n_elements_in_segment, n_segments, &prover_channel,
       [](size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeProver> {
         return std::make_unique<StrictMock<CommitmentSchemeProverMock>>();
@@ -176,7 +202,7 @@ TEST(PackagingCommitmentSchemeProver, StartDecommitmentPhaseAndDecommit) {
       *inner_commitment_scheme,
       Decommit(
           testing::Property(&gsl::span<const std::byte>::size, 2 * Blake2s160::kDigestNumBytes)));
-  PackagingCommitmentSchemeProver packaging_prover(
+  PackagingCommitmentSchemeProver<Blake2s160> packaging_prover(
       element_size, 16, 8, &prover_channel,
       [&inner_commitment_scheme](
           size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeProver> {
@@ -211,7 +237,7 @@ TEST(PackagingCommitmentSchemeProver, StartDecommitmentPhaseAndDecommit) {
 TEST(PackagingCommitmentSchemeVerifier, ReadCommitment) {
   Prng prng;
   StrictMock<VerifierChannelMock> verifier_channel;
-  PackagingCommitmentSchemeVerifier packaging_verifier(
+  PackagingCommitmentSchemeVerifier<Blake2s160> packaging_verifier(
       prng.UniformInt<size_t>(1, sizeof(Blake2s160) * 5), Pow2(prng.UniformInt<size_t>(1, 10)),
       &verifier_channel,
       [](size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeVerifier> {
@@ -231,7 +257,7 @@ TEST(PackagingCommitmentSchemeVerifier, VerifyIntegritySmallElement) {
   verifier_channel.DisableAnnotations();
   const size_t element_size_small = 17;
   const size_t n_elements = Pow2(prng.UniformInt<size_t>(4, 10));
-  PackagingCommitmentSchemeVerifier packaging_verifier(
+  PackagingCommitmentSchemeVerifier<Blake2s160> packaging_verifier(
       element_size_small, n_elements, &verifier_channel,
       [](size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeVerifier> {
         auto inner_commitment_scheme_verifier =
@@ -279,12 +305,12 @@ TEST(PackagingCommitmentSchemeVerifier, VerifyIntegrityBigElement) {
   elements_to_verify[10] = prng.RandomByteVector(element_size_big);
   elements_to_verify[11] = prng.RandomByteVector(element_size_big);
 
-  const PackerHasher packer(element_size_big, n_elements);
+  const PackerHasher<Blake2s160> packer(element_size_big, n_elements);
   auto inner_commitment_scheme_verifier =
       std::make_unique<StrictMock<CommitmentSchemeVerifierMock>>();
   EXPECT_CALL(
       *inner_commitment_scheme_verifier, VerifyIntegrity(packer.PackAndHash(elements_to_verify)));
-  PackagingCommitmentSchemeVerifier packaging_verifier(
+  PackagingCommitmentSchemeVerifier<Blake2s160> packaging_verifier(
       element_size_big, n_elements, &verifier_channel,
       [&inner_commitment_scheme_verifier](
           size_t /*n_elements_inner_layer*/) -> std::unique_ptr<CommitmentSchemeVerifier> {
@@ -2,6 +2,8 @@
 #define STARKWARE_COMMITMENT_SCHEME_PACKER_HASHER_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -19,7 +21,10 @@ namespace starkware {
   the basic element for the tree. This is more economic but introduces a slight complication, as
   whenever one wants an authentication path for some element, one needs all the elements in the
   package containing that element. This class provides the necessary methods to handle this case.
+
+  HashT is the hash of the packages (see MerkleTree).
 */
+template <typename HashT>
 class PackerHasher {
  public:
   PackerHasher(size_t size_of_element, size_t n_elements);
@@ -30,6 +35,16 @@ class PackerHasher {
   */
   std::vector<std::byte> PackAndHash(gsl::span<const std::byte> data) const;
 
+  /*
+    Same as above, for the hashes.size() packages of the elements that serialize_elements writes
+    (see CommitmentSchemeProver::ElementsSerializer), and writes the hash of each package to hashes.
+    The data is never held as a whole: batches of packages are serialized to a small buffer and
+    hashed, in parallel.
+  */
+  void PackAndHash(
+      const std::function<void(uint64_t, gsl::span<std::byte>)>& serialize_elements,
+      gsl::span<HashT> hashes) const;
+
   /*
     Given a list of elements (elements_known), known to the caller, returns a vector of the
     additional elements that the caller has to provide so that the packer can compute the set of
@@ -67,9 +82,17 @@ class PackerHasher {
   const size_t k_n_packages;
 
  private:
+  /*
+    The approximate number of bytes of the batches of packages that are serialized and hashed
+    together by PackAndHash(), small enough to stay in the cache.
+  */
+  static constexpr size_t kBatchBytes = 16384;
+
   const size_t k_size_of_element_;
 };
 
 }  // namespace starkware
 
+#include "starkware/commitment_scheme/packer_hasher.inl"
+
 #endif  // STARKWARE_COMMITMENT_SCHEME_PACKER_HASHER_H_
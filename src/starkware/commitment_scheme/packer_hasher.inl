@@ -1,22 +1,24 @@
 #include "starkware/commitment_scheme/packer_hasher.h"
 
 #include <algorithm>
+#include <vector>
 
-#include "starkware/crypt_tools/blake2s_160.h"
 #include "starkware/error_handling/error_handling.h"
 #include "starkware/math/math.h"
 #include "starkware/stl_utils/containers.h"
+#include "starkware/utils/task_manager.h"
 
 namespace starkware {
 
-namespace {
+namespace packer_hasher {
+namespace details {
 
 /*
   Computes the number of elements that go in each package. Designed so that each package contains
   the minimal number of elements possible, without introducing trivial efficiency issues. The
   result will be at most max_n_elements.
 */
-size_t ComputeNumElementsInPackage(
+inline size_t ComputeNumElementsInPackage(
     const size_t size_of_element, const size_t size_of_package, const uint64_t max_n_elements) {
   ASSERT_RELEASE(size_of_element > 0, "An element must be at least of length 1 byte.");
   if (size_of_element >= size_of_package) {
@@ -30,29 +32,31 @@ size_t ComputeNumElementsInPackage(
   Partitions the sequence to n_elements equal sub-sequences, hashing
   each separately, and returning the resulting sequence of hashes as vector of bytes.
 */
+template <typename HashT>
 std::vector<std::byte> HashElements(gsl::span<const std::byte> data, size_t n_elements) {
   if (n_elements == 0 && data.empty()) {
     return {};
   }
   const size_t element_size = SafeDiv(data.size(), n_elements);
+  std::vector<HashT> hashes(n_elements);
+  HashT::HashMany(data, element_size, hashes);
   std::vector<std::byte> res;
-  res.reserve(n_elements * Blake2s160::kDigestNumBytes);
-  size_t pos = 0;
-  for (size_t i = 0; i < n_elements; ++i, pos += element_size) {
-    const auto hash_as_bytes_array =
-        (Blake2s160::HashBytesWithLength(data.subspan(pos, element_size))).GetDigest();
-    res.insert(res.end(), hash_as_bytes_array.begin(), hash_as_bytes_array.end());
+  res.reserve(n_elements * HashT::kDigestNumBytes);
+  for (const HashT& hash : hashes) {
+    res.insert(res.end(), hash.GetDigest().begin(), hash.GetDigest().end());
   }
   return res;
 }
 
-}  // namespace
+}  // namespace details
+}  // namespace packer_hasher
 
 // Implementation of PackerHasher.
 
-PackerHasher::PackerHasher(size_t size_of_element, size_t n_elements)
-    : k_n_elements_in_package(ComputeNumElementsInPackage(
-          size_of_element, 2 * Blake2s160::kDigestNumBytes, n_elements)),
+template <typename HashT>
+PackerHasher<HashT>::PackerHasher(size_t size_of_element, size_t n_elements)
+    : k_n_elements_in_package(packer_hasher::details::ComputeNumElementsInPackage(
+          size_of_element, 2 * HashT::kDigestNumBytes, n_elements)),
       k_n_packages(SafeDiv(n_elements, k_n_elements_in_package)),
       k_size_of_element_(size_of_element) {
   ASSERT_RELEASE(
@@ -66,16 +70,47 @@ PackerHasher::PackerHasher(size_t size_of_element, size_t n_elements)
       "There are less elements overall than there should be in a single package.");
 }
 
-std::vector<std::byte> PackerHasher::PackAndHash(gsl::span<const std::byte> data) const {
+template <typename HashT>
+std::vector<std::byte> PackerHasher<HashT>::PackAndHash(gsl::span<const std::byte> data) const {
   if (data.empty()) {
     return {};
   }
   size_t n_elements_in_data = SafeDiv(data.size(), k_size_of_element_);
   size_t n_packages = SafeDiv(n_elements_in_data, k_n_elements_in_package);
-  return HashElements(data, n_packages);
+  return packer_hasher::details::HashElements<HashT>(data, n_packages);
 }
 
-std::vector<uint64_t> PackerHasher::GetElementsInPackages(
+template <typename HashT>
+void PackerHasher<HashT>::PackAndHash(
+    const std::function<void(uint64_t, gsl::span<std::byte>)>& serialize_elements,
+    gsl::span<HashT> hashes) const {
+  const size_t package_size = k_size_of_element_ * k_n_elements_in_package;
+  const uint64_t packages_per_batch =
+      std::min<uint64_t>(std::max<size_t>(kBatchBytes / package_size, 1), hashes.size());
+  if (packages_per_batch == 0) {
+    return;
+  }
+  const uint64_t n_batches = DivCeil(hashes.size(), packages_per_batch);
+  // Every package depends only on its elements, so the order in which the batches are hashed does
+  // not affect the result.
+  TaskManager::GetInstance().ParallelFor(
+      n_batches,
+      [&](const TaskInfo& task_info) {
+        std::vector<std::byte> packages(packages_per_batch * package_size);
+        for (uint64_t batch = task_info.start_idx; batch < task_info.end_idx; ++batch) {
+          const uint64_t first_package = batch * packages_per_batch;
+          const uint64_t n_packages =
+              std::min<uint64_t>(packages_per_batch, hashes.size() - first_package);
+          const auto batch_data = gsl::make_span(packages).subspan(0, n_packages * package_size);
+          serialize_elements(first_package * k_n_elements_in_package, batch_data);
+          HashT::HashMany(batch_data, package_size, hashes.subspan(first_package, n_packages));
+        }
+      },
+      n_batches);
+}
+
+template <typename HashT>
+std::vector<uint64_t> PackerHasher<HashT>::GetElementsInPackages(
     gsl::span<const uint64_t> packages) const {
   // Finds all elements that belong to the required packages.
   std::vector<uint64_t> elements_needed;
@@ -89,7 +124,8 @@ std::vector<uint64_t> PackerHasher::GetElementsInPackages(
   return elements_needed;
 }
 
-std::vector<uint64_t> PackerHasher::ElementsRequiredToComputeHashes(
+template <typename HashT>
+std::vector<uint64_t> PackerHasher<HashT>::ElementsRequiredToComputeHashes(
     const std::set<uint64_t>& elements_known) const {
   std::set<uint64_t> packages;
 
@@ -109,7 +145,8 @@ std::vector<uint64_t> PackerHasher::ElementsRequiredToComputeHashes(
   return required_elements;
 }
 
-std::map<uint64_t, std::vector<std::byte>> PackerHasher::PackAndHash(
+template <typename HashT>
+std::map<uint64_t, std::vector<std::byte>> PackerHasher<HashT>::PackAndHash(
     const std::map<uint64_t, std::vector<std::byte>>& elements) const {
   std::set<uint64_t> packages;
   std::map<uint64_t, std::vector<std::byte>> hashed_packages;
@@ -133,7 +170,7 @@ std::map<uint64_t, std::vector<std::byte>> PackerHasher::PackAndHash(
       pos_in_packed_elements += element_data.size();
     }
     // Hashes a package of elements and stores it as a vector of bytes.
-    const auto bytes_array = Blake2s160::HashBytesWithLength(packed_elements).GetDigest();
+    const auto bytes_array = HashT::HashBytesWithLength(packed_elements).GetDigest();
     hashed_packages[package] = {bytes_array.begin(), bytes_array.end()};
   }
   return hashed_packages;
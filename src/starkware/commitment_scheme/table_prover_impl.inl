@@ -9,6 +9,7 @@
 
 #include "starkware/channel/annotation_scope.h"
 #include "starkware/commitment_scheme/table_impl_details.h"
+#include "starkware/math/math.h"
 #include "starkware/stl_utils/containers.h"
 
 namespace starkware {
@@ -40,28 +41,48 @@ bool AreAllColumnsSameLength(gsl::span<const gsl::span<const T>> columns) {
   rows, and the order of columns inside each row. Formally, if each field element takes 'b' bytes,
   and there are 'c' columns, the element from column 'x' and row 'y' occupies 'b' bytes, starting at
   index '(y * c + x)*b'.
+  The serialization is written to serialization_span, which must be of size
+  SerializationSize(columns), or, for the rows first_row, first_row + 1, ..., of a multiple of the
+  size of a row.
 */
 template <typename FieldElementT>
-std::vector<std::byte> SerializeFieldColumns(
-    gsl::span<const gsl::span<const FieldElementT>> columns) {
+size_t SerializationSize(gsl::span<const gsl::span<const FieldElementT>> columns) {
+  return GetNumRows(columns) * columns.size() * FieldElementT::SizeInBytes();
+}
+
+template <typename FieldElementT>
+void SerializeFieldColumns(
+    gsl::span<const gsl::span<const FieldElementT>> columns, uint64_t first_row,
+    gsl::span<std::byte> serialization_span) {
   ASSERT_RELEASE(AreAllColumnsSameLength(columns), "The sizes of the columns must be the same.");
   const size_t n_columns = columns.size();
-  const size_t n_rows = GetNumRows(columns);
   const size_t element_size_in_bytes = FieldElementT::SizeInBytes();
-  const size_t n_bytes_row = columns.size() * element_size_in_bytes;
+  const size_t n_rows = SafeDiv(serialization_span.size(), n_columns * element_size_in_bytes);
+  ASSERT_RELEASE(first_row + n_rows <= GetNumRows(columns), "Wrong serialization size.");
 
-  std::vector<std::byte> serialization(n_rows * n_bytes_row);
-  auto serialization_span = gsl::make_span(serialization);
-
-  for (size_t row = 0; row < n_rows; ++row) {
+  std::byte* element_bytes = serialization_span.data();
+  for (uint64_t row = first_row; row < first_row + n_rows; ++row) {
     for (size_t col = 0; col < n_columns; ++col) {
-      const size_t element_idx = row * n_columns + col;
-      const size_t element_byte_idx = element_idx * element_size_in_bytes;
-      columns[col][row].ToBytes(
-          serialization_span.subspan(element_byte_idx, element_size_in_bytes));
+      columns[col][row].ToBytes(gsl::make_span(element_bytes, element_size_in_bytes));
+      element_bytes += element_size_in_bytes;
     }
   }
+}
 
+template <typename FieldElementT>
+void SerializeFieldColumns(
+    gsl::span<const gsl::span<const FieldElementT>> columns,
+    gsl::span<std::byte> serialization_span) {
+  ASSERT_RELEASE(
+      serialization_span.size() == SerializationSize(columns), "Wrong serialization size.");
+  SerializeFieldColumns(columns, 0, serialization_span);
+}
+
+template <typename FieldElementT>
+std::vector<std::byte> SerializeFieldColumns(
+    gsl::span<const gsl::span<const FieldElementT>> columns) {
+  std::vector<std::byte> serialization(SerializationSize(columns));
+  SerializeFieldColumns(columns, gsl::make_span(serialization));
   return serialization;
 }
 
@@ -76,9 +97,18 @@ void TableProverImpl<FieldElementT>::AddSegmentForCommitment(
       segment.size() * n_interleaved_columns == n_columns_,
       "Expected number of columns should be segment.size() * n_interleaved_columns.");
   // SerializeFieldColumns() concatenates the rows of the table into one long vector of bytes.
-  // The result of the concatenation is independent of n_interleaved_columns.
-  commitment_scheme_->AddSegmentForCommitment(
-      table_prover_impl::details::SerializeFieldColumns<FieldElementT>(segment), segment_index);
+  // The result of the concatenation is independent of n_interleaved_columns, except that every
+  // element of the commitment scheme (a row of the table) consists of n_interleaved_columns rows of
+  // segment. The rows are serialized only when the commitment scheme hashes them, rather than into
+  // a buffer of the whole segment.
+  const gsl::span<const gsl::span<const FieldElementT>> columns = segment;
+  commitment_scheme_->AddStreamedSegmentForCommitment(
+      n_columns_ * FieldElementT::SizeInBytes(),
+      [columns, n_interleaved_columns](uint64_t first_row, gsl::span<std::byte> serialization) {
+        table_prover_impl::details::SerializeFieldColumns<FieldElementT>(
+            columns, first_row * n_interleaved_columns, serialization);
+      },
+      segment_index);
 }
 
 template <typename FieldElementT>
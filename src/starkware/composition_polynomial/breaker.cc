@@ -2,6 +2,7 @@
 
 #include "starkware/algebra/fft/fft.h"
 #include "starkware/algebra/polynomials.h"
+#include "starkware/utils/buffer_pool.h"
 #include "starkware/utils/task_manager.h"
 
 namespace starkware {
@@ -21,8 +22,8 @@ std::vector<gsl::span<const ExtensionFieldElement>> PolynomialBreak::Break(
 
   // Apply log_breaks_ layers of IFFT to get the evaluations of the h_i's.
   gsl::span<const ExtensionFieldElement> src = evaluation;
-  auto dst = ExtensionFieldElement::UninitializedVector(evaluation.size());
-  gsl::span<ExtensionFieldElement> dst_span = gsl::make_span(dst);
+  PooledBuffer<ExtensionFieldElement> dst(evaluation.size());
+  gsl::span<ExtensionFieldElement> dst_span = dst.Span();
   IfftReverseToNatural(src, dst_span, coset_.Generator(), coset_.Offset(), log_breaks_);
 
   // Evaluations of h_i are interleaved. Normalize IFFT output and reorder evaluations such that
@@ -32,10 +33,11 @@ std::vector<gsl::span<const ExtensionFieldElement>> PolynomialBreak::Break(
   ExtensionFieldElement correction_factor = ExtensionFieldElement::FromUint(n_breaks).Inverse();
   TaskManager::GetInstance().ParallelFor(
       chunk_size,
-      [n_breaks, chunk_size, &dst, output, &correction_factor](const TaskInfo& task_info) {
+      [n_breaks, chunk_size, dst_span, output, &correction_factor](const TaskInfo& task_info) {
         for (size_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
           for (size_t break_idx = 0; break_idx < n_breaks; ++break_idx) {
-            output[break_idx * chunk_size + i] = dst[i * n_breaks + break_idx] * correction_factor;
+            output[break_idx * chunk_size + i] =
+                dst_span[i * n_breaks + break_idx] * correction_factor;
           }
         }
       },
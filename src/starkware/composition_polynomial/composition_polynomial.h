@@ -58,7 +58,9 @@ class CompositionPolynomial {
 
   /*
     Evaluates the composition polynomial on the coset coset_offset*<group_generator>, which must be
-    of size coset_size. The evaluation is split into different tasks of size task_size each.
+    of size coset_size. The evaluation is split into different tasks of size task_size each. If
+    task_size is 0, the size of the tasks is chosen adaptively (see
+    TaskManager::ParallelForAdaptive()).
     The evaluation is written to 'out_evaluation', in bit-reversed order: out_evaluation[i] contains
     the evaluation on the point coset_offset*(group_generator^{bit_reverse(i)}).
   */
@@ -131,17 +131,6 @@ void CompositionPolynomialImpl<AirT>::EvalOnCosetBitReversedOutput(
 
   // Precompute useful constants.
   const size_t log_coset_size = SafeLog2(coset_size_);
-  const uint_fast64_t n_tasks = DivCeil(coset_size_, task_size);
-
-  // Prepare offset for each task.
-  std::vector<BaseFieldElement> algebraic_offsets;
-  algebraic_offsets.reserve(n_tasks);
-  BaseFieldElement point = coset_offset;
-  const BaseFieldElement point_multiplier = Pow(trace_generator_, task_size);
-  for (uint64_t i = 0; i < n_tasks; ++i) {
-    algebraic_offsets.push_back(point);
-    point *= point_multiplier;
-  }
 
   // Prepare #threads workers.
   using WorkerMemoryT = composition_polynomial::details::CompositionPolynomialImplWorkerMemory;
@@ -159,61 +148,91 @@ void CompositionPolynomialImpl<AirT>::EvalOnCosetBitReversedOutput(
     periodic_column_cosets.emplace_back(column.GetCoset(coset_offset, coset_size_));
   }
 
-  // Evaluate on coset.
+  // Evaluates on the points [initial_point_idx, end_of_coset_index) of the coset, where point is
+  // the point of index initial_point_idx.
   const std::vector<BaseFieldElement> gen_powers = BatchPow(trace_generator_, point_exponents_);
-  task_manager.ParallelFor(
-      n_tasks, [this, &algebraic_offsets, &periodic_column_cosets, &gen_powers, &worker_mem,
-                &neighbors, &out_evaluation, log_coset_size, task_size](const TaskInfo& task_info) {
-        const uint64_t initial_point_idx = task_size * task_info.start_idx;
-        BaseFieldElement point = algebraic_offsets[task_info.start_idx];
-        WorkerMemoryT& wm = worker_mem[TaskManager::GetWorkerId()];
-
-        // Compute point powers.
+  const auto eval_range = [this, &periodic_column_cosets, &gen_powers, &worker_mem, &neighbors,
+                           &out_evaluation, log_coset_size](
+                              uint64_t initial_point_idx, uint64_t end_of_coset_index,
+                              BaseFieldElement point) {
+    WorkerMemoryT& wm = worker_mem[TaskManager::GetWorkerId()];
+
+    // Compute point powers.
+    wm.point_powers[0] = point;
+    BatchPow(point, point_exponents_, gsl::make_span(wm.point_powers).subspan(1));
+
+    // Initialize periodic columns interators.
+    wm.periodic_columns_iter.clear();
+    for (const auto& column_coset : periodic_column_cosets) {
+      wm.periodic_columns_iter.push_back(column_coset.begin() + initial_point_idx);
+    }
+
+    typename Neighbors::Iterator neighbors_iter = neighbors.begin();
+    neighbors_iter += static_cast<size_t>(initial_point_idx);
+
+    for (size_t point_idx = initial_point_idx; point_idx < end_of_coset_index; ++point_idx) {
+      ASSERT_RELEASE(
+          neighbors_iter != neighbors.end(),
+          "neighbors_iter reached the end of the iterator unexpectedly.");
+      // Evaluate periodic columns.
+      for (size_t i = 0; i < periodic_columns_.size(); ++i) {
+        wm.periodic_column_vals[i] = *wm.periodic_columns_iter[i];
+        ++wm.periodic_columns_iter[i];
+      }
+
+      // Evaluate on a single point.
+      auto [neighbors_vals, composition_neighbors] = *neighbors_iter;  // NOLINT
+      out_evaluation[BitReverse(point_idx, log_coset_size)] =
+          air_->template ConstraintsEval<BaseFieldElement>(
+              neighbors_vals, composition_neighbors, wm.periodic_column_vals, coefficients_,
+              wm.point_powers, shifts_);
+
+      // On the last iteration, skip the preperations for the next iterations.
+      if (point_idx + 1 < end_of_coset_index) {
+        // Advance evaluation point.
+        point *= trace_generator_;
         wm.point_powers[0] = point;
-        BatchPow(point, point_exponents_, gsl::make_span(wm.point_powers).subspan(1));
-
-        // Initialize periodic columns interators.
-        wm.periodic_columns_iter.clear();
-        for (const auto& column_coset : periodic_column_cosets) {
-          wm.periodic_columns_iter.push_back(column_coset.begin() + initial_point_idx);
+        for (size_t i = 0; i < gen_powers.size(); ++i) {
+          // Shift point_powers, x^k -> (g*x)^k.
+          wm.point_powers[i + 1] *= gen_powers[i];
         }
 
-        typename Neighbors::Iterator neighbors_iter = neighbors.begin();
-        neighbors_iter += static_cast<size_t>(initial_point_idx);
-
-        const size_t actual_task_size = std::min(task_size, coset_size_ - initial_point_idx);
-        const size_t end_of_coset_index = initial_point_idx + actual_task_size;
-
-        for (size_t point_idx = initial_point_idx; point_idx < end_of_coset_index; ++point_idx) {
-          ASSERT_RELEASE(
-              neighbors_iter != neighbors.end(),
-              "neighbors_iter reached the end of the iterator unexpectedly.");
-          // Evaluate periodic columns.
-          for (size_t i = 0; i < periodic_columns_.size(); ++i) {
-            wm.periodic_column_vals[i] = *wm.periodic_columns_iter[i];
-            ++wm.periodic_columns_iter[i];
-          }
-
-          // Evaluate on a single point.
-          auto [neighbors_vals, composition_neighbors] = *neighbors_iter;  // NOLINT
-          out_evaluation[BitReverse(point_idx, log_coset_size)] =
-              air_->template ConstraintsEval<BaseFieldElement>(
-                  neighbors_vals, composition_neighbors, wm.periodic_column_vals, coefficients_,
-                  wm.point_powers, shifts_);
-
-          // On the last iteration, skip the preperations for the next iterations.
-          if (point_idx + 1 < end_of_coset_index) {
-            // Advance evaluation point.
-            point *= trace_generator_;
-            wm.point_powers[0] = point;
-            for (size_t i = 0; i < gen_powers.size(); ++i) {
-              // Shift point_powers, x^k -> (g*x)^k.
-              wm.point_powers[i + 1] *= gen_powers[i];
-            }
-
-            ++neighbors_iter;
-          }
-        }
+        ++neighbors_iter;
+      }
+    }
+  };
+
+  if (task_size == 0) {
+    // Adaptive task size: the chunks are of arbitrary sizes, so the first point of each chunk is
+    // computed by exponentiation.
+    task_manager.ParallelForAdaptive(
+        0, coset_size_,
+        [this, &eval_range, &coset_offset](const TaskInfo& task_info) {
+          eval_range(
+              task_info.start_idx, task_info.end_idx,
+              coset_offset * Pow(trace_generator_, task_info.start_idx));
+        },
+        "CompositionPolynomial::EvalOnCosetBitReversedOutput");
+    return;
+  }
+
+  // Prepare offset for each task.
+  const uint_fast64_t n_tasks = DivCeil(coset_size_, task_size);
+  std::vector<BaseFieldElement> algebraic_offsets;
+  algebraic_offsets.reserve(n_tasks);
+  BaseFieldElement point = coset_offset;
+  const BaseFieldElement point_multiplier = Pow(trace_generator_, task_size);
+  for (uint64_t i = 0; i < n_tasks; ++i) {
+    algebraic_offsets.push_back(point);
+    point *= point_multiplier;
+  }
+
+  task_manager.ParallelFor(
+      n_tasks, [this, &algebraic_offsets, &eval_range, task_size](const TaskInfo& task_info) {
+        const uint64_t initial_point_idx = task_size * task_info.start_idx;
+        eval_range(
+            initial_point_idx, std::min(initial_point_idx + task_size, coset_size_),
+            algebraic_offsets[task_info.start_idx]);
       });
 }
 
@@ -135,6 +135,8 @@ TEST(CompositionPolynomial, EvalCompositionOnCoset) {
   TestEvalCompositionOnCoset(prng.UniformInt(5, 8), 20);
   // task_size > coset_size.
   TestEvalCompositionOnCoset(4, Pow2(5));
+  // Adaptive task size.
+  TestEvalCompositionOnCoset(prng.UniformInt(5, 8), 0);
 }
 
 }  // namespace
@@ -1,6 +1,7 @@
 #include "third_party/blake2/blake2-impl.h"
 #include "third_party/blake2/blake2.h"
 
+#include "starkware/crypt_tools/blake2s_many_lanes.h"
 #include "starkware/error_handling/error_handling.h"
 #include "starkware/utils/to_from_string.h"
 
@@ -18,6 +19,45 @@ inline std::array<std::byte, Blake2s160::kDigestNumBytes> InitDigestFromSpan(
   return digest;
 }
 
+/*
+  A single lane of uint32_t, for MultiLaneBlake2s::Compress() and MultiLaneBlake2s::SearchNonce().
+*/
+struct ScalarOps {
+  using Vec = uint32_t;
+  static constexpr size_t kNLanes = 1;
+
+  static Vec Set1(uint32_t value) { return value; }
+  static Vec Load(const uint32_t* src) { return *src; }
+  static Vec Add(Vec a, Vec b) { return a + b; }
+  static Vec Xor(Vec a, Vec b) { return a ^ b; }
+  static Vec And(Vec a, Vec b) { return a & b; }
+  static uint32_t ZeroLanes(Vec value) { return value == 0 ? 1 : 0; }
+  template <int Bits>
+  static Vec Rotr(Vec value) {
+    return (value >> Bits) | (value << (32 - Bits));
+  }
+};
+
+/*
+  Hashes the 40 bytes left[0..20) || right[0..20), i.e. a node of a Merkle tree, to output.
+  The input fits in a single (zero-padded) block, so this is one compression from the precomputed
+  initial state, without the buffering of blake2s_update().
+*/
+inline void HashNode(const std::byte* left, const std::byte* right, std::byte* output) {
+  using blake2s_many::details::kBlake2s160InitialState;
+  constexpr size_t kDigestNumDWords = Blake2s160::kDigestNumBytes / sizeof(uint32_t);
+
+  // Blake2s reads the message words as little-endian, as the CPU.
+  std::array<uint32_t, 16> m{};
+  std::memcpy(m.data(), left, Blake2s160::kDigestNumBytes);
+  std::memcpy(m.data() + kDigestNumDWords, right, Blake2s160::kDigestNumBytes);
+  std::array<uint32_t, 8> h{};
+  std::copy(std::begin(kBlake2s160InitialState), std::end(kBlake2s160InitialState), h.begin());
+  blake2s_many::details::MultiLaneBlake2s<ScalarOps>::Compress(
+      m.data(), 2 * Blake2s160::kDigestNumBytes, /*is_last_block=*/true, h.data());
+  std::memcpy(output, h.data(), Blake2s160::kDigestNumBytes);
+}
+
 }  // namespace details
 }  // namespace blake2s_160
 
@@ -29,10 +69,9 @@ inline const Blake2s160 Blake2s160::InitDigestTo(gsl::span<const std::byte> dige
 }
 
 inline const Blake2s160 Blake2s160::Hash(const Blake2s160& val1, const Blake2s160& val2) {
-  std::array<std::byte, 2 * kDigestNumBytes> data{};
-  std::copy(val1.buffer_.begin(), val1.buffer_.end(), data.begin());
-  std::copy(val2.buffer_.begin(), val2.buffer_.end(), data.begin() + kDigestNumBytes);
-  return HashBytesWithLength(data);
+  Blake2s160 result;
+  blake2s_160::details::HashNode(val1.buffer_.data(), val2.buffer_.data(), result.buffer_.data());
+  return result;
 }
 
 inline const Blake2s160 Blake2s160::HashBytesWithLength(gsl::span<const std::byte> bytes) {
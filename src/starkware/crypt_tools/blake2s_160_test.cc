@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -10,9 +11,12 @@
 #include "gtest/gtest.h"
 #include "third_party/gsl/gsl-lite.hpp"
 
+#include "starkware/crypt_tools/blake2s_many.h"
 #include "starkware/error_handling/test_utils.h"
+#include "starkware/math/math.h"
 #include "starkware/randomness/prng.h"
 #include "starkware/stl_utils/containers.h"
+#include "starkware/utils/serialization.h"
 
 namespace starkware {
 namespace {
@@ -80,5 +84,71 @@ TEST(HashUtilsTest, BadInput) {
   EXPECT_ASSERT(Blake2s160::InitDigestTo(data_short), testing::HasSubstr(err_str));
 }
 
+TEST(Blake2s160, HashMany) {
+  Prng prng;
+  for (const blake2s_many::Backend backend : blake2s_many::SupportedBackends()) {
+    // Input sizes around the block size of Blake2s (64 bytes), and numbers of inputs that do not
+    // fill the lanes.
+    for (const size_t input_size : {0, 1, 20, 40, 63, 64, 65, 100, 128, 200}) {
+      for (const size_t n_inputs : {0, 1, 7, 8, 9, 16, 17, 40}) {
+        const std::vector<std::byte> data = prng.RandomByteVector(input_size * n_inputs);
+        std::vector<Blake2s160> output(n_inputs);
+        blake2s_many::HashMany(data, input_size, output, backend);
+        for (size_t i = 0; i < n_inputs; ++i) {
+          EXPECT_EQ(
+              Blake2s160::HashBytesWithLength(
+                  gsl::make_span(data).subspan(i * input_size, input_size)),
+              output[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(Blake2s160, HashManyDefaultBackend) {
+  Prng prng;
+  const std::vector<std::byte> data = prng.RandomByteVector(100 * 2 * Blake2s160::kDigestNumBytes);
+  std::vector<Blake2s160> output(100);
+  std::vector<Blake2s160> expected(100);
+  Blake2s160::HashMany(data, 2 * Blake2s160::kDigestNumBytes, output);
+  blake2s_many::HashMany(
+      data, 2 * Blake2s160::kDigestNumBytes, expected, blake2s_many::Backend::kReference);
+  EXPECT_EQ(expected, output);
+  EXPECT_ASSERT(
+      Blake2s160::HashMany(data, 3, output), testing::HasSubstr("Data size does not match"));
+}
+
+TEST(Blake2s160, SearchNonce) {
+  Prng prng;
+  const Blake2s160 prefix = prng.RandomHash();
+  std::array<std::byte, Blake2s160::kDigestNumBytes + sizeof(uint64_t)> input{};
+  std::copy(prefix.GetDigest().begin(), prefix.GetDigest().end(), input.begin());
+  const auto nonce_span = gsl::make_span(input).last(sizeof(uint64_t));
+
+  for (const blake2s_many::Backend backend : blake2s_many::SupportedBackends()) {
+    // Numbers of nonces that do not fill the lanes, and a start at which the low word of the nonce
+    // wraps around.
+    for (const uint64_t nonce_start : {uint64_t(0), uint64_t(1000), Pow2(32) - 37}) {
+      for (const uint64_t n_nonces : {0, 1, 7, 17, 100, 1000}) {
+        for (const size_t work_bits : {1, 3, 8, 40}) {
+          std::optional<uint64_t> expected;
+          for (uint64_t nonce = nonce_start; nonce < nonce_start + n_nonces; ++nonce) {
+            Serialize(nonce, nonce_span);
+            const Blake2s160 hash = Blake2s160::HashBytesWithLength(input);
+            if (Deserialize(gsl::make_span(hash.GetDigest()).first(sizeof(uint64_t))) <
+                Pow2(64 - work_bits)) {
+              expected = nonce;
+              break;
+            }
+          }
+          EXPECT_EQ(
+              expected,
+              blake2s_many::SearchNonce(prefix, nonce_start, n_nonces, work_bits, backend));
+        }
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace starkware
@@ -0,0 +1,137 @@
+#include "starkware/crypt_tools/blake2s_many.h"
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include "starkware/crypt_tools/blake2s_many_lanes.h"
+#include "starkware/error_handling/error_handling.h"
+
+namespace starkware {
+namespace blake2s_many {
+
+// The backends write the digests consecutively to the output.
+static_assert(sizeof(Blake2s160) == Blake2s160::kDigestNumBytes, "Unexpected Blake2s160 layout.");
+static_assert(std::is_standard_layout_v<Blake2s160>, "Unexpected Blake2s160 layout.");
+static_assert(Blake2s160::kDigestNumBytes == details::kBlake2sDigestBytes, "Wrong digest size.");
+
+bool IsSupported(Backend backend) {
+  switch (backend) {
+    case Backend::kReference:
+      return true;
+    case Backend::kAvx2:
+      return __builtin_cpu_supports("avx2");
+    case Backend::kAvx512:
+      return __builtin_cpu_supports("avx512f");
+  }
+  THROW_STARKWARE_EXCEPTION("Invalid backend.");
+}
+
+std::vector<Backend> SupportedBackends() {
+  std::vector<Backend> backends;
+  for (Backend backend : {Backend::kReference, Backend::kAvx2, Backend::kAvx512}) {
+    if (IsSupported(backend)) {
+      backends.push_back(backend);
+    }
+  }
+  return backends;
+}
+
+Backend GetBestBackend() {
+  static const Backend kBestBackend = SupportedBackends().back();
+  return kBestBackend;
+}
+
+size_t NumLanes(Backend backend) {
+  switch (backend) {
+    case Backend::kReference:
+      return 1;
+    case Backend::kAvx2:
+      return 8;
+    case Backend::kAvx512:
+      return 16;
+  }
+  THROW_STARKWARE_EXCEPTION("Invalid backend.");
+}
+
+void HashMany(
+    gsl::span<const std::byte> data, size_t input_size, gsl::span<Blake2s160> output,
+    Backend backend) {
+  ASSERT_RELEASE(
+      data.size() == input_size * output.size(), "Data size does not match the number of inputs.");
+  ASSERT_RELEASE(IsSupported(backend), "The CPU does not support the Blake2s backend.");
+  const size_t n_groups = backend == Backend::kReference ? 0 : output.size() / NumLanes(backend);
+  auto* const output_bytes = reinterpret_cast<std::byte*>(output.data());
+  switch (backend) {
+    case Backend::kReference:
+      break;
+    case Backend::kAvx2:
+      details::HashGroupsAvx2(data.data(), input_size, n_groups, output_bytes);
+      break;
+    case Backend::kAvx512:
+      details::HashGroupsAvx512(data.data(), input_size, n_groups, output_bytes);
+      break;
+  }
+
+  // Hash the remaining inputs one at a time.
+  for (size_t i = n_groups * NumLanes(backend); i < output.size(); ++i) {
+    if (input_size == 2 * Blake2s160::kDigestNumBytes) {
+      const std::byte* const node = data.data() + i * input_size;
+      blake2s_160::details::HashNode(
+          node, node + Blake2s160::kDigestNumBytes, output_bytes + i * Blake2s160::kDigestNumBytes);
+    } else {
+      output[i] = Blake2s160::HashBytesWithLength(data.subspan(i * input_size, input_size));
+    }
+  }
+}
+
+std::optional<uint64_t> SearchNonce(
+    const Blake2s160& prefix, uint64_t nonce_start, uint64_t n_nonces, size_t work_bits,
+    Backend backend) {
+  ASSERT_RELEASE(work_bits > 0 && work_bits <= 64, "Invalid number of bits of work.");
+  ASSERT_RELEASE(IsSupported(backend), "The CPU does not support the Blake2s backend.");
+  // The message words of the prefix (the backends run on x86, which is little-endian, as Blake2s).
+  std::array<uint32_t, Blake2s160::kDigestNumBytes / sizeof(uint32_t)> prefix_words{};
+  std::memcpy(prefix_words.data(), prefix.GetDigest().data(), Blake2s160::kDigestNumBytes);
+  // The bits of the first two words of the digest that have to be zero.
+  std::array<std::byte, 2 * sizeof(uint32_t)> zero_mask_bytes{};
+  for (size_t i = 0; i < work_bits; ++i) {
+    zero_mask_bytes[i / 8] |= std::byte(0x80 >> (i % 8));
+  }
+  std::array<uint32_t, 2> zero_mask{};
+  std::memcpy(zero_mask.data(), zero_mask_bytes.data(), zero_mask_bytes.size());
+
+  const uint64_t n_groups = backend == Backend::kReference ? 0 : n_nonces / NumLanes(backend);
+  uint64_t offset = n_groups * NumLanes(backend);
+  switch (backend) {
+    case Backend::kReference:
+      break;
+    case Backend::kAvx2:
+      offset = details::SearchNonceAvx2(
+          prefix_words.data(), nonce_start, n_groups, zero_mask.data());
+      break;
+    case Backend::kAvx512:
+      offset = details::SearchNonceAvx512(
+          prefix_words.data(), nonce_start, n_groups, zero_mask.data());
+      break;
+  }
+
+  if (offset == n_groups * NumLanes(backend)) {
+    // Search the remaining nonces one at a time.
+    offset += details::MultiLaneBlake2s<blake2s_160::details::ScalarOps>::SearchNonce(
+        prefix_words.data(), nonce_start + offset, n_nonces - offset, zero_mask.data());
+  }
+  if (offset == n_nonces) {
+    return std::nullopt;
+  }
+  return nonce_start + offset;
+}
+
+}  // namespace blake2s_many
+
+void Blake2s160::HashMany(
+    gsl::span<const std::byte> data, size_t input_size, gsl::span<Blake2s160> output) {
+  blake2s_many::HashMany(data, input_size, output, blake2s_many::GetBestBackend());
+}
+
+}  // namespace starkware
@@ -0,0 +1,68 @@
+#ifndef STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_H_
+#define STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "third_party/gsl/gsl-lite.hpp"
+
+#include "starkware/crypt_tools/blake2s_160.h"
+
+namespace starkware {
+namespace blake2s_many {
+
+/*
+  The implementations of Blake2s160::HashMany().
+*/
+enum class Backend {
+  // One input at a time, using the reference implementation.
+  kReference,
+  // 8 inputs at a time.
+  kAvx2,
+  // 16 inputs at a time.
+  kAvx512,
+};
+
+/*
+  Returns true if the CPU supports the given backend.
+*/
+bool IsSupported(Backend backend);
+
+/*
+  Returns all the backends that the CPU supports.
+*/
+std::vector<Backend> SupportedBackends();
+
+/*
+  Returns the fastest backend that the CPU supports. This is the one Blake2s160::HashMany() uses.
+*/
+Backend GetBestBackend();
+
+/*
+  Returns the number of inputs the given backend hashes at a time.
+*/
+size_t NumLanes(Backend backend);
+
+/*
+  Same as Blake2s160::HashMany(), using the given backend.
+*/
+void HashMany(
+    gsl::span<const std::byte> data, size_t input_size, gsl::span<Blake2s160> output,
+    Backend backend);
+
+/*
+  Returns the smallest nonce in [nonce_start, nonce_start + n_nonces) for which the hash of
+  prefix || nonce (with the nonce serialized as 8 big-endian bytes) starts with work_bits zero bits,
+  if there is one. This is the search of the proof of work (see ProofOfWorkProver), whose result is
+  the same as checking every nonce with Blake2s160::HashBytesWithLength(), using the given backend.
+*/
+std::optional<uint64_t> SearchNonce(
+    const Blake2s160& prefix, uint64_t nonce_start, uint64_t n_nonces, size_t work_bits,
+    Backend backend);
+
+}  // namespace blake2s_many
+}  // namespace starkware
+
+#endif  // STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_H_
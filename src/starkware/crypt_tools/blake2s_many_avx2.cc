@@ -0,0 +1,65 @@
+#include <immintrin.h>
+
+#include "starkware/crypt_tools/blake2s_many_lanes.h"
+
+namespace starkware {
+namespace blake2s_many {
+namespace details {
+
+namespace {
+
+/*
+  8 lanes of uint32_t in an AVX2 register.
+*/
+struct Avx2Ops {
+  using Vec = __m256i;
+  static constexpr size_t kNLanes = 8;
+
+  static Vec Set1(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+  static Vec Load(const uint32_t* src) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+  }
+  static void Store(uint32_t* dst, const Vec& value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+  }
+  static Vec Add(const Vec& a, const Vec& b) { return _mm256_add_epi32(a, b); }
+  static Vec Xor(const Vec& a, const Vec& b) { return _mm256_xor_si256(a, b); }
+  static Vec And(const Vec& a, const Vec& b) { return _mm256_and_si256(a, b); }
+  static uint32_t ZeroLanes(const Vec& value) {
+    const __m256i is_zero = _mm256_cmpeq_epi32(value, _mm256_setzero_si256());
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(is_zero)));
+  }
+
+  template <int Bits>
+  static Vec Rotr(const Vec& value) {
+    // Rotations by whole bytes are byte shuffles.
+    if constexpr (Bits == 16) {
+      return _mm256_shuffle_epi8(
+          value, _mm256_set_epi8(
+                     13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, 13, 12, 15, 14, 9, 8,
+                     11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+    } else if constexpr (Bits == 8) {
+      return _mm256_shuffle_epi8(
+          value, _mm256_set_epi8(
+                     12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1, 12, 15, 14, 13, 8, 11,
+                     10, 9, 4, 7, 6, 5, 0, 3, 2, 1));
+    } else {
+      return _mm256_or_si256(_mm256_srli_epi32(value, Bits), _mm256_slli_epi32(value, 32 - Bits));
+    }
+  }
+};
+
+}  // namespace
+
+void HashGroupsAvx2(const std::byte* data, size_t input_size, size_t n_groups, std::byte* output) {
+  MultiLaneBlake2s<Avx2Ops>::HashGroups(data, input_size, n_groups, output);
+}
+
+uint64_t SearchNonceAvx2(
+    const uint32_t* prefix, uint64_t nonce_start, uint64_t n_groups, const uint32_t* zero_mask) {
+  return MultiLaneBlake2s<Avx2Ops>::SearchNonce(prefix, nonce_start, n_groups, zero_mask);
+}
+
+}  // namespace details
+}  // namespace blake2s_many
+}  // namespace starkware
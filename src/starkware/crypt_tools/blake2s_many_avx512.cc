@@ -0,0 +1,50 @@
+#include <immintrin.h>
+
+#include "starkware/crypt_tools/blake2s_many_lanes.h"
+
+namespace starkware {
+namespace blake2s_many {
+namespace details {
+
+namespace {
+
+/*
+  16 lanes of uint32_t in an AVX-512 register.
+*/
+struct Avx512Ops {
+  using Vec = __m512i;
+  static constexpr size_t kNLanes = 16;
+
+  static Vec Set1(uint32_t value) { return _mm512_set1_epi32(static_cast<int>(value)); }
+  static Vec Load(const uint32_t* src) { return _mm512_loadu_si512(src); }
+  static void Store(uint32_t* dst, const Vec& value) { _mm512_storeu_si512(dst, value); }
+  static Vec Add(const Vec& a, const Vec& b) { return _mm512_add_epi32(a, b); }
+  static Vec Xor(const Vec& a, const Vec& b) { return _mm512_xor_si512(a, b); }
+  static Vec And(const Vec& a, const Vec& b) { return _mm512_and_si512(a, b); }
+  static uint32_t ZeroLanes(const Vec& value) {
+    return _mm512_cmpeq_epi32_mask(value, _mm512_setzero_si512());
+  }
+
+  template <int Bits>
+  static Vec Rotr(const Vec& value) {
+    // The same instruction as _mm512_ror_epi32(), which GCC warns about (its unmasked form is
+    // implemented with an undefined vector).
+    return _mm512_maskz_ror_epi32(static_cast<__mmask16>(-1), value, Bits);
+  }
+};
+
+}  // namespace
+
+void HashGroupsAvx512(
+    const std::byte* data, size_t input_size, size_t n_groups, std::byte* output) {
+  MultiLaneBlake2s<Avx512Ops>::HashGroups(data, input_size, n_groups, output);
+}
+
+uint64_t SearchNonceAvx512(
+    const uint32_t* prefix, uint64_t nonce_start, uint64_t n_groups, const uint32_t* zero_mask) {
+  return MultiLaneBlake2s<Avx512Ops>::SearchNonce(prefix, nonce_start, n_groups, zero_mask);
+}
+
+}  // namespace details
+}  // namespace blake2s_many
+}  // namespace starkware
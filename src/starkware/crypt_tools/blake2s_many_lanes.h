@@ -0,0 +1,298 @@
+#ifndef STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_LANES_H_
+#define STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_LANES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "starkware/utils/attributes.h"
+
+/*
+  Multi-lane Blake2s (with a 160-bit digest), for the SIMD backends of Blake2s160::HashMany(), and
+(with a single lane) for Blake2s160::Hash().
+
+  The backends are compiled with the flags of their instruction sets, and include only this file.
+  Hence it deliberately avoids standard library templates and other headers with inline functions:
+  code that is generated with these flags must not be shared (through the linker) with code that
+  runs on CPUs without them.
+*/
+
+namespace starkware {
+namespace blake2s_many {
+namespace details {
+
+constexpr size_t kBlake2sBlockBytes = 64;
+constexpr size_t kBlake2sDigestBytes = 20;
+
+constexpr uint32_t kBlake2sIv[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+/*
+  The state before the first block: the IV, XORed with the parameter block (digest length, no key,
+  fanout = depth = 1).
+*/
+constexpr uint32_t kBlake2s160InitialState[8] = {
+    kBlake2sIv[0] ^ 0x01010000 ^ kBlake2sDigestBytes,
+    kBlake2sIv[1],
+    kBlake2sIv[2],
+    kBlake2sIv[3],
+    kBlake2sIv[4],
+    kBlake2sIv[5],
+    kBlake2sIv[6],
+    kBlake2sIv[7]};
+
+constexpr uint8_t kBlake2sSigma[10][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+};
+
+/*
+  Hashes Ops::kNLanes inputs of the same length at once: lane i of every vector holds the state of
+  input i. Ops defines the vector type Ops::Vec and the following operations on vectors of uint32_t:
+  Set1(), Load(), Store(), Add(), Xor() and Rotr<bits>(), and for SearchNonce() also And() and
+  ZeroLanes() (the mask of the lanes that are zero, lane i at bit i).
+*/
+template <typename Ops>
+class MultiLaneBlake2s {
+ public:
+  using Vec = typename Ops::Vec;
+  static constexpr size_t kNLanes = Ops::kNLanes;
+
+  /*
+    Hashes n_groups * kNLanes inputs of input_size bytes each, stored consecutively in data, and
+    writes their digests consecutively to output.
+  */
+  static void HashGroups(
+      const std::byte* data, size_t input_size, size_t n_groups, std::byte* output) {
+    for (size_t group = 0; group < n_groups; ++group) {
+      HashGroup(
+          data + group * kNLanes * input_size, input_size,
+          output + group * kNLanes * kBlake2sDigestBytes);
+    }
+  }
+
+  /*
+    The Blake2s compression function. counter is the number of bytes hashed so far, including this
+    block (the same for all the lanes, since the inputs have the same length).
+  */
+  static void Compress(const Vec* m, uint64_t counter, bool is_last_block, Vec* h) {
+    Vec v[16];
+    InitWorkVector(h, counter, is_last_block, v);
+
+    // The rounds are unrolled, so that the message indices are constants.
+    Round(kBlake2sSigma[0], m, v);
+    Round(kBlake2sSigma[1], m, v);
+    Round(kBlake2sSigma[2], m, v);
+    Round(kBlake2sSigma[3], m, v);
+    Round(kBlake2sSigma[4], m, v);
+    Round(kBlake2sSigma[5], m, v);
+    Round(kBlake2sSigma[6], m, v);
+    Round(kBlake2sSigma[7], m, v);
+    Round(kBlake2sSigma[8], m, v);
+    Round(kBlake2sSigma[9], m, v);
+
+    for (size_t i = 0; i < 8; ++i) {
+      h[i] = Ops::Xor(h[i], Ops::Xor(v[i], v[i + 8]));
+    }
+  }
+
+  /*
+    The proof of work search (see blake2s_many::SearchNonce()). Hashes prefix || nonce, where prefix
+    is 5 message words and nonce is 8 big-endian bytes, for the n_groups * kNLanes nonces from
+    nonce_start on. Returns the offset from nonce_start of the first nonce for which the first two
+    words of the digest have no bits in common with zero_mask, or n_groups * kNLanes if there is no
+    such nonce.
+    The input is a single block, of which only words 5 and 6 depend on the nonce. Hence the other
+    message words, and the first two G functions of the first round (which depend only on words
+    0-3), are computed once for all the nonces.
+  */
+  static uint64_t SearchNonce(
+      const uint32_t* prefix, uint64_t nonce_start, uint64_t n_groups, const uint32_t* zero_mask) {
+    constexpr size_t kInputBytes = 5 * sizeof(uint32_t) + sizeof(uint64_t);
+    Vec m[16];
+    for (size_t i = 0; i < 5; ++i) {
+      m[i] = Ops::Set1(prefix[i]);
+    }
+    for (size_t i = 7; i < 16; ++i) {
+      m[i] = Ops::Set1(0);
+    }
+    Vec h[8];
+    for (size_t i = 0; i < 8; ++i) {
+      h[i] = Ops::Set1(kBlake2s160InitialState[i]);
+    }
+    Vec midstate[16];
+    InitWorkVector(h, kInputBytes, /*is_last_block=*/true, midstate);
+    const uint8_t* const s = kBlake2sSigma[0];
+    G(midstate, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    G(midstate, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+
+    const Vec mask0 = Ops::Set1(zero_mask[0]);
+    const Vec mask1 = Ops::Set1(zero_mask[1]);
+    alignas(64) uint32_t nonce_words[2][kNLanes];
+    for (uint64_t group = 0; group < n_groups; ++group) {
+      for (size_t lane = 0; lane < kNLanes; ++lane) {
+        const uint64_t nonce = nonce_start + group * kNLanes + lane;
+        // The nonce is big-endian, and the message words are little-endian.
+        nonce_words[0][lane] = __builtin_bswap32(static_cast<uint32_t>(nonce >> 32));
+        nonce_words[1][lane] = __builtin_bswap32(static_cast<uint32_t>(nonce));
+      }
+      m[5] = Ops::Load(nonce_words[0]);
+      m[6] = Ops::Load(nonce_words[1]);
+
+      Vec v[16];
+      for (size_t i = 0; i < 16; ++i) {
+        v[i] = midstate[i];
+      }
+      // The rest of the first round.
+      G(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+      G(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+      G(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+      G(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+      G(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+      G(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+      Round(kBlake2sSigma[1], m, v);
+      Round(kBlake2sSigma[2], m, v);
+      Round(kBlake2sSigma[3], m, v);
+      Round(kBlake2sSigma[4], m, v);
+      Round(kBlake2sSigma[5], m, v);
+      Round(kBlake2sSigma[6], m, v);
+      Round(kBlake2sSigma[7], m, v);
+      Round(kBlake2sSigma[8], m, v);
+      Round(kBlake2sSigma[9], m, v);
+
+      // Only the first two words of the digest are checked.
+      const Vec word0 = Ops::Xor(h[0], Ops::Xor(v[0], v[8]));
+      const Vec word1 = Ops::Xor(h[1], Ops::Xor(v[1], v[9]));
+      const uint32_t found =
+          Ops::ZeroLanes(Ops::And(word0, mask0)) & Ops::ZeroLanes(Ops::And(word1, mask1));
+      if (found != 0) {
+        return group * kNLanes + __builtin_ctz(found);
+      }
+    }
+    return n_groups * kNLanes;
+  }
+
+ private:
+  /*
+    Initializes the work vector of the compression function from the state h.
+  */
+  static ALWAYS_INLINE void InitWorkVector(
+      const Vec* h, uint64_t counter, bool is_last_block, Vec* v) {
+    for (size_t i = 0; i < 8; ++i) {
+      v[i] = h[i];
+      v[i + 8] = Ops::Set1(kBlake2sIv[i]);
+    }
+    v[12] = Ops::Set1(kBlake2sIv[4] ^ static_cast<uint32_t>(counter));
+    v[13] = Ops::Set1(kBlake2sIv[5] ^ static_cast<uint32_t>(counter >> 32));
+    if (is_last_block) {
+      v[14] = Ops::Set1(~kBlake2sIv[6]);
+    }
+  }
+
+  static void HashGroup(const std::byte* data, size_t input_size, std::byte* output) {
+    Vec h[8];
+    for (size_t i = 0; i < 8; ++i) {
+      h[i] = Ops::Set1(kBlake2s160InitialState[i]);
+    }
+
+    // An empty input is hashed as a single (empty) final block.
+    const size_t n_blocks =
+        input_size == 0 ? 1 : (input_size + kBlake2sBlockBytes - 1) / kBlake2sBlockBytes;
+    alignas(64) uint32_t words[16][kNLanes];
+    for (size_t block = 0; block < n_blocks; ++block) {
+      const size_t offset = block * kBlake2sBlockBytes;
+      const size_t remaining = input_size - offset;
+      const size_t block_size = remaining < kBlake2sBlockBytes ? remaining : kBlake2sBlockBytes;
+      // Transpose the block of every lane into the message words.
+      for (size_t lane = 0; lane < kNLanes; ++lane) {
+        LoadBlock(data + lane * input_size + offset, block_size, lane, words);
+      }
+      Vec m[16];
+      for (size_t i = 0; i < 16; ++i) {
+        m[i] = Ops::Load(words[i]);
+      }
+      Compress(m, offset + block_size, block + 1 == n_blocks, h);
+    }
+
+    alignas(64) uint32_t digest[kBlake2sDigestBytes / sizeof(uint32_t)][kNLanes];
+    for (size_t i = 0; i < kBlake2sDigestBytes / sizeof(uint32_t); ++i) {
+      Ops::Store(digest[i], h[i]);
+    }
+    for (size_t lane = 0; lane < kNLanes; ++lane) {
+      for (size_t i = 0; i < kBlake2sDigestBytes / sizeof(uint32_t); ++i) {
+        // The backends run on x86, which is little-endian, as Blake2s.
+        memcpy(output + lane * kBlake2sDigestBytes + i * sizeof(uint32_t), &digest[i][lane], 4);
+      }
+    }
+  }
+
+  /*
+    Loads a block of block_size bytes (padded with zeros) into the given lane of the message words.
+  */
+  static void LoadBlock(
+      const std::byte* block, size_t block_size, size_t lane, uint32_t (*words)[kNLanes]) {
+    std::byte padded[kBlake2sBlockBytes] = {};
+    if (block_size < kBlake2sBlockBytes) {
+      if (block_size > 0) {
+        memcpy(padded, block, block_size);
+      }
+      block = padded;
+    }
+    for (size_t i = 0; i < 16; ++i) {
+      memcpy(&words[i][lane], block + i * sizeof(uint32_t), sizeof(uint32_t));
+    }
+  }
+
+  static ALWAYS_INLINE void G(
+      Vec* v, size_t a, size_t b, size_t c, size_t d, const Vec& x, const Vec& y) {
+    v[a] = Ops::Add(Ops::Add(v[a], v[b]), x);
+    v[d] = Ops::template Rotr<16>(Ops::Xor(v[d], v[a]));
+    v[c] = Ops::Add(v[c], v[d]);
+    v[b] = Ops::template Rotr<12>(Ops::Xor(v[b], v[c]));
+    v[a] = Ops::Add(Ops::Add(v[a], v[b]), y);
+    v[d] = Ops::template Rotr<8>(Ops::Xor(v[d], v[a]));
+    v[c] = Ops::Add(v[c], v[d]);
+    v[b] = Ops::template Rotr<7>(Ops::Xor(v[b], v[c]));
+  }
+
+  static ALWAYS_INLINE void Round(const uint8_t* s, const Vec* m, Vec* v) {
+    G(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    G(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    G(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    G(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    G(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    G(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    G(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    G(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+};
+
+/*
+  Hash n_groups * 8 (AVX2) or n_groups * 16 (AVX-512) inputs, see MultiLaneBlake2s::HashGroups().
+  Each is defined in its own translation unit, and may only be called if the CPU supports it.
+*/
+void HashGroupsAvx2(const std::byte* data, size_t input_size, size_t n_groups, std::byte* output);
+void HashGroupsAvx512(
+    const std::byte* data, size_t input_size, size_t n_groups, std::byte* output);
+
+/*
+  Search n_groups * 8 (AVX2) or n_groups * 16 (AVX-512) nonces, see MultiLaneBlake2s::SearchNonce().
+*/
+uint64_t SearchNonceAvx2(
+    const uint32_t* prefix, uint64_t nonce_start, uint64_t n_groups, const uint32_t* zero_mask);
+uint64_t SearchNonceAvx512(
+    const uint32_t* prefix, uint64_t nonce_start, uint64_t n_groups, const uint32_t* zero_mask);
+
+}  // namespace details
+}  // namespace blake2s_many
+}  // namespace starkware
+
+#endif  // STARKWARE_CRYPT_TOOLS_BLAKE2S_MANY_LANES_H_
@@ -0,0 +1,189 @@
+#include "starkware/crypt_tools/keccak_256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "starkware/error_handling/error_handling.h"
+#include "starkware/utils/to_from_string.h"
+
+namespace starkware {
+
+namespace {
+
+constexpr size_t kStateNumWords = 25;
+constexpr size_t kNumRounds = 24;
+// The rate of Keccak-256, in bytes: the state is 1600 bits, and the capacity is twice the digest.
+constexpr size_t kRateNumBytes = 200 - 2 * Keccak256::kDigestNumBytes;
+
+constexpr uint64_t kRoundConstants[kNumRounds] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008};
+
+static_assert(
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+    "Keccak lanes are little-endian, and are loaded from the input with memcpy.");
+
+using State = uint64_t[kStateNumWords];  // NOLINT: The permutation works on a plain array.
+
+constexpr uint64_t Rotl(uint64_t value, size_t bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/*
+  The Keccak-f[1600] permutation, on the lanes a[x + 5y]. The steps of each round are unrolled
+  with constant lane indices (the rotation offsets of rho and the lane order of pi included), so
+  that the compiler keeps the state in registers.
+*/
+void Permute(State a) {
+  State b;  // NOLINT
+  for (const uint64_t round_constant : kRoundConstants) {
+    // Theta.
+    const uint64_t c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+    const uint64_t c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+    const uint64_t c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+    const uint64_t c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+    const uint64_t c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+    const uint64_t d0 = c4 ^ Rotl(c1, 1);
+    const uint64_t d1 = c0 ^ Rotl(c2, 1);
+    const uint64_t d2 = c1 ^ Rotl(c3, 1);
+    const uint64_t d3 = c2 ^ Rotl(c4, 1);
+    const uint64_t d4 = c3 ^ Rotl(c0, 1);
+
+    // Rho and pi, together with the rest of theta. Lane (x, y) moves to (y, 2x + 3y).
+    b[0] = a[0] ^ d0;
+    b[1] = Rotl(a[6] ^ d1, 44);
+    b[2] = Rotl(a[12] ^ d2, 43);
+    b[3] = Rotl(a[18] ^ d3, 21);
+    b[4] = Rotl(a[24] ^ d4, 14);
+    b[5] = Rotl(a[3] ^ d3, 28);
+    b[6] = Rotl(a[9] ^ d4, 20);
+    b[7] = Rotl(a[10] ^ d0, 3);
+    b[8] = Rotl(a[16] ^ d1, 45);
+    b[9] = Rotl(a[22] ^ d2, 61);
+    b[10] = Rotl(a[1] ^ d1, 1);
+    b[11] = Rotl(a[7] ^ d2, 6);
+    b[12] = Rotl(a[13] ^ d3, 25);
+    b[13] = Rotl(a[19] ^ d4, 8);
+    b[14] = Rotl(a[20] ^ d0, 18);
+    b[15] = Rotl(a[4] ^ d4, 27);
+    b[16] = Rotl(a[5] ^ d0, 36);
+    b[17] = Rotl(a[11] ^ d1, 10);
+    b[18] = Rotl(a[17] ^ d2, 15);
+    b[19] = Rotl(a[23] ^ d3, 56);
+    b[20] = Rotl(a[2] ^ d2, 62);
+    b[21] = Rotl(a[8] ^ d3, 55);
+    b[22] = Rotl(a[14] ^ d4, 39);
+    b[23] = Rotl(a[15] ^ d0, 41);
+    b[24] = Rotl(a[21] ^ d1, 2);
+
+    // Chi.
+    a[0] = b[0] ^ (~b[1] & b[2]);
+    a[1] = b[1] ^ (~b[2] & b[3]);
+    a[2] = b[2] ^ (~b[3] & b[4]);
+    a[3] = b[3] ^ (~b[4] & b[0]);
+    a[4] = b[4] ^ (~b[0] & b[1]);
+    a[5] = b[5] ^ (~b[6] & b[7]);
+    a[6] = b[6] ^ (~b[7] & b[8]);
+    a[7] = b[7] ^ (~b[8] & b[9]);
+    a[8] = b[8] ^ (~b[9] & b[5]);
+    a[9] = b[9] ^ (~b[5] & b[6]);
+    a[10] = b[10] ^ (~b[11] & b[12]);
+    a[11] = b[11] ^ (~b[12] & b[13]);
+    a[12] = b[12] ^ (~b[13] & b[14]);
+    a[13] = b[13] ^ (~b[14] & b[10]);
+    a[14] = b[14] ^ (~b[10] & b[11]);
+    a[15] = b[15] ^ (~b[16] & b[17]);
+    a[16] = b[16] ^ (~b[17] & b[18]);
+    a[17] = b[17] ^ (~b[18] & b[19]);
+    a[18] = b[18] ^ (~b[19] & b[15]);
+    a[19] = b[19] ^ (~b[15] & b[16]);
+    a[20] = b[20] ^ (~b[21] & b[22]);
+    a[21] = b[21] ^ (~b[22] & b[23]);
+    a[22] = b[22] ^ (~b[23] & b[24]);
+    a[23] = b[23] ^ (~b[24] & b[20]);
+    a[24] = b[24] ^ (~b[20] & b[21]);
+
+    // Iota.
+    a[0] ^= round_constant;
+  }
+}
+
+/*
+  XORs bytes into the beginning of the state. Keccak reads the lanes as little-endian.
+*/
+void Absorb(gsl::span<const std::byte> bytes, State state) {
+  const size_t n_full_lanes = bytes.size() / sizeof(uint64_t);
+  for (size_t i = 0; i < n_full_lanes; ++i) {
+    uint64_t lane;
+    memcpy(&lane, bytes.data() + i * sizeof(uint64_t), sizeof(uint64_t));
+    state[i] ^= lane;
+  }
+  for (size_t i = n_full_lanes * sizeof(uint64_t); i < bytes.size(); ++i) {
+    state[i / 8] ^= static_cast<uint64_t>(bytes[i]) << (8 * (i % 8));
+  }
+}
+
+void HashBytes(gsl::span<const std::byte> bytes, std::byte* output) {
+  State state = {};  // NOLINT
+  for (; bytes.size() >= kRateNumBytes; bytes = bytes.subspan(kRateNumBytes)) {
+    Absorb(bytes.subspan(0, kRateNumBytes), state);
+    Permute(state);
+  }
+
+  // The last block is padded with 10*1 (this is where SHA3 differs, using 0110*1).
+  std::array<std::byte, kRateNumBytes> last_block{};
+  std::copy(bytes.begin(), bytes.end(), last_block.begin());
+  last_block[bytes.size()] ^= std::byte{0x01};
+  last_block.back() ^= std::byte{0x80};
+  Absorb(last_block, state);
+  Permute(state);
+
+  static_assert(
+      Keccak256::kDigestNumBytes <= sizeof(State), "The digest must be a prefix of the state.");
+  memcpy(output, state, Keccak256::kDigestNumBytes);
+}
+
+}  // namespace
+
+const Keccak256 Keccak256::InitDigestTo(gsl::span<const std::byte> digest) {
+  ASSERT_RELEASE(digest.size() == kDigestNumBytes, "Invalid digest initialization length.");
+  Keccak256 result;
+  std::copy(digest.begin(), digest.end(), result.buffer_.begin());
+  return result;
+}
+
+const Keccak256 Keccak256::Hash(const Keccak256& val1, const Keccak256& val2) {
+  std::array<std::byte, 2 * kDigestNumBytes> bytes;  // NOLINT
+  std::copy(val1.buffer_.begin(), val1.buffer_.end(), bytes.begin());
+  std::copy(val2.buffer_.begin(), val2.buffer_.end(), bytes.begin() + kDigestNumBytes);
+  return HashBytesWithLength(bytes);
+}
+
+const Keccak256 Keccak256::HashBytesWithLength(gsl::span<const std::byte> bytes) {
+  Keccak256 result;
+  HashBytes(bytes, result.buffer_.data());
+  return result;
+}
+
+void Keccak256::HashMany(
+    gsl::span<const std::byte> data, size_t input_size, gsl::span<Keccak256> output) {
+  ASSERT_RELEASE(
+      data.size() == input_size * output.size(), "Data size does not match the number of inputs.");
+  for (size_t i = 0; i < output.size(); ++i) {
+    HashBytes(data.subspan(i * input_size, input_size), output[i].buffer_.data());
+  }
+}
+
+std::string Keccak256::ToString() const {
+  return BytesToHexString(buffer_, /*trim_leading_zeros=*/false);
+}
+
+std::ostream& operator<<(std::ostream& out, const Keccak256& hash) {
+  return out << hash.ToString();
+}
+
+}  // namespace starkware
@@ -0,0 +1,56 @@
+#ifndef STARKWARE_CRYPT_TOOLS_KECCAK_256_H_
+#define STARKWARE_CRYPT_TOOLS_KECCAK_256_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "third_party/gsl/gsl-lite.hpp"
+
+namespace starkware {
+
+/*
+  Keccak-256, as used by Ethereum (i.e. with the original Keccak padding, rather than the one of
+  SHA3-256). Has the same interface as Blake2s160, so it may be used as the hash of the commitment
+  scheme instead of it.
+*/
+class Keccak256 {
+ public:
+  static constexpr size_t kDigestNumBytes = 256 / 8;
+
+  /*
+    Supports the creation of uninitialized Keccak256 vectors.
+  */
+  Keccak256() {}  // NOLINT
+
+  /*
+    Gets a Keccak256 instance with the specified digest.
+  */
+  static const Keccak256 InitDigestTo(gsl::span<const std::byte> digest);
+
+  static const Keccak256 Hash(const Keccak256& val1, const Keccak256& val2);
+
+  static const Keccak256 HashBytesWithLength(gsl::span<const std::byte> bytes);
+
+  /*
+    Hashes output.size() independent inputs of input_size bytes each, stored consecutively in data,
+    and writes the hash of the i-th input to output[i].
+  */
+  static void HashMany(
+      gsl::span<const std::byte> data, size_t input_size, gsl::span<Keccak256> output);
+
+  bool operator==(const Keccak256& other) const { return buffer_ == other.buffer_; }
+  bool operator!=(const Keccak256& other) const { return !(*this == other); }
+  const std::array<std::byte, kDigestNumBytes>& GetDigest() const { return buffer_; }
+  std::string ToString() const;
+  friend std::ostream& operator<<(std::ostream& out, const Keccak256& hash);
+
+ private:
+  std::array<std::byte, kDigestNumBytes> buffer_;
+};
+
+}  // namespace starkware
+
+#endif  // STARKWARE_CRYPT_TOOLS_KECCAK_256_H_
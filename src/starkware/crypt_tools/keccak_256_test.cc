@@ -0,0 +1,86 @@
+#include "starkware/crypt_tools/keccak_256.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "starkware/error_handling/test_utils.h"
+#include "starkware/randomness/prng.h"
+#include "starkware/stl_utils/containers.h"
+
+namespace starkware {
+namespace {
+
+using testing::HasSubstr;
+
+// The expected values are the Keccak-256 digests of the inputs (as Ethereum's keccak256 computes).
+TEST(Keccak256, EmptyInput) {
+  EXPECT_EQ(
+      "0xc5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470",
+      Keccak256::HashBytesWithLength({}).ToString());
+}
+
+TEST(Keccak256, ShortInput) {
+  const std::array<std::byte, 3> abc = MakeByteArray<'a', 'b', 'c'>();
+  const Keccak256 hash = Keccak256::HashBytesWithLength(abc);
+  std::stringstream ss;
+  ss << hash;
+  EXPECT_EQ("0x4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45", ss.str());
+}
+
+TEST(Keccak256, MultiBlockInput) {
+  // More than a single block (of 136 bytes).
+  std::vector<std::byte> bytes(200);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<std::byte>(i * 7 + 1);
+  }
+  EXPECT_EQ(
+      "0x821d65a5a6cb642f6103930f83c3b73f893a998eacaf603e7ae93cbd636182cb",
+      Keccak256::HashBytesWithLength(bytes).ToString());
+}
+
+TEST(Keccak256, HashTwoHashes) {
+  Prng prng;
+  const std::vector<std::byte> bytes = prng.RandomByteVector(2 * Keccak256::kDigestNumBytes);
+  const auto h1 = Keccak256::InitDigestTo(gsl::make_span(bytes).subspan(0, 32));
+  const auto h2 = Keccak256::InitDigestTo(gsl::make_span(bytes).subspan(32, 32));
+  EXPECT_EQ(Keccak256::HashBytesWithLength(bytes), Keccak256::Hash(h1, h2));
+  EXPECT_NE(Keccak256::Hash(h1, h2), Keccak256::Hash(h2, h1));
+}
+
+TEST(Keccak256, HashMany) {
+  Prng prng;
+  for (size_t input_size : {0, 17, 64, 136, 300}) {
+    const size_t n_inputs = prng.UniformInt<size_t>(0, 20);
+    const std::vector<std::byte> data = prng.RandomByteVector(input_size * n_inputs);
+    std::vector<Keccak256> output(n_inputs);
+    Keccak256::HashMany(data, input_size, output);
+    for (size_t i = 0; i < n_inputs; ++i) {
+      EXPECT_EQ(
+          Keccak256::HashBytesWithLength(gsl::make_span(data).subspan(i * input_size, input_size)),
+          output[i]);
+    }
+  }
+
+  std::vector<Keccak256> output(2);
+  EXPECT_ASSERT(
+      Keccak256::HashMany(std::vector<std::byte>(10), 4, output),
+      HasSubstr("Data size does not match the number of inputs."));
+}
+
+TEST(Keccak256, InitDigestTo) {
+  Prng prng;
+  const std::vector<std::byte> digest = prng.RandomByteVector(Keccak256::kDigestNumBytes);
+  const Keccak256 hash = Keccak256::InitDigestTo(digest);
+  EXPECT_TRUE(std::equal(digest.begin(), digest.end(), hash.GetDigest().begin()));
+  EXPECT_ASSERT(
+      Keccak256::InitDigestTo(prng.RandomByteVector(20)),
+      HasSubstr("Invalid digest initialization length."));
+}
+
+}  // namespace
+}  // namespace starkware
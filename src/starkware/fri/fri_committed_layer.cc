@@ -1,8 +1,10 @@
 #include "starkware/fri/fri_committed_layer.h"
 
+#include <algorithm>
 #include <set>
 
 #include "starkware/fri/fri_details.h"
+#include "starkware/utils/task_graph.h"
 
 namespace starkware {
 
@@ -19,14 +21,23 @@ FriCommittedLayerByTableProver::FriCommittedLayerByTableProver(
     size_t fri_step, MaybeOwnedPtr<const FriLayer> layer,
     const TableProverFactory<ExtensionFieldElement>& table_prover_factory,
     const FriParameters& params, size_t layer_num)
-    : FriCommittedLayer(fri_step),
-      fri_layer_(std::move(layer)),
-      params_(params),
-      layer_num_(layer_num) {
-  uint64_t layer_size = fri_layer_->LayerSize();
-  table_prover_ = table_prover_factory(1, layer_size / Pow2(fri_step_), Pow2(fri_step_));
+    : FriCommittedLayer(fri_step), params_(params), layer_num_(layer_num) {
+  const uint64_t layer_size = layer->LayerSize();
+  const uint64_t n_rows = layer_size / Pow2(fri_step_);
+  n_segments_ = NumSegments(n_rows);
+  table_prover_ = table_prover_factory(n_segments_, n_rows / n_segments_, Pow2(fri_step_));
   ASSERT_RELEASE(table_prover_, "No table prover for current layer (probably last layer).");
-  Commit();
+  fri_layer_ = UseMovedValue(FriLayerReal(Commit(*layer), layer->GetDomain()));
+}
+
+size_t FriCommittedLayerByTableProver::NumSegments(uint64_t n_rows) {
+  // Segments smaller than this are not worth the overhead of separate tasks.
+  constexpr uint64_t kMinRowsPerSegment = 1024;
+  const uint64_t max_n_segments = std::max<uint64_t>(n_rows / kMinRowsPerSegment, 1);
+  const uint64_t n_segments = std::min<uint64_t>(
+      max_n_segments, kSegmentsPerThread * TaskManager::GetInstance().GetNumThreads());
+  // n_rows is a power of two, so a power of two that is not larger than n_rows divides it.
+  return Pow2(Log2Floor(n_segments));
 }
 
 FriCommittedLayerByTableProver::ElementsData FriCommittedLayerByTableProver::EvalAtPoints(
@@ -53,9 +64,29 @@ FriCommittedLayerByTableProver::ElementsData FriCommittedLayerByTableProver::Eva
   };
 }
 
-void FriCommittedLayerByTableProver::Commit() {
-  table_prover_->AddSegmentForCommitment({fri_layer_->GetLayer()}, 0, Pow2(fri_step_));
-  table_prover_->Commit();
+std::vector<ExtensionFieldElement> FriCommittedLayerByTableProver::Commit(const FriLayer& layer) {
+  auto evaluation = ExtensionFieldElement::UninitializedVector(layer.LayerSize());
+  const uint64_t segment_size = layer.LayerSize() / n_segments_;
+
+  // For each segment, compute the evaluation and then add it to the commitment scheme.
+  TaskGraph graph;
+  std::vector<TaskGraph::Task> commit_tasks;
+  commit_tasks.reserve(n_segments_);
+  for (size_t segment_index = 0; segment_index < n_segments_; ++segment_index) {
+    const gsl::span<ExtensionFieldElement> segment =
+        gsl::make_span(evaluation).subspan(segment_index * segment_size, segment_size);
+    const TaskGraph::Task fold_task = graph.Add([&layer, segment, segment_index, segment_size]() {
+      layer.GetLayerSegment(segment_index * segment_size, segment);
+    });
+    commit_tasks.push_back(graph.Add(
+        [this, segment, segment_index]() {
+          table_prover_->AddSegmentForCommitment({segment}, segment_index, Pow2(fri_step_));
+        },
+        {fold_task}));
+  }
+  graph.Add([this]() { table_prover_->Commit(); }, commit_tasks);
+  graph.Run();
+  return evaluation;
 }
 
 void FriCommittedLayerByTableProver::Decommit(const std::vector<uint64_t>& queries) {
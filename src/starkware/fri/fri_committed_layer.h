@@ -44,6 +44,10 @@ class FriCommittedLayerByCallback : public FriCommittedLayer {
 
 /*
   Commits on a FriLayer using a TableProver.
+
+  The evaluation of the layer is computed (e.g., folded, if layer is a proxy layer) and committed
+  segment by segment, in a task graph, so that the folding of one segment overlaps with the hashing
+  of another. The evaluation is kept as a FriLayerReal, see GetFriLayer().
 */
 class FriCommittedLayerByTableProver : public FriCommittedLayer {
  public:
@@ -54,8 +58,16 @@ class FriCommittedLayerByTableProver : public FriCommittedLayer {
 
   void Decommit(const std::vector<uint64_t>& queries) override;
 
+  /*
+    Returns the committed layer.
+  */
+  const FriLayer& GetFriLayer() const { return *fri_layer_; }
+
  private:
-  void Commit();
+  /*
+    Computes the evaluation of layer and commits to it. Returns the evaluation.
+  */
+  std::vector<ExtensionFieldElement> Commit(const FriLayer& layer);
   struct ElementsData {
     std::vector<gsl::span<const ExtensionFieldElement>> elements;
     std::vector<std::vector<ExtensionFieldElement>> raw_data;
@@ -63,6 +75,15 @@ class FriCommittedLayerByTableProver : public FriCommittedLayer {
 
   ElementsData EvalAtPoints(gsl::span<const uint64_t> required_row_indices);
 
+  /*
+    Returns the number of segments for a layer with n_rows rows in the table.
+  */
+  static size_t NumSegments(uint64_t n_rows);
+
+  // The number of segments per thread, so that the work is balanced between the threads.
+  static constexpr size_t kSegmentsPerThread = 4;
+
+  size_t n_segments_;
   MaybeOwnedPtr<const FriLayer> fri_layer_;
   const FriParameters& params_;
   const size_t layer_num_;
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 
+#include "starkware/algebra/field_operations.h"
+#include "starkware/utils/bit_reversal.h"
 #include "starkware/utils/task_manager.h"
 
 namespace starkware {
@@ -46,23 +48,46 @@ void FriFolder::ComputeNextFriLayer(
     const Coset& domain, gsl::span<const ExtensionFieldElement> values,
     const ExtensionFieldElement& eval_point, gsl::span<ExtensionFieldElement> output_layer) {
   ASSERT_RELEASE(values.size() == domain.Size(), "values size does not match domain size.");
+  ComputeNextFriLayerSegment(domain, values, 0, eval_point, output_layer);
+}
+
+void FriFolder::ComputeNextFriLayerSegment(
+    const Coset& domain, gsl::span<const ExtensionFieldElement> values_segment,
+    uint64_t first_index, const ExtensionFieldElement& eval_point,
+    gsl::span<ExtensionFieldElement> output_segment) {
+  const size_t segment_size = output_segment.size();
   ASSERT_RELEASE(
-      output_layer.size() == SafeDiv(values.size(), 2),
+      segment_size == SafeDiv(values_segment.size(), 2),
       "Output layer size must be half than the original.");
+  ASSERT_RELEASE(IsPowerOfTwo(segment_size), "Segment size must be a power of two.");
+  ASSERT_RELEASE(first_index % segment_size == 0, "Segment must be aligned to its size.");
+  ASSERT_RELEASE(
+      2 * (first_index + segment_size) <= domain.Size(), "Segment exceeds the domain size.");
 
   // Denote by c the coset offset and by g the generator.
-  // domain_vec consists of the inverses of {c, c*g, c*g^2, ..., c*g^(output_layer.size() - 1)},
-  // ordered by bit-reverse of the exponent of g^-1.
-  // This is half of the inverses of the domain elements, where for each pair x, -x only one of the
-  // two appears.
+  // The domain of the whole next layer consists of the inverses of
+  // {c, c*g, c*g^2, ..., c*g^(domain.Size() / 2 - 1)}, ordered by bit-reverse of the exponent of
+  // g^-1. This is half of the inverses of the domain elements, where for each pair x, -x only one
+  // of the two appears.
+  // Since the segment is aligned, the exponents of its elements are
+  // BitReverse(t) * stride + BitReverse(segment_index) for t in [0, segment_size), so its domain is
+  // a (bit-reversed) coset as well.
+  const size_t log_half_domain = SafeLog2(domain.Size() / 2);
+  const size_t log_segment_size = SafeLog2(segment_size);
+  const uint64_t segment_index = first_index / segment_size;
+  const BaseFieldElement generator_inv = domain.Generator().Inverse();
+  const BaseFieldElement segment_generator =
+      Pow(generator_inv, Pow2(log_half_domain - log_segment_size));
+  const BaseFieldElement segment_offset =
+      domain.Offset().Inverse() *
+      Pow(generator_inv, BitReverse(segment_index, log_half_domain - log_segment_size));
   std::vector<BaseFieldElement> domain_vec = BitReverseVector<BaseFieldElement>(
-      Coset(domain.Size(), domain.Generator().Inverse(), domain.Offset().Inverse())
-          .GetFirstElements(output_layer.size()));
+      Coset(2 * segment_size, segment_generator, segment_offset).GetFirstElements(segment_size));
 
-  for (size_t i = 0; i < output_layer.size(); ++i) {
-    const ExtensionFieldElement& f_x = values[2 * i];
-    const ExtensionFieldElement& f_minus_x = values[2 * i + 1];
-    output_layer[i] = Fold(f_x, f_minus_x, eval_point, domain_vec[i]);
+  for (size_t i = 0; i < segment_size; ++i) {
+    const ExtensionFieldElement& f_x = values_segment[2 * i];
+    const ExtensionFieldElement& f_minus_x = values_segment[2 * i + 1];
+    output_segment[i] = Fold(f_x, f_minus_x, eval_point, domain_vec[i]);
   }
 }
 
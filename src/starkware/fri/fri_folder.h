@@ -30,6 +30,17 @@ class FriFolder {
       const Coset& domain, gsl::span<const ExtensionFieldElement> values,
       const ExtensionFieldElement& eval_point, gsl::span<ExtensionFieldElement> output_layer);
 
+  /*
+    Same as ComputeNextFriLayer(), but computes only the output_layer.size() elements of the next
+    layer starting at first_index, given the corresponding 2 * output_layer.size() values of the
+    current layer (starting at 2 * first_index). output_layer.size() must be a power of two, and
+    first_index must be a multiple of it.
+  */
+  static void ComputeNextFriLayerSegment(
+      const Coset& domain, gsl::span<const ExtensionFieldElement> values_segment,
+      uint64_t first_index, const ExtensionFieldElement& eval_point,
+      gsl::span<ExtensionFieldElement> output_segment);
+
   /*
     Computes the value of a single element in the next FRI layer given two corresponding
     elements in the current layer.
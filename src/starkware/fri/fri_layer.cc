@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "starkware/algebra/lde/lde_manager.h"
+#include "starkware/utils/buffer_pool.h"
 
 namespace starkware {
 
@@ -15,11 +16,23 @@ using starkware::fri::details::FriFolder;
 */
 std::vector<ExtensionFieldElement> FriLayer::GetLayer() const {
   auto layer = ExtensionFieldElement::UninitializedVector(LayerSize());
-  const auto layer_span = gsl::make_span(layer);
-  GetLayerImpl(layer_span);
+  GetLayer(gsl::make_span(layer));
   return layer;
 }
 
+void FriLayer::GetLayer(gsl::span<ExtensionFieldElement> output) const {
+  ASSERT_RELEASE(output.size() == LayerSize(), "Wrong output size.");
+  GetLayerImpl(output);
+}
+
+void FriLayer::GetLayerSegment(
+    uint64_t first_index, gsl::span<ExtensionFieldElement> output) const {
+  ASSERT_RELEASE(IsPowerOfTwo(output.size()), "Segment size must be a power of two.");
+  ASSERT_RELEASE(first_index % output.size() == 0, "Segment must be aligned to its size.");
+  ASSERT_RELEASE(first_index + output.size() <= LayerSize(), "Segment exceeds the layer size.");
+  GetLayerSegmentImpl(first_index, output);
+}
+
 //  Class FriLayerReal.
 
 void FriLayerReal::GetLayerImpl(gsl::span<ExtensionFieldElement> output) const {
@@ -28,6 +41,13 @@ void FriLayerReal::GetLayerImpl(gsl::span<ExtensionFieldElement> output) const {
   std::copy(evaluation_.begin(), evaluation_.end(), output.begin());
 }
 
+void FriLayerReal::GetLayerSegmentImpl(
+    uint64_t first_index, gsl::span<ExtensionFieldElement> output) const {
+  std::copy(
+      evaluation_.begin() + first_index, evaluation_.begin() + first_index + output.size(),
+      output.begin());
+}
+
 std::vector<ExtensionFieldElement> FriLayerReal::EvalAtPoints(
     gsl::span<const uint64_t> required_indices) const {
   std::vector<ExtensionFieldElement> res;
@@ -48,8 +68,19 @@ FriLayerProxy::FriLayerProxy(
 
 void FriLayerProxy::GetLayerImpl(gsl::span<ExtensionFieldElement> output) const {
   const auto prev_layer_domain = prev_layer_->GetDomain();
-  auto prev_eval = prev_layer_->GetLayer();
-  FriFolder::ComputeNextFriLayer(prev_layer_domain, prev_eval, eval_point_, output);
+  // The previous layer is only needed temporarily, so its evaluation is drawn from the buffer pool.
+  PooledBuffer<ExtensionFieldElement> prev_eval(prev_layer_->LayerSize());
+  prev_layer_->GetLayer(prev_eval.Span());
+  FriFolder::ComputeNextFriLayer(prev_layer_domain, prev_eval.Span(), eval_point_, output);
+}
+
+void FriLayerProxy::GetLayerSegmentImpl(
+    uint64_t first_index, gsl::span<ExtensionFieldElement> output) const {
+  // The corresponding segment of the previous layer is twice as large.
+  PooledBuffer<ExtensionFieldElement> prev_eval(2 * output.size());
+  prev_layer_->GetLayerSegment(2 * first_index, prev_eval.Span());
+  FriFolder::ComputeNextFriLayerSegment(
+      prev_layer_->GetDomain(), prev_eval.Span(), first_index, eval_point_, output);
 }
 
 std::vector<ExtensionFieldElement> FriLayerProxy::EvalAtPoints(
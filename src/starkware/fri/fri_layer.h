@@ -40,8 +40,20 @@ class FriLayer {
   // Get the evaluation of current layer as a vector.
   virtual std::vector<ExtensionFieldElement> GetLayer() const;
 
+  // Writes the evaluation of current layer to output, which must be of size LayerSize().
+  void GetLayer(gsl::span<ExtensionFieldElement> output) const;
+
+  /*
+    Writes the output.size() elements of the evaluation of current layer starting at first_index to
+    output. output.size() must be a power of two, and first_index must be a multiple of it.
+    Segments of a layer may be computed concurrently.
+  */
+  void GetLayerSegment(uint64_t first_index, gsl::span<ExtensionFieldElement> output) const;
+
  protected:
   virtual void GetLayerImpl(gsl::span<ExtensionFieldElement> output) const = 0;
+  virtual void GetLayerSegmentImpl(
+      uint64_t first_index, gsl::span<ExtensionFieldElement> output) const = 0;
 
  private:
   Coset domain_;
@@ -66,6 +78,8 @@ class FriLayerReal : public FriLayer {
 
  protected:
   void GetLayerImpl(gsl::span<ExtensionFieldElement> output) const override;
+  void GetLayerSegmentImpl(
+      uint64_t first_index, gsl::span<ExtensionFieldElement> output) const override;
 
  private:
   std::vector<ExtensionFieldElement> evaluation_;
@@ -84,6 +98,8 @@ class FriLayerProxy : public FriLayer {
 
  protected:
   void GetLayerImpl(gsl::span<ExtensionFieldElement> output) const override;
+  void GetLayerSegmentImpl(
+      uint64_t first_index, gsl::span<ExtensionFieldElement> output) const override;
 
  private:
   Coset FoldDomain(const Coset& domain) { return GetCosetForFriLayer(domain, 1); }
@@ -1,7 +1,10 @@
 #include "starkware/fri/fri_layer.h"
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+
 #include "starkware/algebra/lde/lde_manager.h"
+#include "starkware/error_handling/test_utils.h"
 #include "starkware/fri/fri_folder.h"
 #include "starkware/fri/fri_parameters.h"
 #include "starkware/fri/fri_test_utils.h"
@@ -12,6 +15,7 @@ namespace layer {
 namespace {
 
 using starkware::fri::details::FriFolder;
+using testing::HasSubstr;
 
 /*
   Contains data and functions to avoid boiler plate and duplicate code.
@@ -152,6 +156,35 @@ TEST_F(FriLayerTest, RealLayer) {
   }
 }
 
+TEST_F(FriLayerTest, LayerSegment) {
+  this->Init();
+  this->InitMoreLayers();
+  // A proxy of a proxy, as created for a FRI step of 2.
+  FriLayerProxy layer_2_proxy(UseOwned(this->layer_1_proxy_), *this->eval_point_);
+
+  for (const FriLayer* layer :
+       {this->layer_0_.get(), this->layer_1_proxy_.get(), this->layer_3_proxy_.get(),
+        static_cast<FriLayer*>(&layer_2_proxy)}) {
+    const std::vector<ExtensionFieldElement> layer_eval = layer->GetLayer();
+    for (const uint64_t segment_size : {UINT64_C(1), UINT64_C(8), layer->LayerSize()}) {
+      auto segments = ExtensionFieldElement::UninitializedVector(layer->LayerSize());
+      for (uint64_t first_index = 0; first_index < layer->LayerSize();
+           first_index += segment_size) {
+        layer->GetLayerSegment(
+            first_index, gsl::make_span(segments).subspan(first_index, segment_size));
+      }
+      EXPECT_EQ(layer_eval, segments);
+    }
+  }
+
+  auto output = ExtensionFieldElement::UninitializedVector(8);
+  EXPECT_ASSERT(
+      this->layer_1_proxy_->GetLayerSegment(4, output), HasSubstr("aligned to its size"));
+  EXPECT_ASSERT(
+      this->layer_1_proxy_->GetLayerSegment(this->layer_1_proxy_->LayerSize(), output),
+      HasSubstr("exceeds the layer size"));
+}
+
 TEST_F(FriLayerTest, EvaluationTest) {
   this->Init();
   this->InitMoreLayers();
@@ -49,18 +49,19 @@ MaybeOwnedPtr<const FriLayer> FriProver::CommitmentPhase() {
     AnnotationScope scope(channel_.get(), "Layer " + std::to_string(layer_num));
 
     current_layer = CreateNextFriLayer(std::move(current_layer), fri_step, &basis_index);
-    current_layer = UseMovedValue(FriLayerReal(std::move(current_layer)));
-    MaybeOwnedPtr<const FriLayer> new_layer = UseOwned(current_layer);
 
     // For the last layer, skip creating a committed layer.
     if (layer_num == n_layers_) {
+      current_layer = UseMovedValue(FriLayerReal(std::move(current_layer)));
       break;
     }
 
-    // Create a commited layer.
-    committed_layers_.emplace_back(UseMovedValue(FriCommittedLayerByTableProver(
-        next_fri_step, std::move(current_layer), *table_prover_factory_, *params_, layer_num)));
-    current_layer = UseOwned(new_layer);
+    // Create a commited layer. The committed layer computes the folded layer and commits to it
+    // concurrently, and keeps the result.
+    auto committed_layer = std::make_unique<FriCommittedLayerByTableProver>(
+        next_fri_step, std::move(current_layer), *table_prover_factory_, *params_, layer_num);
+    current_layer = UseOwned(&committed_layer->GetFriLayer());
+    committed_layers_.emplace_back(TakeOwnershipFrom(std::move(committed_layer)));
   }
 
   return current_layer;
@@ -49,7 +49,9 @@ void SaveProverContext(
 
 std::vector<std::byte> ProverMainHelper(
     Statement* statement, const JsonValue& parameters, const JsonValue& stark_config_json,
-    const JsonValue& public_input, const std::string& out_file_name, bool generate_annotations) {
+    const JsonValue& public_input, const std::string& out_file_name, bool generate_annotations,
+    TaskJob* job) {
+  TaskManager::JobScope job_scope(job);
   const Air& air = statement->GetAir();
 
   StarkProverConfig stark_config(StarkProverConfig::FromJson(stark_config_json));
@@ -62,10 +64,14 @@ std::vector<std::byte> ProverMainHelper(
   }
 
   TableProverFactory<BaseFieldElement> base_table_prover_factory =
-      GetTableProverFactory<BaseFieldElement>(&channel);
+      GetTableProverFactory<BaseFieldElement>(
+          &channel, stark_params.merkle_hash, stark_config.n_stored_merkle_layers,
+          stark_params.merkle_arity, stark_params.merkle_cap_depth);
 
   TableProverFactory<ExtensionFieldElement> extension_table_prover_factory =
-      GetTableProverFactory<ExtensionFieldElement>(&channel);
+      GetTableProverFactory<ExtensionFieldElement>(
+          &channel, stark_params.merkle_hash, stark_config.n_stored_merkle_layers,
+          stark_params.merkle_arity, stark_params.merkle_cap_depth);
 
   AnnotationScope scope(&channel, statement->GetName());
   StarkProver prover(
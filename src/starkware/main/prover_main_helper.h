@@ -6,6 +6,7 @@
 
 #include "starkware/statement/statement.h"
 #include "starkware/utils/json.h"
+#include "starkware/utils/task_manager.h"
 
 namespace starkware {
 
@@ -14,11 +15,14 @@ namespace starkware {
   Creates a new prover channel and a new StarkProver that writes to this channel.
   Returns a byte vector containing the proof from the channel. If an out_file_name value is
   provided, writes the entire prover's context to that file.
+  If job is given, the parallel work of the proof belongs to it (see TaskJob). This allows several
+  proofs to share the threads of the TaskManager with different priorities, and accounts the CPU
+  time of each proof.
 */
 std::vector<std::byte> ProverMainHelper(
     Statement* statement, const JsonValue& parameters, const JsonValue& stark_config_json,
     const JsonValue& public_input, const std::string& out_file_name = "",
-    bool generate_annotations = false);
+    bool generate_annotations = false, TaskJob* job = nullptr);
 
 }  // namespace starkware
 
@@ -1,17 +1,14 @@
 #include "starkware/main/verifier_main_helper.h"
 
 #include <fstream>
-#include <memory>
-#include <utility>
 
 #include "glog/logging.h"
 
 #include "starkware/channel/verifier_channel.h"
-#include "starkware/commitment_scheme/commitment_scheme_builder.h"
-#include "starkware/commitment_scheme/table_verifier_impl.h"
 #include "starkware/proof_system/proof_system.h"
 #include "starkware/randomness/prng.h"
 #include "starkware/stark/stark.h"
+#include "starkware/stark/utils.h"
 
 namespace starkware {
 
@@ -30,22 +27,14 @@ bool VerifierMainHelper(
     }
 
     TableVerifierFactory<BaseFieldElement> base_table_verifier_factory =
-        [&channel](uint64_t n_rows, size_t n_columns) {
-          auto packaging_commitment_scheme = MakeCommitmentSchemeVerifier(
-              n_columns * BaseFieldElement::SizeInBytes(), n_rows, &channel);
-
-          return std::make_unique<TableVerifierImpl<BaseFieldElement>>(
-              n_columns, UseMovedValue(std::move(packaging_commitment_scheme)), &channel);
-        };
+        GetTableVerifierFactory<BaseFieldElement>(
+            &channel, stark_params.merkle_hash, stark_params.merkle_arity,
+            stark_params.merkle_cap_depth);
 
     TableVerifierFactory<ExtensionFieldElement> extension_table_verifier_factory =
-        [&channel](uint64_t n_rows, size_t n_columns) {
-          auto packaging_commitment_scheme = MakeCommitmentSchemeVerifier(
-              n_columns * ExtensionFieldElement::SizeInBytes(), n_rows, &channel);
-
-          return std::make_unique<TableVerifierImpl<ExtensionFieldElement>>(
-              n_columns, UseMovedValue(std::move(packaging_commitment_scheme)), &channel);
-        };
+        GetTableVerifierFactory<ExtensionFieldElement>(
+            &channel, stark_params.merkle_hash, stark_params.merkle_arity,
+            stark_params.merkle_cap_depth);
 
     AnnotationScope scope(&channel, statement->GetName());
     // Create a StarkVerifier and verify the proof.
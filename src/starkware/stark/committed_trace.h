@@ -85,10 +85,13 @@ class CommittedTraceProver : public CommittedTraceProverBase<FieldElementT> {
 
     table_prover_factory is a function that given the size of the data to commit on, creates a
     TableProver which is used for committing and decommitting the data.
+
+    If store_full_lde is false, the LDE cosets are not kept in memory after they are committed, and
+    are recomputed whenever they are needed (see CachedLdeManager).
   */
   CommittedTraceProver(
       MaybeOwnedPtr<const EvaluationDomain> evaluation_domain, size_t n_columns,
-      const TableProverFactory<FieldElementT>& table_prover_factory);
+      const TableProverFactory<FieldElementT>& table_prover_factory, bool store_full_lde = true);
 
   size_t NumColumns() const override { return n_columns_; }
 
@@ -119,6 +122,7 @@ class CommittedTraceProver : public CommittedTraceProverBase<FieldElementT> {
   std::unique_ptr<CachedLdeManager<FieldElementT>> lde_;
   MaybeOwnedPtr<const EvaluationDomain> evaluation_domain_;
   size_t n_columns_;
+  bool store_full_lde_;
   std::unique_ptr<TableProver<FieldElementT>> table_prover_;
 };
 
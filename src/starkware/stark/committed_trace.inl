@@ -3,7 +3,9 @@
 #include <map>
 #include <set>
 
+#include "starkware/utils/buffer_pool.h"
 #include "starkware/utils/profiling.h"
+#include "starkware/utils/task_graph.h"
 
 namespace starkware {
 
@@ -16,7 +18,7 @@ namespace details {
 template <typename FieldElementT>
 inline std::unique_ptr<CachedLdeManager<FieldElementT>> CreateLdeManager(
     const Coset& trace_domain, const EvaluationDomain& evaluation_domain,
-    bool eval_in_natural_order) {
+    bool eval_in_natural_order, bool store_full_lde) {
   // Create LDE manager.
   std::unique_ptr<LdeManager<FieldElementT>> lde_manager =
       MakeLdeManager<FieldElementT>(trace_domain, eval_in_natural_order);
@@ -32,7 +34,41 @@ inline std::unique_ptr<CachedLdeManager<FieldElementT>> CreateLdeManager(
 
   // Create CachedLdeManager.
   return std::make_unique<CachedLdeManager<FieldElementT>>(
-      TakeOwnershipFrom(std::move(lde_manager)), std::move(coset_offsets));
+      TakeOwnershipFrom(std::move(lde_manager)), std::move(coset_offsets), store_full_lde);
+}
+
+/*
+  The number of cosets whose LDE may be evaluated and not yet committed at the same time, if the LDE
+  is not stored. Two cosets are enough for the LDE of one coset to overlap the commitment of the
+  other (as in kCompositionPipelineDepth of EvalComposition()).
+*/
+constexpr size_t kCommitPipelineDepth = 2;
+
+/*
+  Adds to graph, for every coset, a task that runs eval(coset_index) followed by a task that runs
+  commit(coset_index), and returns the commit tasks.
+  If max_cosets_in_progress is not 0, the eval task of a coset depends on the commit task of the
+  coset max_cosets_in_progress places before it, so that at most max_cosets_in_progress cosets are
+  evaluated and not yet committed at any time. Otherwise, all the eval tasks are ready from the
+  start, and any thread (including a thread that waits in a nested ParallelFor) may start them.
+*/
+template <typename EvalFunc, typename CommitFunc>
+std::vector<TaskGraph::Task> AddCosetTasks(
+    TaskGraph* graph, size_t n_cosets, size_t max_cosets_in_progress, const EvalFunc& eval,
+    const CommitFunc& commit) {
+  std::vector<TaskGraph::Task> commit_tasks;
+  commit_tasks.reserve(n_cosets);
+  for (size_t coset_index = 0; coset_index < n_cosets; ++coset_index) {
+    std::vector<TaskGraph::Task> eval_dependencies;
+    if (max_cosets_in_progress != 0 && coset_index >= max_cosets_in_progress) {
+      eval_dependencies.push_back(commit_tasks[coset_index - max_cosets_in_progress]);
+    }
+    const TaskGraph::Task eval_task =
+        graph->Add([eval, coset_index]() { eval(coset_index); }, eval_dependencies);
+    commit_tasks.push_back(
+        graph->Add([commit, coset_index]() { commit(coset_index); }, {eval_task}));
+  }
+  return commit_tasks;
 }
 
 }  // namespace details
@@ -45,9 +81,10 @@ inline std::unique_ptr<CachedLdeManager<FieldElementT>> CreateLdeManager(
 template <typename FieldElementT>
 CommittedTraceProver<FieldElementT>::CommittedTraceProver(
     MaybeOwnedPtr<const EvaluationDomain> evaluation_domain, size_t n_columns,
-    const TableProverFactory<FieldElementT>& table_prover_factory)
+    const TableProverFactory<FieldElementT>& table_prover_factory, bool store_full_lde)
     : evaluation_domain_(std::move(evaluation_domain)),
       n_columns_(n_columns),
+      store_full_lde_(store_full_lde),
       table_prover_(table_prover_factory(
           evaluation_domain_->NumCosets(), evaluation_domain_->TraceSize(), n_columns_)) {}
 
@@ -59,7 +96,7 @@ void CommittedTraceProver<FieldElementT>::Commit(
 
   // Create an LDE manager and add column evaluations.
   lde_ = committed_trace::details::CreateLdeManager<FieldElementT>(
-      trace_domain, *evaluation_domain_, eval_in_natural_order);
+      trace_domain, *evaluation_domain_, eval_in_natural_order, store_full_lde_);
 
   ProfilingBlock interpolation_block("Interpolation");
   auto columns = std::move(trace).ConsumeAsColumnsVector();
@@ -69,52 +106,69 @@ void CommittedTraceProver<FieldElementT>::Commit(
   lde_->FinalizeAdding();
   interpolation_block.CloseBlock();
 
-  // On each coset, evaluate the LDE and then add evaluation to the commitment scheme (bit-reverse
-  // the evaluations if necessary).
+  // On each coset, evaluate the LDE and then add the evaluation to the commitment scheme
+  // (bit-reverse the evaluations if necessary). The two stages of each coset are separate tasks of
+  // a task graph, so that the LDE of one coset overlaps with the serialization and hashing of
+  // another, and the final commitment starts as soon as the last coset is hashed. If the LDE is not
+  // stored, the number of cosets whose evaluation is held at the same time is bounded by
+  // kCommitPipelineDepth.
+  const size_t n_cosets = evaluation_domain_->NumCosets();
   const size_t trace_length = evaluation_domain_->TraceSize();
-  TaskManager::GetInstance().ParallelFor(
-      evaluation_domain_->NumCosets(),
-      [this, eval_in_natural_order, trace_length](const TaskInfo& task_info) {
-        const size_t coset_index = task_info.start_idx;
-
-        // Allocate storage for bit-reversing the evaluations.
-        std::vector<std::vector<FieldElementT>> bitrev_evaluations;
-        bitrev_evaluations.reserve(n_columns_);
 
-        // Evaluate the LDE on the coset.
+  // The state passed from the LDE task of a coset to its commit task.
+  struct CosetState {
+    // If the LDE is not stored, the evaluation is kept here only until it is committed.
+    typename CachedLdeManager<FieldElementT>::LdeCacheEntry coset_storage;
+    const typename CachedLdeManager<FieldElementT>::LdeCacheEntry* lde_evaluations = nullptr;
+  };
+  std::vector<CosetState> coset_states(n_cosets);
+
+  TaskGraph graph;
+  const std::vector<TaskGraph::Task> commit_tasks = committed_trace::details::AddCosetTasks(
+      &graph, n_cosets, store_full_lde_ ? 0 : committed_trace::details::kCommitPipelineDepth,
+      [this, &coset_states](size_t coset_index) {
+        CosetState& state = coset_states[coset_index];
         ProfilingBlock lde_block("LDE");
-        const auto lde_evaluations = lde_->EvalOnCoset(coset_index);
+        state.lde_evaluations = lde_->EvalOnCoset(coset_index, &state.coset_storage);
+      },
+      [this, &coset_states, eval_in_natural_order, trace_length](size_t coset_index) {
+        CosetState& state = coset_states[coset_index];
         std::vector<gsl::span<const FieldElementT>> lde_evaluations_spans;
-        lde_evaluations_spans.reserve(lde_evaluations->size());
-        for (const auto& lde_evaluation : *lde_evaluations) {
+        lde_evaluations_spans.reserve(state.lde_evaluations->size());
+        for (const auto& lde_evaluation : *state.lde_evaluations) {
           lde_evaluations_spans.push_back(lde_evaluation);
         }
-        lde_block.CloseBlock();
 
-        // Bit-reverse if necessary.
+        // Bit-reverse if necessary, into storage drawn from the buffer pool.
+        std::vector<PooledBuffer<FieldElementT>> bitrev_evaluations;
+        std::vector<gsl::span<const FieldElementT>> bitrev_evaluations_spans;
         if (eval_in_natural_order) {
           ProfilingBlock bit_reversal_block("BitReversal of columns");
-          for (const auto& lde_evaluation : *lde_evaluations) {
-            bitrev_evaluations.emplace_back(FieldElementT::UninitializedVector(trace_length));
-            BitReverseVector(
-                gsl::make_span(lde_evaluation), gsl::make_span(bitrev_evaluations.back()));
+          bitrev_evaluations.reserve(n_columns_);
+          bitrev_evaluations_spans.reserve(n_columns_);
+          for (const auto& lde_evaluation : lde_evaluations_spans) {
+            bitrev_evaluations.emplace_back(trace_length);
+            BitReverseVector(lde_evaluation, bitrev_evaluations.back().Span());
+            bitrev_evaluations_spans.push_back(bitrev_evaluations.back().Span());
           }
           bit_reversal_block.CloseBlock();
         }
 
         // Add the LDE coset evaluation to the commitment scheme.
         ProfilingBlock commit_to_lde_block("Commit to LDE");
-        if (eval_in_natural_order) {
-          table_prover_->AddSegmentForCommitment(
-              {bitrev_evaluations.begin(), bitrev_evaluations.end()}, coset_index);
-        } else {
-          table_prover_->AddSegmentForCommitment(lde_evaluations_spans, coset_index);
-        }
+        table_prover_->AddSegmentForCommitment(
+            eval_in_natural_order ? bitrev_evaluations_spans : lde_evaluations_spans,
+            coset_index);
         commit_to_lde_block.CloseBlock();
+
+        // The evaluation is no longer needed.
+        state.coset_storage.clear();
+        state.lde_evaluations = nullptr;
       });
 
   // Commit to the LDE evaluations.
-  table_prover_->Commit();
+  graph.Add([this]() { table_prover_->Commit(); }, commit_tasks);
+  graph.Run();
 }
 
 template <typename FieldElementT>
@@ -168,28 +222,35 @@ void CommittedTraceProver<FieldElementT>::EvalMaskAtPoint(
     columns[column_index].emplace_back(row_offset, mask_index);
   }
 
-  // Evaluate mask at each column.
-  for (const auto& [column_index, column_offsets] : columns) {
-    // Compute points to evaluate at.
-    std::vector<ExtensionFieldElement> points;
-    points.reserve(column_offsets.size());
-    for (const auto& offset_pair : column_offsets) {
-      const int64_t row_offset = offset_pair.first;
-      points.push_back(point * Pow(trace_gen, row_offset));
-    }
+  // Evaluate mask at each column. Columns are evaluated in parallel, and each column evaluation is
+  // further parallelized over the polynomial coefficients by the LDE manager.
+  const std::vector<std::pair<uint64_t, std::vector<std::pair<int64_t, size_t>>>> columns_vec(
+      columns.begin(), columns.end());
+  TaskManager::GetInstance().ParallelFor(
+      columns_vec.size(),
+      [this, &columns_vec, &point, &trace_gen, output](const TaskInfo& task_info) {
+        const auto& [column_index, column_offsets] = columns_vec[task_info.start_idx];
+
+        // Compute points to evaluate at.
+        std::vector<ExtensionFieldElement> points;
+        points.reserve(column_offsets.size());
+        for (const auto& offset_pair : column_offsets) {
+          const int64_t row_offset = offset_pair.first;
+          points.push_back(point * Pow(trace_gen, row_offset));
+        }
 
-    // Allocate output.
-    auto column_output = ExtensionFieldElement::UninitializedVector(column_offsets.size());
+        // Allocate output.
+        auto column_output = ExtensionFieldElement::UninitializedVector(column_offsets.size());
 
-    // Evaluate.
-    lde_->EvalAtPointsNotCached(column_index, points, column_output);
+        // Evaluate.
+        lde_->EvalAtPointsNotCached(column_index, points, column_output);
 
-    // Place outputs at the correct place.
-    for (size_t i = 0; i < column_offsets.size(); ++i) {
-      const size_t mask_index = column_offsets[i].second;
-      output[mask_index] = column_output.at(i);
-    }
-  }
+        // Place outputs at the correct place.
+        for (size_t i = 0; i < column_offsets.size(); ++i) {
+          const size_t mask_index = column_offsets[i].second;
+          output[mask_index] = column_output.at(i);
+        }
+      });
 }
 
 template <typename FieldElementT>
@@ -1,5 +1,9 @@
 #include "starkware/stark/committed_trace.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -12,6 +16,7 @@
 #include "starkware/error_handling/test_utils.h"
 #include "starkware/stark/test_utils.h"
 #include "starkware/stark/utils.h"
+#include "starkware/utils/task_graph.h"
 
 namespace starkware {
 namespace {
@@ -140,5 +145,47 @@ TYPED_TEST(CommittedTraceTest, Basic) {
       trace_length, n_cosets, n_columns, mask_size, /*eval_in_natural_order=*/false);
 }
 
+class AddCosetTasksTest : public ::testing::TestWithParam<bool> {
+ public:
+  AddCosetTasksTest() : manager(TaskManager::CreateInstanceForTesting(4, GetParam())) {}
+
+  TaskManager manager;
+};
+
+TEST_P(AddCosetTasksTest, MaxCosetsInProgress) {
+  const size_t n_cosets = 16;
+  const size_t max_cosets_in_progress = committed_trace::details::kCommitPipelineDepth;
+  TaskGraph graph(&manager);
+
+  // Counts the cosets that were evaluated and not yet committed.
+  std::atomic<size_t> n_cosets_alive = 0;
+  std::atomic<size_t> max_cosets_alive = 0;
+  std::atomic<size_t> n_committed = 0;
+  const auto eval = [&](size_t /*coset_index*/) {
+    const size_t n_alive = ++n_cosets_alive;
+    size_t prev_max = max_cosets_alive;
+    while (prev_max < n_alive && !max_cosets_alive.compare_exchange_weak(prev_max, n_alive)) {
+    }
+    // Threads that wait for this nested call look for other tasks meanwhile.
+    manager.ParallelFor(8, [](const TaskInfo& /*task_info*/) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  };
+  const auto commit = [&](size_t /*coset_index*/) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++n_committed;
+    --n_cosets_alive;
+  };
+  committed_trace::details::AddCosetTasks(
+      &graph, n_cosets, max_cosets_in_progress, eval, commit);
+  graph.Run();
+
+  EXPECT_EQ(0U, n_cosets_alive);
+  EXPECT_LE(max_cosets_alive, max_cosets_in_progress);
+  EXPECT_EQ(n_cosets, n_committed);
+}
+
+INSTANTIATE_TEST_CASE_P(, AddCosetTasksTest, ::testing::Bool());
+
 }  // namespace
 }  // namespace starkware
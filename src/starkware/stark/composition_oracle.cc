@@ -1,8 +1,10 @@
 #include "starkware/stark/composition_oracle.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "starkware/channel/annotation_scope.h"
+#include "starkware/utils/buffer_pool.h"
 #include "starkware/utils/profiling.h"
 
 namespace starkware {
@@ -69,6 +71,69 @@ std::vector<std::tuple<uint64_t, uint64_t, size_t>> QueriesToTraceQueries(
   return trace_queries;
 }
 
+/*
+  The number of cosets that EvalComposition() processes concurrently. The phases of a single coset
+  (LDE, bit-reversal and point-wise computation) are separated by synchronization points, where
+  threads would otherwise idle. Processing several cosets concurrently lets the phases of one coset
+  overlap the phases of another.
+*/
+constexpr uint64_t kCompositionPipelineDepth = 2;
+
+/*
+  Temporary storage used by a single pipeline of EvalComposition(). Allocated once per pipeline and
+  reused for all the cosets that the pipeline processes.
+*/
+struct CompositionPipelineStorage {
+  // Storage for the bit-reversed trace columns, used if the LDE is not naturally ordered.
+  std::vector<PooledBuffer<BaseFieldElement>> trace_bitrev;
+  std::vector<PooledBuffer<ExtensionFieldElement>> composition_trace_bitrev;
+
+  // Storage for the trace cosets, used only if the LDE is not stored in memory. In that case, each
+  // coset is recomputed right before the composition polynomial is evaluated on it.
+  CachedLdeManager<BaseFieldElement>::LdeCacheEntry trace_coset;
+  CachedLdeManager<ExtensionFieldElement>::LdeCacheEntry composition_trace_coset;
+};
+
+/*
+  Evaluates the LDE of trace on the given coset, and returns spans of the naturally ordered column
+  evaluations (bit-reversing them into bitrev_storage if needed).
+*/
+template <typename FieldElementT>
+std::vector<gsl::span<const FieldElementT>> EvalTraceOnCoset(
+    CommittedTraceProverBase<FieldElementT>* trace, uint64_t coset_index,
+    std::vector<PooledBuffer<FieldElementT>>* bitrev_storage,
+    typename CachedLdeManager<FieldElementT>::LdeCacheEntry* coset_storage) {
+  ProfilingBlock profiling_lde_block("LDE2");
+  const auto* coset_columns_eval =
+      trace->GetLde()->EvalOnCoset(coset_index, coset_storage);
+  profiling_lde_block.CloseBlock();
+
+  std::vector<gsl::span<const FieldElementT>> eval_vec;
+  eval_vec.reserve(coset_columns_eval->size());
+  if (trace->GetLde()->IsEvalNaturallyOrdered()) {
+    for (const auto& coset_column_eval : *coset_columns_eval) {
+      eval_vec.push_back(coset_column_eval);
+    }
+    return eval_vec;
+  }
+
+  ProfilingBlock profiling_block("BitReversal of columns");
+  if (bitrev_storage->empty()) {
+    bitrev_storage->reserve(coset_columns_eval->size());
+    for (const auto& coset_column_eval : *coset_columns_eval) {
+      bitrev_storage->emplace_back(coset_column_eval.size());
+    }
+  }
+  ASSERT_RELEASE(
+      bitrev_storage->size() == coset_columns_eval->size(), "Wrong number of temporary storages.");
+  for (size_t i = 0; i < coset_columns_eval->size(); ++i) {
+    BitReverseVector(
+        gsl::make_span((*coset_columns_eval)[i]), (*bitrev_storage)[i].Span());
+    eval_vec.push_back((*bitrev_storage)[i].Span());
+  }
+  return eval_vec;
+}
+
 }  // namespace
 
 CompositionOracleProver::CompositionOracleProver(
@@ -102,65 +167,39 @@ std::vector<ExtensionFieldElement> CompositionOracleProver::EvalComposition(
       "Composition polynomial degree bound is larger than evaluation domain.");
   auto evaluation = ExtensionFieldElement::UninitializedVector(n_cosets * trace_length);
 
-  // Allocate storage for bit-reversal.
-  std::vector<std::vector<BaseFieldElement>> tmp_storages;
-  if (!trace_->GetLde()->IsEvalNaturallyOrdered()) {
-    tmp_storages.reserve(trace_widths_[0]);
-    for (size_t i = 0; i < trace_widths_[0]; ++i) {
-      tmp_storages.emplace_back(BaseFieldElement::UninitializedVector(trace_length));
-    }
-  }
-  std::vector<std::vector<ExtensionFieldElement>> composition_tmp_storages;
-  if (composition_trace_.HasValue() && !composition_trace_->GetLde()->IsEvalNaturallyOrdered()) {
-    composition_tmp_storages.reserve(trace_widths_[1]);
-    for (size_t i = 0; i < trace_widths_[1]; ++i) {
-      composition_tmp_storages.emplace_back(
-          ExtensionFieldElement::UninitializedVector(trace_length));
-    }
-  }
+  // The cosets are split between n_pipelines pipelines, which run concurrently. Each pipeline
+  // processes its cosets one after the other, reusing its temporary storage.
+  const uint64_t n_pipelines = std::min<uint64_t>(kCompositionPipelineDepth, n_segments);
+  std::vector<CompositionPipelineStorage> pipeline_storages(n_pipelines);
 
   const size_t log_n_cosets = SafeLog2(evaluation_domain_->NumCosets());
-  for (uint64_t coset_index = 0; coset_index < n_segments; coset_index++) {
-    std::vector<gsl::span<const BaseFieldElement>> trace_evals;
-    std::vector<gsl::span<const ExtensionFieldElement>> composition_trace_evals;
-
-    // Evaluate trace at the coset.
-    auto eval_trace = [&](const auto& trace, auto* eval_vec, auto* tmp_storages) {
-      using FieldElementT = std::decay_t<decltype((*eval_vec)[0][0])>;
-      ProfilingBlock profiling_lde_block("LDE2");
-      const std::vector<std::vector<FieldElementT>>* coset_columns_eval =
-          trace->GetLde()->EvalOnCoset(coset_index);
-      profiling_lde_block.CloseBlock();
-
-      ProfilingBlock profiling_block("BitReversal of columns");
-      eval_vec->reserve(coset_columns_eval->size());
-      size_t tmp_storage_index = 0;
-      for (auto& coset_column_eval : *coset_columns_eval) {
-        if (trace->GetLde()->IsEvalNaturallyOrdered()) {
-          eval_vec->push_back(coset_column_eval);
-        } else {
-          ASSERT_RELEASE(
-              tmp_storage_index < tmp_storages->size(), "Not enough temporary storages.");
-          BitReverseVector(
-              gsl::make_span(coset_column_eval),
-              gsl::make_span((*tmp_storages)[tmp_storage_index]));
-          eval_vec->push_back(gsl::make_span((*tmp_storages)[tmp_storage_index]));
-          tmp_storage_index++;
+  TaskManager::GetInstance().ParallelFor(
+      n_pipelines, [&](const TaskInfo& task_info) {
+        const uint64_t pipeline_index = task_info.start_idx;
+        CompositionPipelineStorage& storage = pipeline_storages[pipeline_index];
+
+        for (uint64_t coset_index = pipeline_index; coset_index < n_segments;
+             coset_index += n_pipelines) {
+          // Evaluate trace at the coset.
+          const std::vector<gsl::span<const BaseFieldElement>> trace_evals = EvalTraceOnCoset(
+              trace_.get(), coset_index, &storage.trace_bitrev, &storage.trace_coset);
+          std::vector<gsl::span<const ExtensionFieldElement>> composition_trace_evals;
+          if (composition_trace_.HasValue()) {
+            composition_trace_evals = EvalTraceOnCoset(
+                composition_trace_.get(), coset_index, &storage.composition_trace_bitrev,
+                &storage.composition_trace_coset);
+          }
+
+          const size_t coset_natural_index = BitReverse(coset_index, log_n_cosets);
+          const BaseFieldElement coset_offset =
+              evaluation_domain_->CosetOffsets()[coset_natural_index];
+          ProfilingBlock composition_block("Actual point-wise computation");
+          composition_polynomial_->EvalOnCosetBitReversedOutput(
+              coset_offset, trace_evals, composition_trace_evals,
+              gsl::make_span(evaluation).subspan(coset_index * trace_length, trace_length),
+              task_size);
         }
-      }
-    };
-    eval_trace(trace_, &trace_evals, &tmp_storages);
-    if (composition_trace_.HasValue()) {
-      eval_trace(composition_trace_, &composition_trace_evals, &composition_tmp_storages);
-    }
-
-    const size_t coset_natural_index = BitReverse(coset_index, log_n_cosets);
-    const BaseFieldElement coset_offset = evaluation_domain_->CosetOffsets()[coset_natural_index];
-    ProfilingBlock composition_block("Actual point-wise computation");
-    composition_polynomial_->EvalOnCosetBitReversedOutput(
-        coset_offset, trace_evals, composition_trace_evals,
-        gsl::make_span(evaluation).subspan(coset_index * trace_length, trace_length), task_size);
-  }
+      });
   return evaluation;
 }
 
@@ -38,8 +38,8 @@ class CompositionOracleProver {
 
   /*
     Evaluates the composition polynomial over n_cosets cosets.
-    The evaluation is done in task_size tasks. This is forwarded to the composition polynomial
-    EvalOnCosetBitReversedOutput, see more info there.
+    The evaluation is done in task_size tasks (0 for an adaptive size). This is forwarded to the
+    composition polynomial EvalOnCosetBitReversedOutput, see more info there.
   */
   std::vector<ExtensionFieldElement> EvalComposition(uint64_t task_size, uint64_t n_cosets) const;
 
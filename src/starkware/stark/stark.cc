@@ -3,10 +3,13 @@
 #include <algorithm>
 #include <map>
 #include <set>
+#include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "glog/logging.h"
+
 #include "starkware/channel/annotation_scope.h"
 #include "starkware/fri/fri_prover.h"
 #include "starkware/fri/fri_verifier.h"
@@ -14,6 +17,7 @@
 #include "starkware/stark/oods.h"
 #include "starkware/stl_utils/containers.h"
 #include "starkware/utils/bit_reversal.h"
+#include "starkware/utils/buffer_pool.h"
 #include "starkware/utils/profiling.h"
 
 namespace starkware {
@@ -77,13 +81,20 @@ static Coset GenerateCompositionDomain(const Air& air) {
 
 StarkParameters::StarkParameters(
     size_t n_evaluation_domain_cosets, size_t trace_length, MaybeOwnedPtr<const Air> air,
-    MaybeOwnedPtr<FriParameters> fri_params)
+    MaybeOwnedPtr<FriParameters> fri_params, size_t merkle_arity, size_t merkle_cap_depth,
+    MerkleHash merkle_hash)
     : evaluation_domain(trace_length, n_evaluation_domain_cosets),
       composition_eval_domain(GenerateCompositionDomain(*air)),
       air(std::move(air)),
-      fri_params(std::move(fri_params)) {
+      fri_params(std::move(fri_params)),
+      merkle_arity(merkle_arity),
+      merkle_cap_depth(merkle_cap_depth),
+      merkle_hash(merkle_hash) {
   ASSERT_RELEASE(
       IsPowerOfTwo(n_evaluation_domain_cosets), "The number of cosets must be a power of 2.");
+  ASSERT_RELEASE(
+      merkle_arity >= 2 && merkle_arity <= 16 && IsPowerOfTwo(merkle_arity),
+      "The Merkle tree arity must be 2, 4, 8 or 16.");
 
   // Check that the fri_step_list and last_layer_degree_bound parameters are consistent with the
   // trace length. This is the expected degree in the out of domain sampling stage.
@@ -111,9 +122,24 @@ StarkParameters StarkParameters::FromJson(const JsonValue& json, MaybeOwnedPtr<c
   const size_t n_cosets = Pow2(log_n_cosets);
 
   FriParameters fri_params = FriParameters::FromJson(json["fri"], log_trace_length, log_n_cosets);
+  const size_t merkle_arity = json["merkle_arity"].HasValue() ? json["merkle_arity"].AsSizeT() : 2;
+  const size_t merkle_cap_depth =
+      json["merkle_cap_depth"].HasValue() ? json["merkle_cap_depth"].AsSizeT() : 0;
+  MerkleHash merkle_hash = MerkleHash::kBlake2s160;
+  if (json["merkle_hash"].HasValue()) {
+    const std::string merkle_hash_name = json["merkle_hash"].AsString();
+    if (merkle_hash_name == "keccak256") {
+      merkle_hash = MerkleHash::kKeccak256;
+    } else {
+      ASSERT_RELEASE(
+          merkle_hash_name == "blake2s160",
+          "Unknown merkle_hash: " + merkle_hash_name + ". Expected blake2s160 or keccak256.");
+    }
+  }
 
   return StarkParameters(
-      n_cosets, trace_length, std::move(air), UseMovedValue(std::move(fri_params)));
+      n_cosets, trace_length, std::move(air), UseMovedValue(std::move(fri_params)), merkle_arity,
+      merkle_cap_depth, merkle_hash);
 }
 
 // ------------------------------------------------------------------------------------------
@@ -122,10 +148,19 @@ StarkParameters StarkParameters::FromJson(const JsonValue& json, MaybeOwnedPtr<c
 
 StarkProverConfig StarkProverConfig::FromJson(const JsonValue& json) {
   const uint64_t constraint_polynomial_task_size =
-      json["constraint_polynomial_task_size"].AsUint64();
+      json["constraint_polynomial_task_size"].HasValue()
+          ? json["constraint_polynomial_task_size"].AsUint64()
+          : 256;
+  const bool store_full_lde =
+      json["store_full_lde"].HasValue() ? json["store_full_lde"].AsBool() : true;
+  const size_t n_stored_merkle_layers = json["n_stored_merkle_layers"].HasValue()
+                                            ? json["n_stored_merkle_layers"].AsSizeT()
+                                            : 0;
 
   return {
       /*constraint_polynomial_task_size=*/constraint_polynomial_task_size,
+      /*store_full_lde=*/store_full_lde,
+      /*n_stored_merkle_layers=*/n_stored_merkle_layers,
   };
 }
 
@@ -185,7 +220,8 @@ CommittedTraceProver<FieldElementT> StarkProver::CommitOnTrace(
   }
 
   CommittedTraceProver<FieldElementT> committed_trace(
-      UseOwned(&params_->evaluation_domain), trace.Width(), *table_prover_factory);
+      UseOwned(&params_->evaluation_domain), trace.Width(), *table_prover_factory,
+      config_->store_full_lde);
   committed_trace.Commit(std::move(trace), trace_domain, bit_reverse);
   return committed_trace;
 }
@@ -257,6 +293,11 @@ void StarkProver::ValidateTraceSize(const size_t n_rows, const size_t n_columns)
 
 void StarkProver::ProveStark(Trace&& trace) {
   ValidateTraceSize(trace.Length(), trace.Width());
+  // The temporary buffers of the proof are kept for reuse in a pool of its own, so that concurrent
+  // proofs do not free each other's buffers. The pool is used by the nested ParallelFor calls as
+  // well, and its cached buffers are freed when the proof ends.
+  BufferPool buffer_pool;
+  BufferPool::Scope buffer_pool_scope(&buffer_pool);
   AnnotationScope scope(channel_.get(), "STARK");
   MaybeOwnedPtr<CommittedTraceProverBase<BaseFieldElement>> committed_trace;
   // Add committed trace (create LDE of the trace and commit to it).
@@ -286,6 +327,9 @@ void StarkProver::ProveStark(Trace&& trace) {
       OutOfDomainSamplingProve(std::move(composition_oracle));
 
   PerformLowDegreeTest(oods_composition_oracle);
+
+  VLOG(1) << "Buffer pool: " << buffer_pool.NumAllocated() << " allocations for "
+          << buffer_pool.NumAcquired() << " temporary buffers.";
 }
 
 // ------------------------------------------------------------------------------------------
@@ -24,6 +24,7 @@
 #include "starkware/fri/fri_parameters.h"
 #include "starkware/stark/committed_trace.h"
 #include "starkware/stark/composition_oracle.h"
+#include "starkware/stark/utils.h"
 #include "starkware/utils/json.h"
 #include "starkware/utils/maybe_owned_ptr.h"
 
@@ -32,7 +33,8 @@ namespace starkware {
 struct StarkParameters {
   StarkParameters(
       size_t n_evaluation_domain_cosets, size_t trace_length, MaybeOwnedPtr<const Air> air,
-      MaybeOwnedPtr<FriParameters> fri_params);
+      MaybeOwnedPtr<FriParameters> fri_params, size_t merkle_arity = 2,
+      size_t merkle_cap_depth = 0, MerkleHash merkle_hash = MerkleHash::kBlake2s160);
 
   size_t TraceLength() const { return evaluation_domain.TraceSize(); }
   size_t NumCosets() const { return evaluation_domain.NumCosets(); }
@@ -45,6 +47,22 @@ struct StarkParameters {
 
   MaybeOwnedPtr<const Air> air;
   MaybeOwnedPtr<FriParameters> fri_params;
+
+  /*
+    The arity of the Merkle trees of the commitments (see MerkleTree): 2, 4, 8 or 16.
+  */
+  size_t merkle_arity;
+
+  /*
+    The commitments are the caps of the Merkle trees at this depth (see MerkleTree::GetCap()), i.e.
+    2^merkle_cap_depth nodes instead of the root, and the authentication paths end at the caps.
+  */
+  size_t merkle_cap_depth;
+
+  /*
+    The hash of the Merkle trees of the commitments. The prover and the verifier must agree on it.
+  */
+  MerkleHash merkle_hash;
 };
 
 struct StarkProverConfig {
@@ -54,12 +72,31 @@ struct StarkProverConfig {
     The larger the task size the lower the amortized threading overhead but this can also affect the
     fragmentation effect in case the number of tasks doesn't divide the coset by a multiple of the
     number of threads in the thread pool.
+    If 0, the task size is learned at runtime from the measured execution times. Defaults to 256.
   */
   uint64_t constraint_polynomial_task_size;
 
+  /*
+    If true, the LDE of the traces is kept in memory once it is computed for the commitment, and is
+    reused for the evaluation of the composition polynomial and for the decommitment.
+    Otherwise, each LDE coset is recomputed when needed. This bounds the peak memory usage, and the
+    composition polynomial is evaluated on each coset right after its LDE is computed, while the
+    coset is still in cache.
+  */
+  bool store_full_lde;
+
+  /*
+    If positive, the Merkle trees of the commitments keep only their top n_stored_merkle_layers
+    layers in memory, and the other nodes are recomputed for the decommitment (see MerkleTree).
+    If 0 (the default), the full trees are kept.
+  */
+  size_t n_stored_merkle_layers;
+
   static StarkProverConfig Default() {
     return {
         /*constraint_polynomial_task_size=*/256,
+        /*store_full_lde=*/true,
+        /*n_stored_merkle_layers=*/0,
     };
   }
 
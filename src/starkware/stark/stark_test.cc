@@ -36,18 +36,20 @@ using testing::HasSubstr;
 
 template <typename FieldElementT>
 std::unique_ptr<TableProver<FieldElementT>> MakeTableProver(
-    uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns, ProverChannel* channel) {
-  return GetTableProverFactory<FieldElementT>(channel)(n_segments, n_rows_per_segment, n_columns);
+    uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns, ProverChannel* channel,
+    size_t merkle_arity = 2, size_t merkle_cap_depth = 0,
+    MerkleHash merkle_hash = MerkleHash::kBlake2s160) {
+  return GetTableProverFactory<FieldElementT>(
+      channel, merkle_hash, 0, merkle_arity, merkle_cap_depth)(
+      n_segments, n_rows_per_segment, n_columns);
 }
 
 template <typename FieldElementT>
 std::unique_ptr<TableVerifier<FieldElementT>> MakeTableVerifier(
-    uint64_t n_rows, uint64_t n_columns, VerifierChannel* channel) {
-  auto packaging_commitment_scheme =
-      MakeCommitmentSchemeVerifier(n_columns * FieldElementT::SizeInBytes(), n_rows, channel);
-
-  return std::make_unique<TableVerifierImpl<FieldElementT>>(
-      n_columns, UseMovedValue(std::move(packaging_commitment_scheme)), channel);
+    uint64_t n_rows, uint64_t n_columns, VerifierChannel* channel, size_t merkle_arity = 2,
+    size_t merkle_cap_depth = 0, MerkleHash merkle_hash = MerkleHash::kBlake2s160) {
+  return GetTableVerifierFactory<FieldElementT>(
+      channel, merkle_hash, merkle_arity, merkle_cap_depth)(n_rows, n_columns);
 }
 
 std::vector<size_t> DrawFriStepsList(const size_t log_degree_bound, Prng* prng) {
@@ -107,12 +109,16 @@ class StarkTest : public ::testing::Test {
     base_table_prover_factory =
         [this](uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns) {
           return MakeTableProver<BaseFieldElement>(
-              n_segments, n_rows_per_segment, n_columns, &prover_channel);
+              n_segments, n_rows_per_segment, n_columns, &prover_channel,
+              GetStarkParams().merkle_arity, GetStarkParams().merkle_cap_depth,
+              GetStarkParams().merkle_hash);
         };
     extension_table_prover_factory =
         [this](uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns) {
           return MakeTableProver<ExtensionFieldElement>(
-              n_segments, n_rows_per_segment, n_columns, &prover_channel);
+              n_segments, n_rows_per_segment, n_columns, &prover_channel,
+              GetStarkParams().merkle_arity, GetStarkParams().merkle_cap_depth,
+              GetStarkParams().merkle_hash);
         };
   }
 
@@ -125,12 +131,16 @@ class StarkTest : public ::testing::Test {
     }
 
     TableVerifierFactory<BaseFieldElement> base_table_verifier_factory =
-        [&verifier_channel](uint64_t n_rows, uint64_t n_columns) {
-          return MakeTableVerifier<BaseFieldElement>(n_rows, n_columns, &verifier_channel);
+        [this, &verifier_channel](uint64_t n_rows, uint64_t n_columns) {
+          return MakeTableVerifier<BaseFieldElement>(
+              n_rows, n_columns, &verifier_channel, GetStarkParams().merkle_arity,
+              GetStarkParams().merkle_cap_depth, GetStarkParams().merkle_hash);
         };
     TableVerifierFactory<ExtensionFieldElement> extension_table_verifier_factory =
-        [&verifier_channel](uint64_t n_rows, uint64_t n_columns) {
-          return MakeTableVerifier<ExtensionFieldElement>(n_rows, n_columns, &verifier_channel);
+        [this, &verifier_channel](uint64_t n_rows, uint64_t n_columns) {
+          return MakeTableVerifier<ExtensionFieldElement>(
+              n_rows, n_columns, &verifier_channel, GetStarkParams().merkle_arity,
+              GetStarkParams().merkle_cap_depth, GetStarkParams().merkle_hash);
         };
     StarkVerifier stark_verifier(
         UseOwned(&verifier_channel), UseOwned(&base_table_verifier_factory),
@@ -191,6 +201,89 @@ TEST_F(TestAirStarkTest, Correctness) {
   EXPECT_TRUE(this->VerifyProof(proof_annotations_pair.first, proof_annotations_pair.second));
 }
 
+TEST_F(TestAirStarkTest, MerkleArity) {
+  this->stark_params.merkle_arity = 8;
+  const auto proof_annotations_pair = this->GenerateProofWithAnnotations();
+  EXPECT_TRUE(this->VerifyProof(proof_annotations_pair.first, proof_annotations_pair.second));
+
+  // A proof of trees of one arity is rejected by a verifier that expects another.
+  this->stark_params.merkle_arity = 4;
+  EXPECT_FALSE(this->VerifyProof(proof_annotations_pair.first));
+}
+
+TEST_F(TestAirStarkTest, MerkleCap) {
+  this->stark_params.merkle_cap_depth = 3;
+  const auto proof_annotations_pair = this->GenerateProofWithAnnotations();
+  EXPECT_TRUE(this->VerifyProof(proof_annotations_pair.first, proof_annotations_pair.second));
+
+  // A proof of commitments to caps is rejected by a verifier that expects commitments to roots.
+  this->stark_params.merkle_cap_depth = 0;
+  EXPECT_FALSE(this->VerifyProof(proof_annotations_pair.first));
+}
+
+TEST_F(TestAirStarkTest, MerkleHash) {
+  this->stark_params.merkle_hash = MerkleHash::kKeccak256;
+  const auto proof_annotations_pair = this->GenerateProofWithAnnotations();
+  EXPECT_TRUE(this->VerifyProof(proof_annotations_pair.first, proof_annotations_pair.second));
+
+  // A proof of Keccak256 trees is rejected by a verifier that expects Blake2s160 trees.
+  this->stark_params.merkle_hash = MerkleHash::kBlake2s160;
+  EXPECT_FALSE(this->VerifyProof(proof_annotations_pair.first));
+}
+
+TEST_F(TestAirStarkTest, NoStoreFullLde) {
+  // Generate a proof with the full LDE stored in memory.
+  const std::vector<std::byte> expected_proof = this->GenerateProof();
+
+  // Generate a proof where the LDE cosets are recomputed on demand.
+  ProverChannel prover_channel(this->channel_prng.Clone());
+  TableProverFactory<BaseFieldElement> base_table_prover_factory =
+      [&prover_channel](uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns) {
+        return MakeTableProver<BaseFieldElement>(
+            n_segments, n_rows_per_segment, n_columns, &prover_channel);
+      };
+  TableProverFactory<ExtensionFieldElement> extension_table_prover_factory =
+      [&prover_channel](uint64_t n_segments, uint64_t n_rows_per_segment, size_t n_columns) {
+        return MakeTableProver<ExtensionFieldElement>(
+            n_segments, n_rows_per_segment, n_columns, &prover_channel);
+      };
+  StarkProverConfig stark_config = StarkProverConfig::Default();
+  stark_config.store_full_lde = false;
+
+  StarkProver stark_prover(
+      UseOwned(&prover_channel), UseOwned(&base_table_prover_factory),
+      UseOwned(&extension_table_prover_factory), UseOwned(&GetStarkParams()),
+      UseOwned(&stark_config));
+  stark_prover.ProveStark(TestAir::GetTrace(secret, trace_length, res_claim_index));
+
+  EXPECT_EQ(prover_channel.GetProof(), expected_proof);
+}
+
+TEST_F(TestAirStarkTest, StoredMerkleLayers) {
+  // Generate a proof with the full Merkle trees stored in memory.
+  const std::vector<std::byte> expected_proof = this->GenerateProof();
+
+  // Generate a proof where the Merkle trees keep only their top layers, and the other nodes of the
+  // authentication paths are recomputed for the decommitment.
+  ProverChannel prover_channel(this->channel_prng.Clone());
+  StarkProverConfig stark_config = StarkProverConfig::Default();
+  stark_config.n_stored_merkle_layers = 2;
+  TableProverFactory<BaseFieldElement> base_table_prover_factory =
+      GetTableProverFactory<BaseFieldElement>(&prover_channel, stark_config.n_stored_merkle_layers);
+  TableProverFactory<ExtensionFieldElement> extension_table_prover_factory =
+      GetTableProverFactory<ExtensionFieldElement>(
+          &prover_channel, stark_config.n_stored_merkle_layers);
+
+  StarkProver stark_prover(
+      UseOwned(&prover_channel), UseOwned(&base_table_prover_factory),
+      UseOwned(&extension_table_prover_factory), UseOwned(&GetStarkParams()),
+      UseOwned(&stark_config));
+  stark_prover.ProveStark(TestAir::GetTrace(secret, trace_length, res_claim_index));
+
+  EXPECT_EQ(prover_channel.GetProof(), expected_proof);
+  EXPECT_TRUE(this->VerifyProof(prover_channel.GetProof(), prover_channel.GetAnnotations()));
+}
+
 // Derive from StarkTest to call the constructor with use_random_values=false.
 
 class StarkTestConstSeed : public TestAirStarkTest {
@@ -2,12 +2,48 @@
 #define STARKWARE_STARK_UTILS_H_
 
 #include "starkware/channel/prover_channel.h"
+#include "starkware/channel/verifier_channel.h"
 #include "starkware/commitment_scheme/table_prover.h"
+#include "starkware/commitment_scheme/table_verifier.h"
+#include "starkware/crypt_tools/blake2s_160.h"
 
 namespace starkware {
 
+/*
+  The hash of the Merkle trees of the commitments.
+*/
+enum class MerkleHash { kBlake2s160, kKeccak256 };
+
+/*
+  Returns a factory of table provers that commit using Merkle trees of HashT with the given arity,
+  to their caps at merkle_cap_depth. If n_stored_merkle_layers is positive, the trees keep only
+  their top n_stored_merkle_layers layers (see MerkleTree).
+*/
+template <typename FieldElementT, typename HashT = Blake2s160>
+TableProverFactory<FieldElementT> GetTableProverFactory(
+    ProverChannel* channel, size_t n_stored_merkle_layers = 0, size_t merkle_arity = 2,
+    size_t merkle_cap_depth = 0);
+
+/*
+  Same as above, with the hash chosen at runtime.
+*/
+template <typename FieldElementT>
+TableProverFactory<FieldElementT> GetTableProverFactory(
+    ProverChannel* channel, MerkleHash merkle_hash, size_t n_stored_merkle_layers = 0,
+    size_t merkle_arity = 2, size_t merkle_cap_depth = 0);
+
+/*
+  Returns a factory of table verifiers that read the commitments of the table provers of
+  GetTableProverFactory() with the same hash, arity and merkle_cap_depth.
+*/
+template <typename FieldElementT, typename HashT = Blake2s160>
+TableVerifierFactory<FieldElementT> GetTableVerifierFactory(
+    VerifierChannel* channel, size_t merkle_arity = 2, size_t merkle_cap_depth = 0);
+
 template <typename FieldElementT>
-TableProverFactory<FieldElementT> GetTableProverFactory(ProverChannel* channel);
+TableVerifierFactory<FieldElementT> GetTableVerifierFactory(
+    VerifierChannel* channel, MerkleHash merkle_hash, size_t merkle_arity = 2,
+    size_t merkle_cap_depth = 0);
 
 }  // namespace starkware
 
@@ -5,21 +5,71 @@
 
 #include "starkware/commitment_scheme/commitment_scheme_builder.h"
 #include "starkware/commitment_scheme/table_prover_impl.h"
+#include "starkware/commitment_scheme/table_verifier_impl.h"
+#include "starkware/crypt_tools/keccak_256.h"
+#include "starkware/error_handling/error_handling.h"
 #include "starkware/math/math.h"
 
 namespace starkware {
 
-template <typename FieldElementT>
-TableProverFactory<FieldElementT> GetTableProverFactory(ProverChannel* channel) {
-  return [channel](
+template <typename FieldElementT, typename HashT>
+TableProverFactory<FieldElementT> GetTableProverFactory(
+    ProverChannel* channel, size_t n_stored_merkle_layers, size_t merkle_arity,
+    size_t merkle_cap_depth) {
+  return [channel, n_stored_merkle_layers, merkle_arity, merkle_cap_depth](
              size_t n_segments, uint64_t n_rows_per_segment,
              size_t n_columns) -> std::unique_ptr<TableProver<FieldElementT>> {
-    auto packaging_commitment_scheme = MakeCommitmentSchemeProver(
-        FieldElementT::SizeInBytes() * n_columns, n_rows_per_segment, n_segments, channel);
+    auto packaging_commitment_scheme = MakeCommitmentSchemeProver<HashT>(
+        FieldElementT::SizeInBytes() * n_columns, n_rows_per_segment, n_segments, channel,
+        n_stored_merkle_layers, merkle_arity, merkle_cap_depth);
 
     return std::make_unique<TableProverImpl<FieldElementT>>(
         n_columns, UseMovedValue(std::move(packaging_commitment_scheme)), channel);
   };
 }
 
+template <typename FieldElementT>
+TableProverFactory<FieldElementT> GetTableProverFactory(
+    ProverChannel* channel, MerkleHash merkle_hash, size_t n_stored_merkle_layers,
+    size_t merkle_arity, size_t merkle_cap_depth) {
+  switch (merkle_hash) {
+    case MerkleHash::kBlake2s160:
+      return GetTableProverFactory<FieldElementT, Blake2s160>(
+          channel, n_stored_merkle_layers, merkle_arity, merkle_cap_depth);
+    case MerkleHash::kKeccak256:
+      return GetTableProverFactory<FieldElementT, Keccak256>(
+          channel, n_stored_merkle_layers, merkle_arity, merkle_cap_depth);
+  }
+  THROW_STARKWARE_EXCEPTION("Unknown Merkle hash.");
+}
+
+template <typename FieldElementT, typename HashT>
+TableVerifierFactory<FieldElementT> GetTableVerifierFactory(
+    VerifierChannel* channel, size_t merkle_arity, size_t merkle_cap_depth) {
+  return [channel, merkle_arity, merkle_cap_depth](
+             uint64_t n_rows, size_t n_columns) -> std::unique_ptr<TableVerifier<FieldElementT>> {
+    auto packaging_commitment_scheme = MakeCommitmentSchemeVerifier<HashT>(
+        n_columns * FieldElementT::SizeInBytes(), n_rows, channel, merkle_arity,
+        merkle_cap_depth);
+
+    return std::make_unique<TableVerifierImpl<FieldElementT>>(
+        n_columns, UseMovedValue(std::move(packaging_commitment_scheme)), channel);
+  };
+}
+
+template <typename FieldElementT>
+TableVerifierFactory<FieldElementT> GetTableVerifierFactory(
+    VerifierChannel* channel, MerkleHash merkle_hash, size_t merkle_arity,
+    size_t merkle_cap_depth) {
+  switch (merkle_hash) {
+    case MerkleHash::kBlake2s160:
+      return GetTableVerifierFactory<FieldElementT, Blake2s160>(
+          channel, merkle_arity, merkle_cap_depth);
+    case MerkleHash::kKeccak256:
+      return GetTableVerifierFactory<FieldElementT, Keccak256>(
+          channel, merkle_arity, merkle_cap_depth);
+  }
+  THROW_STARKWARE_EXCEPTION("Unknown Merkle hash.");
+}
+
 }  // namespace starkware
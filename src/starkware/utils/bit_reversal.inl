@@ -1,7 +1,36 @@
+#include <array>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+
 #include "starkware/utils/task_manager.h"
 
 namespace starkware {
 
+namespace bit_reversal {
+namespace details {
+
+/*
+  Returns the ParallelForAdaptive() tag of BitReverseVector() on 2^logn elements of type
+  FieldElementT. The time of an iteration depends on the element type and on the size of the vector
+  (through the level of the memory hierarchy that holds it), so each such pair has its own tag.
+*/
+template <typename FieldElementT>
+std::string_view BitReverseVectorTag(size_t logn) {
+  static const std::array<std::string, 64> kTags = []() {
+    std::array<std::string, 64> tags;
+    for (size_t i = 0; i < tags.size(); ++i) {
+      tags[i] = std::string("BitReverseVector<") + typeid(FieldElementT).name() + ">/2^" +
+                std::to_string(i);
+    }
+    return tags;
+  }();
+  return kTags.at(logn);
+}
+
+}  // namespace details
+}  // namespace bit_reversal
+
 template <typename FieldElementT>
 void BitReverseVector(gsl::span<const FieldElementT> src, gsl::span<FieldElementT> dst) {
   ASSERT_RELEASE(src.size() == dst.size(), "Span sizes of src and dst must be similar.");
@@ -11,15 +40,15 @@ void BitReverseVector(gsl::span<const FieldElementT> src, gsl::span<FieldElement
 
   TaskManager& task_manager = TaskManager::GetInstance();
 
-  task_manager.ParallelFor(
-      src.size(),
+  task_manager.ParallelForAdaptive(
+      0, src.size(),
       [src, dst, logn](const TaskInfo& task_info) {
         for (size_t k = task_info.start_idx; k < task_info.end_idx; ++k) {
           const size_t rk = BitReverse(k, logn);
           dst[rk] = src[k];
         }
       },
-      src.size(), min_work_chunk);
+      bit_reversal::details::BitReverseVectorTag<FieldElementT>(logn), min_work_chunk);
 }
 
 }  // namespace starkware
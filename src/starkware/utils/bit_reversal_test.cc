@@ -6,6 +6,7 @@
 #include "gtest/gtest.h"
 
 #include "starkware/algebra/fields/base_field_element.h"
+#include "starkware/algebra/fields/extension_field_element.h"
 #include "starkware/error_handling/test_utils.h"
 #include "starkware/randomness/prng.h"
 
@@ -65,5 +66,24 @@ TEST(BitReverseVector, Correctness) {
   }
 }
 
+TEST(BitReverseVector, AdaptiveTag) {
+  // Each element type and vector size learns its chunk size separately.
+  const size_t log_n = 12;
+  TaskManager& task_manager = TaskManager::GetInstance();
+  const auto tag = bit_reversal::details::BitReverseVectorTag<BaseFieldElement>(log_n);
+  EXPECT_NE(tag, bit_reversal::details::BitReverseVectorTag<BaseFieldElement>(log_n + 1));
+  EXPECT_NE(tag, bit_reversal::details::BitReverseVectorTag<ExtensionFieldElement>(log_n));
+
+  Prng prng;
+  const auto src = prng.RandomFieldElementVector<BaseFieldElement>(Pow2(log_n));
+  BitReverseVector<BaseFieldElement>(src);
+  EXPECT_GT(task_manager.GetAdaptiveIterationTime(tag).count(), 0);
+  EXPECT_EQ(
+      0, task_manager
+             .GetAdaptiveIterationTime(
+                 bit_reversal::details::BitReverseVectorTag<ExtensionFieldElement>(log_n))
+             .count());
+}
+
 }  // namespace
 }  // namespace starkware
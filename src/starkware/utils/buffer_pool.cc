@@ -0,0 +1,88 @@
+#include "starkware/utils/buffer_pool.h"
+
+#include <algorithm>
+
+#include "starkware/math/math.h"
+#include "starkware/utils/large_buffer_allocator.h"
+
+DEFINE_uint64(
+    buffer_pool_max_cached_mb, 4096,
+    "The maximal amount of memory (in megabytes) of released temporary buffers that are kept for "
+    "reuse. 0 disables buffer pooling.");
+
+namespace starkware {
+
+namespace {
+
+// Buffer sizes are rounded up to a multiple of kSizeClassGranularity, so that requests of slightly
+// different sizes share buffers.
+constexpr size_t kSizeClassGranularity = 4096;
+
+}  // namespace
+
+BufferPool& BufferPool::GetInstance() {
+  static BufferPool instance;
+  return instance;
+}
+
+size_t BufferPool::SizeClass(size_t n_bytes) {
+  return std::max<size_t>(DivCeil(n_bytes, kSizeClassGranularity), 1) * kSizeClassGranularity;
+}
+
+void* BufferPool::Acquire(size_t n_bytes) {
+  const size_t size_class = SizeClass(n_bytes);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    n_acquired_++;
+    auto it = free_buffers_.find(size_class);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= size_class;
+      return ptr;
+    }
+    n_allocated_++;
+  }
+  return AllocateLargeBuffer(size_class);
+}
+
+void BufferPool::Release(void* ptr, size_t n_bytes) {
+  const size_t size_class = SizeClass(n_bytes);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (cached_bytes_ + size_class <= FLAGS_buffer_pool_max_cached_mb * Pow2(20)) {
+      free_buffers_[size_class].push_back(ptr);
+      cached_bytes_ += size_class;
+      return;
+    }
+  }
+  FreeLargeBuffer(ptr, size_class);
+}
+
+void BufferPool::Clear() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& [size_class, buffers] : free_buffers_) {
+    for (void* ptr : buffers) {
+      FreeLargeBuffer(ptr, size_class);
+    }
+  }
+  free_buffers_.clear();
+  cached_bytes_ = 0;
+}
+
+size_t BufferPool::NumAcquired() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return n_acquired_;
+}
+
+size_t BufferPool::NumAllocated() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return n_allocated_;
+}
+
+size_t BufferPool::CachedBytes() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return cached_bytes_;
+}
+
+}  // namespace starkware
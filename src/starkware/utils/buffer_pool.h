@@ -0,0 +1,162 @@
+#ifndef STARKWARE_UTILS_BUFFER_POOL_H_
+#define STARKWARE_UTILS_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "third_party/gsl/gsl-lite.hpp"
+
+#include "starkware/utils/task_manager.h"
+
+DECLARE_uint64(buffer_pool_max_cached_mb);
+
+namespace starkware {
+
+/*
+  A thread-safe pool of large temporary buffers.
+
+  The prover repeatedly allocates buffers of the same few sizes (one per coset, FRI layer or
+  segment) and frees them shortly after. Instead of returning these buffers to the OS (which costs
+  an munmap() and, on the next allocation, a page fault per page), released buffers are kept in the
+  pool and handed out again to the next request of the same size class.
+
+  Buffers are allocated with AllocateLargeBuffer(). At most --buffer_pool_max_cached_mb megabytes of
+  released buffers are kept. The cached buffers are freed by Clear() or by the destructor.
+
+  Each proof uses a pool of its own, which it makes current (see Scope) while it runs, so that
+  concurrent proofs neither share nor free each other's buffers.
+
+  Use PooledBuffer rather than calling Acquire() and Release() directly.
+*/
+class BufferPool {
+ public:
+  BufferPool() = default;
+  ~BufferPool() { Clear(); }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+  BufferPool(BufferPool&&) = delete;
+  BufferPool& operator=(BufferPool&&) = delete;
+
+  static BufferPool& GetInstance();
+
+  /*
+    Makes PooledBuffer draw from pool in the current thread until the scope ends. The chunks of the
+    ParallelFor calls made inside the scope use pool as well, on any thread (the pool is kept as
+    the TaskManager task context). pool must outlive the scope.
+  */
+  class Scope {
+   public:
+    explicit Scope(BufferPool* pool) : context_scope_(pool) {}
+
+   private:
+    TaskManager::TaskContextScope context_scope_;
+  };
+
+  /*
+    Returns the pool of the innermost Scope of the current thread, or GetInstance() outside of
+    such a scope.
+  */
+  static BufferPool& Current() {
+    auto* pool = static_cast<BufferPool*>(TaskManager::CurrentTaskContext());
+    return pool != nullptr ? *pool : GetInstance();
+  }
+
+  /*
+    Returns a buffer of at least n_bytes bytes. The buffer must be returned by
+    Release(ptr, n_bytes).
+  */
+  void* Acquire(size_t n_bytes);
+
+  void Release(void* ptr, size_t n_bytes);
+
+  /*
+    Frees all the cached buffers.
+  */
+  void Clear();
+
+  /*
+    Statistics, for profiling and tests.
+  */
+  size_t NumAcquired() const;
+  size_t NumAllocated() const;
+  size_t CachedBytes() const;
+
+ private:
+  static size_t SizeClass(size_t n_bytes);
+
+  mutable std::mutex mutex_;
+  // Maps a size class to the released buffers of that size.
+  std::map<size_t, std::vector<void*>> free_buffers_;
+  size_t cached_bytes_ = 0;
+  size_t n_acquired_ = 0;
+  size_t n_allocated_ = 0;
+};
+
+/*
+  A fixed-size buffer of T drawn from BufferPool::Current(), and returned to that pool on
+  destruction (which may happen in another thread).
+  The elements are not initialized. T must be trivially copyable (e.g., field elements and bytes).
+
+  Usage:
+    PooledBuffer<BaseFieldElement> tmp(size);
+    BitReverseVector(src, tmp.Span());
+*/
+template <typename T>
+class PooledBuffer {
+  static_assert(std::is_trivially_copyable_v<T>, "PooledBuffer requires a trivially copyable T.");
+
+ public:
+  explicit PooledBuffer(size_t size)
+      : pool_(&BufferPool::Current()),
+        size_(size),
+        data_(static_cast<T*>(pool_->Acquire(size * sizeof(T)))) {}
+
+  ~PooledBuffer() { Reset(); }
+
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  PooledBuffer(PooledBuffer&& other) noexcept
+      : pool_(other.pool_), size_(other.size_), data_(std::exchange(other.data_, nullptr)) {}
+
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      pool_ = other.pool_;
+      size_ = other.size_;
+      data_ = std::exchange(other.data_, nullptr);
+    }
+    return *this;
+  }
+
+  size_t size() const { return size_; }
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  T& operator[](size_t idx) { return data_[idx]; }
+  const T& operator[](size_t idx) const { return data_[idx]; }
+
+  gsl::span<T> Span() { return gsl::make_span(data_, size_); }
+  gsl::span<const T> Span() const { return gsl::make_span(data_, size_); }
+
+ private:
+  void Reset() {
+    if (data_ != nullptr) {
+      pool_->Release(data_, size_ * sizeof(T));
+      data_ = nullptr;
+    }
+  }
+
+  BufferPool* pool_;
+  size_t size_;
+  T* data_;
+};
+
+}  // namespace starkware
+
+#endif  // STARKWARE_UTILS_BUFFER_POOL_H_
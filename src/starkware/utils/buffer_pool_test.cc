@@ -0,0 +1,100 @@
+#include "starkware/utils/buffer_pool.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "starkware/math/math.h"
+#include "starkware/utils/task_manager.h"
+
+namespace starkware {
+namespace {
+
+TEST(BufferPool, ReuseReleasedBuffer) {
+  BufferPool pool;
+  void* ptr = pool.Acquire(10000);
+  pool.Release(ptr, 10000);
+  EXPECT_GT(pool.CachedBytes(), 0U);
+
+  // A request of the same size class gets the same buffer.
+  EXPECT_EQ(ptr, pool.Acquire(9000));
+  EXPECT_EQ(0U, pool.CachedBytes());
+
+  // A request of a different size class gets a new buffer.
+  void* other_ptr = pool.Acquire(100000);
+  EXPECT_NE(ptr, other_ptr);
+  EXPECT_EQ(3U, pool.NumAcquired());
+  EXPECT_EQ(2U, pool.NumAllocated());
+
+  pool.Release(ptr, 9000);
+  pool.Release(other_ptr, 100000);
+  pool.Clear();
+  EXPECT_EQ(0U, pool.CachedBytes());
+}
+
+TEST(BufferPool, MaxCachedBytes) {
+  const uint64_t max_cached_mb = FLAGS_buffer_pool_max_cached_mb;
+  FLAGS_buffer_pool_max_cached_mb = 1;
+  BufferPool pool;
+  void* ptr1 = pool.Acquire(Pow2(19));
+  void* ptr2 = pool.Acquire(Pow2(20));
+  pool.Release(ptr1, Pow2(19));
+  // Caching ptr2 would exceed the limit, so it is freed.
+  pool.Release(ptr2, Pow2(20));
+  EXPECT_EQ(Pow2(19), pool.CachedBytes());
+  FLAGS_buffer_pool_max_cached_mb = max_cached_mb;
+}
+
+TEST(PooledBuffer, Basic) {
+  const size_t n_allocated = BufferPool::GetInstance().NumAllocated();
+  uint64_t* data = nullptr;
+  {
+    PooledBuffer<uint64_t> buffer(1000);
+    ASSERT_EQ(1000U, buffer.size());
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      buffer[i] = i;
+    }
+    EXPECT_EQ(999U, buffer.Span()[999]);
+
+    // Moving transfers ownership of the buffer.
+    PooledBuffer<uint64_t> moved(std::move(buffer));
+    EXPECT_EQ(5U, moved[5]);
+    data = moved.data();
+  }
+  // The buffer was returned to the pool and is reused.
+  PooledBuffer<uint64_t> buffer(1000);
+  EXPECT_EQ(data, buffer.data());
+  EXPECT_EQ(n_allocated + 1, BufferPool::GetInstance().NumAllocated());
+}
+
+TEST(PooledBuffer, Scope) {
+  BufferPool pool;
+  const size_t n_allocated = BufferPool::GetInstance().NumAllocated();
+  {
+    BufferPool::Scope scope(&pool);
+    EXPECT_EQ(&pool, &BufferPool::Current());
+    PooledBuffer<uint64_t> buffer(1000);
+
+    // The chunks of a ParallelFor call, on any thread, draw from the pool of the scope.
+    TaskManager& task_manager = TaskManager::GetInstance();
+    std::vector<BufferPool*> chunk_pools(100);
+    task_manager.ParallelFor(chunk_pools.size(), [&](const TaskInfo& task_info) {
+      PooledBuffer<uint64_t> chunk_buffer(1000);
+      chunk_pools[task_info.start_idx] = &BufferPool::Current();
+    });
+    for (BufferPool* chunk_pool : chunk_pools) {
+      EXPECT_EQ(&pool, chunk_pool);
+    }
+  }
+  EXPECT_EQ(&BufferPool::GetInstance(), &BufferPool::Current());
+  EXPECT_EQ(101U, pool.NumAcquired());
+  EXPECT_GT(pool.CachedBytes(), 0U);
+  // The buffers were returned to the pool of the scope, not to the global pool.
+  EXPECT_EQ(n_allocated, BufferPool::GetInstance().NumAllocated());
+}
+
+}  // namespace
+}  // namespace starkware
@@ -60,6 +60,11 @@ size_t JsonValue::AsSizeT() const {
   return value_.asUInt();
 }
 
+bool JsonValue::AsBool() const {
+  AssertBool();
+  return value_.asBool();
+}
+
 size_t JsonValue::ArrayLength() const {
   AssertArray();
   return value_.size();
@@ -97,6 +102,11 @@ void JsonValue::AssertUint64() const {
   ASSERT_RELEASE(value_.isUInt64(), "Configuration at " + path_ + " is expected to be a uint64.");
 }
 
+void JsonValue::AssertBool() const {
+  ASSERT_RELEASE(!value_.isNull(), "Missing configuration value: " + path_ + ".");
+  ASSERT_RELEASE(value_.isBool(), "Configuration at " + path_ + " is expected to be a boolean.");
+}
+
 void JsonValue::AssertString() const {
   ASSERT_RELEASE(!value_.isNull(), "Missing configuration value: " + path_ + ".");
   ASSERT_RELEASE(value_.isString(), "Configuration at " + path_ + " is expected to be a string.");
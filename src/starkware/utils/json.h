@@ -49,6 +49,8 @@ class JsonValue {
 
   size_t AsSizeT() const;
 
+  bool AsBool() const;
+
   size_t ArrayLength() const;
 
   std::string AsString() const;
@@ -84,6 +86,11 @@ class JsonValue {
   */
   void AssertUint64() const;
 
+  /*
+    Fails if the current value is not a boolean.
+  */
+  void AssertBool() const;
+
   /*
     Fails if the current value is not a string.
   */
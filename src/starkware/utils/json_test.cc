@@ -84,6 +84,14 @@ TEST_F(JsonTest, AsSizeT) {
       HasSubstr("Configuration at /stark/fri/string/ is expected to be an integer."));
 }
 
+TEST_F(JsonTest, AsBool) {
+  EXPECT_TRUE(root["stark"]["fri"]["bools"][0].AsBool());
+  EXPECT_FALSE(root["stark"]["fri"]["bools"][1].AsBool());
+  EXPECT_ASSERT(
+      root["stark"]["fri"]["int"].AsBool(),
+      HasSubstr("Configuration at /stark/fri/int/ is expected to be a boolean."));
+}
+
 TEST_F(JsonTest, ArrayLength) {
   EXPECT_ASSERT(
       root["stark"]["fri"]["int"].ArrayLength(),
@@ -0,0 +1,190 @@
+#include "starkware/utils/large_buffer_allocator.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include "glog/logging.h"
+
+#include "starkware/math/math.h"
+#include "starkware/utils/task_manager.h"
+
+DEFINE_string(
+    huge_pages, "none",
+    "Huge page policy for large buffers (LDE cosets, Merkle trees): none, transparent or "
+    "explicit.");
+
+static bool ValidateHugePages(const char* /*flagname*/, const std::string& value) {
+  return value == "none" || value == "transparent" || value == "explicit";
+}
+DEFINE_validator(huge_pages, &ValidateHugePages);
+
+DEFINE_bool(
+    parallel_first_touch, false,
+    "Touch the pages of large buffers from the thread pool on allocation, so that they are placed "
+    "on the NUMA nodes of the threads that process them.");
+
+namespace starkware {
+
+namespace {
+
+constexpr size_t kHugePageSize = size_t{1} << 21;
+
+/*
+  The size of the memory mapping of a large buffer of n_bytes bytes, unless it is mapped from the
+  explicit huge page pool. Rounding to a multiple of the transparent huge page size keeps the
+  mapping valid for munmap() regardless of whether it is backed by huge pages.
+*/
+size_t MappingSize(size_t n_bytes) { return DivCeil(n_bytes, kHugePageSize) * kHugePageSize; }
+
+/*
+  Returns the page size of the explicit huge page pool (Hugepagesize in /proc/meminfo), which may
+  be larger than kHugePageSize (e.g., 1 GiB). Returns kHugePageSize if it is not available.
+*/
+size_t ExplicitHugePageSize() {
+  static const size_t kExplicitHugePageSize = []() {
+    std::ifstream file("/proc/meminfo");
+    std::string line;
+    while (std::getline(file, line)) {
+      const std::string key = "Hugepagesize:";
+      if (line.compare(0, key.size(), key) != 0) {
+        continue;
+      }
+      size_t size_kb = 0;
+      std::istringstream(line.substr(key.size())) >> size_kb;
+      if (size_kb > 0) {
+        return size_kb * 1024;
+      }
+    }
+    return kHugePageSize;
+  }();
+  return kExplicitHugePageSize;
+}
+
+/*
+  The mapping sizes of the buffers that are mapped from the explicit huge page pool, by address.
+  These buffers are rounded to ExplicitHugePageSize(), and must be unmapped with the same size.
+  Intentionally leaked, since buffers may be freed during the destruction of static objects.
+*/
+std::mutex explicit_mappings_mutex;
+std::map<void*, size_t>& ExplicitMappings() {
+  static auto* explicit_mappings = new std::map<void*, size_t>();
+  return *explicit_mappings;
+}
+
+/*
+  Maps size bytes of anonymous memory, aligned to kHugePageSize. Returns nullptr on failure.
+*/
+void* MapAligned(size_t size) {
+  // Map an extra huge page, and unmap the unaligned head and the tail.
+  const size_t mapped_size = size + kHugePageSize;
+  void* ptr =
+      mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+  const auto addr = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t aligned_addr = DivCeil(addr, kHugePageSize) * kHugePageSize;
+  const size_t head = aligned_addr - addr;
+  if (head > 0) {
+    munmap(ptr, head);
+  }
+  munmap(reinterpret_cast<void*>(aligned_addr + size), kHugePageSize - head);
+  return reinterpret_cast<void*>(aligned_addr);
+}
+
+/*
+  Writes to every page of the buffer from the TaskManager threads. If the threads are pinned, the
+  pages of each NUMA node's block are touched (and hence placed) by the threads of that node.
+*/
+void FirstTouch(void* ptr, size_t size) {
+  static const auto kPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto* bytes = static_cast<volatile char*>(ptr);
+  TaskManager::GetInstance().ParallelForNodeAffine(
+      0, size / kPageSize,
+      [bytes](const TaskInfo& task_info) {
+        for (size_t page = task_info.start_idx; page < task_info.end_idx; ++page) {
+          bytes[page * kPageSize] = 0;
+        }
+      },
+      size / kPageSize);
+}
+
+}  // namespace
+
+void* AllocateLargeBuffer(size_t n_bytes) {
+  if (n_bytes < kLargeBufferThreshold) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, kLargeBufferAlignment, n_bytes == 0 ? 1 : n_bytes) != 0) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  size_t size = MappingSize(n_bytes);
+  void* ptr = nullptr;
+  if (FLAGS_huge_pages == "explicit") {
+    const size_t explicit_size = DivCeil(n_bytes, ExplicitHugePageSize()) * ExplicitHugePageSize();
+    ptr = mmap(
+        nullptr, explicit_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr == MAP_FAILED) {
+      VLOG(1) << "Failed to map " << explicit_size << " bytes of explicit huge pages. Falling "
+              << "back to transparent huge pages.";
+      ptr = nullptr;
+    } else {
+      size = explicit_size;
+      std::unique_lock<std::mutex> lock(explicit_mappings_mutex);
+      ExplicitMappings()[ptr] = size;
+    }
+  }
+  if (ptr == nullptr) {
+    ptr = MapAligned(size);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    if (FLAGS_huge_pages != "none") {
+      madvise(ptr, size, MADV_HUGEPAGE);
+    }
+  }
+
+  if (FLAGS_parallel_first_touch) {
+    FirstTouch(ptr, size);
+  }
+  return ptr;
+}
+
+void FreeLargeBuffer(void* ptr, size_t n_bytes) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (n_bytes < kLargeBufferThreshold) {
+    free(ptr);  // NOLINT: memory allocated by posix_memalign.
+    return;
+  }
+  size_t size = MappingSize(n_bytes);
+  {
+    std::unique_lock<std::mutex> lock(explicit_mappings_mutex);
+    auto& explicit_mappings = ExplicitMappings();
+    const auto it = explicit_mappings.find(ptr);
+    if (it != explicit_mappings.end()) {
+      size = it->second;
+      explicit_mappings.erase(it);
+    }
+  }
+  if (munmap(ptr, size) != 0) {
+    LOG(ERROR) << "Failed to unmap a large buffer of " << size
+               << " bytes: " << std::strerror(errno);
+  }
+}
+
+}  // namespace starkware
@@ -0,0 +1,90 @@
+#ifndef STARKWARE_UTILS_LARGE_BUFFER_ALLOCATOR_H_
+#define STARKWARE_UTILS_LARGE_BUFFER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "gflags/gflags.h"
+
+DECLARE_string(huge_pages);
+DECLARE_bool(parallel_first_touch);
+
+namespace starkware {
+
+/*
+  Alignment (in bytes) of every buffer allocated by LargeBufferAllocator. This is the size of a
+  cache line, and is enough for aligned SIMD loads and stores.
+*/
+constexpr size_t kLargeBufferAlignment = 64;
+
+/*
+  Buffers of at least kLargeBufferThreshold bytes are mapped directly from the OS, in multiples of
+  the huge page size. Smaller buffers are allocated from the heap.
+*/
+constexpr size_t kLargeBufferThreshold = size_t{1} << 21;
+
+/*
+  Allocates a buffer of n_bytes bytes, aligned to kLargeBufferAlignment.
+  Large buffers are placed according to the following flags:
+  * --huge_pages: "none" (the default) uses regular pages. "transparent" asks the kernel to back the
+    buffer with transparent huge pages. "explicit" maps the buffer from the pre-reserved huge page
+    pool (hugetlbfs), and falls back to transparent huge pages if the pool is exhausted.
+  * --parallel_first_touch: touches the pages of the buffer from the TaskManager threads, using the
+    same partitioning as ParallelFor, so that on NUMA machines each page is placed on the node of
+    the thread that is likely to process it.
+*/
+void* AllocateLargeBuffer(size_t n_bytes);
+
+/*
+  Frees a buffer allocated by AllocateLargeBuffer(n_bytes).
+*/
+void FreeLargeBuffer(void* ptr, size_t n_bytes);
+
+/*
+  A stateless allocator for big buffers, such as LDE cosets and Merkle tree nodes. See
+  AllocateLargeBuffer() for details.
+
+  Usage:
+    std::vector<BaseFieldElement, LargeBufferAllocator<BaseFieldElement>> vec(size);
+*/
+template <typename T>
+class LargeBufferAllocator {
+ public:
+  using value_type = T;
+
+  LargeBufferAllocator() = default;
+
+  template <typename U>
+  constexpr LargeBufferAllocator(const LargeBufferAllocator<U>& /*other*/) noexcept {}  // NOLINT
+
+  T* allocate(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(AllocateLargeBuffer(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept { FreeLargeBuffer(ptr, n * sizeof(T)); }
+};
+
+template <typename T, typename U>
+bool operator==(const LargeBufferAllocator<T>& /*lhs*/, const LargeBufferAllocator<U>& /*rhs*/) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const LargeBufferAllocator<T>& /*lhs*/, const LargeBufferAllocator<U>& /*rhs*/) {
+  return false;
+}
+
+/*
+  A vector whose buffer is allocated by LargeBufferAllocator.
+*/
+template <typename T>
+using LargeBufferVector = std::vector<T, LargeBufferAllocator<T>>;
+
+}  // namespace starkware
+
+#endif  // STARKWARE_UTILS_LARGE_BUFFER_ALLOCATOR_H_
@@ -0,0 +1,71 @@
+#include "starkware/utils/large_buffer_allocator.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace starkware {
+namespace {
+
+/*
+  Allocates a vector of the given size, checks its alignment and that it can be written and read.
+*/
+void TestAllocation(size_t size) {
+  LargeBufferVector<uint64_t> vec(size);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(vec.data()) % kLargeBufferAlignment);
+  for (size_t i = 0; i < size; ++i) {
+    EXPECT_EQ(0U, vec[i]);
+    vec[i] = i;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    ASSERT_EQ(i, vec[i]);
+  }
+}
+
+class LargeBufferAllocatorTest : public ::testing::TestWithParam<std::string> {
+ public:
+  LargeBufferAllocatorTest() : huge_pages_(FLAGS_huge_pages) { FLAGS_huge_pages = GetParam(); }
+  ~LargeBufferAllocatorTest() override { FLAGS_huge_pages = huge_pages_; }
+
+  LargeBufferAllocatorTest(const LargeBufferAllocatorTest&) = delete;
+  LargeBufferAllocatorTest& operator=(const LargeBufferAllocatorTest&) = delete;
+  LargeBufferAllocatorTest(LargeBufferAllocatorTest&&) = delete;
+  LargeBufferAllocatorTest& operator=(LargeBufferAllocatorTest&&) = delete;
+
+ private:
+  const std::string huge_pages_;
+};
+
+TEST_P(LargeBufferAllocatorTest, SmallBuffer) {
+  TestAllocation(0);
+  TestAllocation(1);
+  TestAllocation(1000);
+}
+
+TEST_P(LargeBufferAllocatorTest, LargeBuffer) {
+  TestAllocation(kLargeBufferThreshold / sizeof(uint64_t));
+  TestAllocation(kLargeBufferThreshold / sizeof(uint64_t) * 3 + 5);
+}
+
+TEST_P(LargeBufferAllocatorTest, ParallelFirstTouch) {
+  FLAGS_parallel_first_touch = true;
+  TestAllocation(kLargeBufferThreshold / sizeof(uint64_t) * 2 + 1);
+  FLAGS_parallel_first_touch = false;
+}
+
+TEST_P(LargeBufferAllocatorTest, CopyAndResize) {
+  LargeBufferVector<uint64_t> vec(10, 7);
+  vec.resize(kLargeBufferThreshold);
+  EXPECT_EQ(7U, vec[9]);
+  EXPECT_EQ(0U, vec.back());
+  const LargeBufferVector<uint64_t> copy = vec;
+  EXPECT_EQ(vec, copy);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    HugePages, LargeBufferAllocatorTest, ::testing::Values("none", "transparent", "explicit"));
+
+}  // namespace
+}  // namespace starkware
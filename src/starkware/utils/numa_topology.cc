@@ -0,0 +1,140 @@
+#include "starkware/utils/numa_topology.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "starkware/error_handling/error_handling.h"
+
+namespace starkware {
+
+NumaTopology::NumaTopology(std::vector<std::vector<size_t>> node_cpus)
+    : node_cpus_(std::move(node_cpus)) {
+  ASSERT_RELEASE(!node_cpus_.empty(), "A NUMA topology must have at least one node.");
+  for (const auto& cpus : node_cpus_) {
+    ASSERT_RELEASE(!cpus.empty(), "A NUMA node must have at least one CPU.");
+  }
+}
+
+NumaTopology NumaTopology::Detect() {
+  std::vector<std::vector<size_t>> node_cpus;
+  for (size_t node = 0;; ++node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string cpu_list;
+    if (!file || !std::getline(file, cpu_list)) {
+      break;
+    }
+    std::vector<size_t> cpus = ParseCpuList(cpu_list);
+    // Memory-only nodes have no CPUs.
+    if (!cpus.empty()) {
+      node_cpus.push_back(std::move(cpus));
+    }
+  }
+
+  if (node_cpus.empty()) {
+    std::vector<size_t> cpus = GetCurrentThreadAffinity();
+    if (cpus.empty()) {
+      cpus.push_back(0);
+    }
+    node_cpus.push_back(std::move(cpus));
+  }
+  return NumaTopology(std::move(node_cpus));
+}
+
+size_t NumaTopology::NodeOfCpu(size_t cpu) const {
+  for (size_t node = 0; node < node_cpus_.size(); ++node) {
+    if (std::find(node_cpus_[node].begin(), node_cpus_[node].end(), cpu) !=
+        node_cpus_[node].end()) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+std::vector<size_t> NumaTopology::AssignCpus(
+    size_t n_threads, const std::string& affinity) const {
+  std::vector<size_t> cpu_order;
+  if (affinity == "compact") {
+    for (const auto& cpus : node_cpus_) {
+      cpu_order.insert(cpu_order.end(), cpus.begin(), cpus.end());
+    }
+  } else if (affinity == "scatter") {
+    const size_t max_node_size =
+        std::max_element(
+            node_cpus_.begin(), node_cpus_.end(),
+            [](const auto& a, const auto& b) { return a.size() < b.size(); })
+            ->size();
+    for (size_t i = 0; i < max_node_size; ++i) {
+      for (const auto& cpus : node_cpus_) {
+        if (i < cpus.size()) {
+          cpu_order.push_back(cpus[i]);
+        }
+      }
+    }
+  } else {
+    cpu_order = ParseCpuList(affinity);
+  }
+  ASSERT_RELEASE(!cpu_order.empty(), "Invalid thread affinity: '" + affinity + "'.");
+
+  std::vector<size_t> assignment;
+  assignment.reserve(n_threads);
+  for (size_t i = 0; i < n_threads; ++i) {
+    assignment.push_back(cpu_order[i % cpu_order.size()]);
+  }
+  return assignment;
+}
+
+std::vector<size_t> ParseCpuList(const std::string& cpu_list) {
+  std::vector<size_t> cpus;
+  std::stringstream stream(cpu_list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    const size_t dash = range.find('-');
+    try {
+      const size_t first = std::stoul(range.substr(0, dash));
+      const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+      ASSERT_RELEASE(first <= last, "Invalid CPU range: '" + range + "'.");
+      for (size_t cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::logic_error&) {
+      THROW_STARKWARE_EXCEPTION("Invalid CPU list: '" + cpu_list + "'.");
+    }
+  }
+  return cpus;
+}
+
+std::vector<size_t> GetCurrentThreadAffinity() {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  std::vector<size_t> cpus;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0) {
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<size_t>& cpus) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (size_t cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+}
+
+}  // namespace starkware
@@ -0,0 +1,62 @@
+#ifndef STARKWARE_UTILS_NUMA_TOPOLOGY_H_
+#define STARKWARE_UTILS_NUMA_TOPOLOGY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace starkware {
+
+/*
+  The NUMA nodes of the machine, and the CPUs of each node.
+*/
+class NumaTopology {
+ public:
+  explicit NumaTopology(std::vector<std::vector<size_t>> node_cpus);
+
+  /*
+    Reads the topology from /sys/devices/system/node. If it is not available, returns a single node
+    with all the CPUs the process may run on.
+  */
+  static NumaTopology Detect();
+
+  size_t NumNodes() const { return node_cpus_.size(); }
+
+  const std::vector<size_t>& NodeCpus(size_t node) const { return node_cpus_.at(node); }
+
+  /*
+    Returns the node of the given CPU, or 0 if the CPU is unknown.
+  */
+  size_t NodeOfCpu(size_t cpu) const;
+
+  /*
+    Assigns a CPU to each of n_threads threads, according to affinity:
+    * "compact": fills the CPUs of node 0 first, then node 1, and so on.
+    * "scatter": assigns the threads to the nodes in a round-robin manner.
+    * A CPU list, such as "0-7,16-23": assigns the CPUs in the given order.
+    If there are more threads than CPUs, the assignment wraps around.
+  */
+  std::vector<size_t> AssignCpus(size_t n_threads, const std::string& affinity) const;
+
+ private:
+  std::vector<std::vector<size_t>> node_cpus_;
+};
+
+/*
+  Parses a CPU list in the format used by Linux (e.g., "0-3,8,10-11").
+*/
+std::vector<size_t> ParseCpuList(const std::string& cpu_list);
+
+/*
+  Returns the CPUs the current thread may run on.
+*/
+std::vector<size_t> GetCurrentThreadAffinity();
+
+/*
+  Restricts the current thread to the given CPUs. Returns false on failure.
+*/
+bool SetCurrentThreadAffinity(const std::vector<size_t>& cpus);
+
+}  // namespace starkware
+
+#endif  // STARKWARE_UTILS_NUMA_TOPOLOGY_H_
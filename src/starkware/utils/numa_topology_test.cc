@@ -0,0 +1,57 @@
+#include "starkware/utils/numa_topology.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "starkware/error_handling/test_utils.h"
+
+namespace starkware {
+namespace {
+
+using testing::ElementsAre;
+using testing::HasSubstr;
+
+TEST(NumaTopology, ParseCpuList) {
+  EXPECT_THAT(ParseCpuList("0-3,8,10-11"), ElementsAre(0, 1, 2, 3, 8, 10, 11));
+  EXPECT_THAT(ParseCpuList("5"), ElementsAre(5));
+  EXPECT_THAT(ParseCpuList(""), ElementsAre());
+  EXPECT_ASSERT(ParseCpuList("3-1"), HasSubstr("Invalid CPU range"));
+  EXPECT_ASSERT(ParseCpuList("a-b"), HasSubstr("Invalid CPU list"));
+}
+
+TEST(NumaTopology, NodeOfCpu) {
+  const NumaTopology topology({{0, 1, 2, 3}, {4, 5, 6, 7}});
+  EXPECT_EQ(2U, topology.NumNodes());
+  EXPECT_EQ(0U, topology.NodeOfCpu(2));
+  EXPECT_EQ(1U, topology.NodeOfCpu(4));
+  EXPECT_EQ(0U, topology.NodeOfCpu(100));
+}
+
+TEST(NumaTopology, AssignCpus) {
+  const NumaTopology topology({{0, 1, 2, 3}, {4, 5, 6, 7}});
+  EXPECT_THAT(topology.AssignCpus(5, "compact"), ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(topology.AssignCpus(5, "scatter"), ElementsAre(0, 4, 1, 5, 2));
+  EXPECT_THAT(topology.AssignCpus(10, "compact"), ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 0, 1));
+  EXPECT_THAT(topology.AssignCpus(3, "6,2"), ElementsAre(6, 2, 6));
+  EXPECT_ASSERT(topology.AssignCpus(3, ""), HasSubstr("Invalid thread affinity"));
+}
+
+TEST(NumaTopology, Detect) {
+  const NumaTopology topology = NumaTopology::Detect();
+  ASSERT_GE(topology.NumNodes(), 1U);
+  for (size_t node = 0; node < topology.NumNodes(); ++node) {
+    EXPECT_FALSE(topology.NodeCpus(node).empty());
+  }
+}
+
+TEST(NumaTopology, ThreadAffinity) {
+  const std::vector<size_t> affinity = GetCurrentThreadAffinity();
+  ASSERT_FALSE(affinity.empty());
+  EXPECT_TRUE(SetCurrentThreadAffinity({affinity[0]}));
+  EXPECT_THAT(GetCurrentThreadAffinity(), ElementsAre(affinity[0]));
+  EXPECT_TRUE(SetCurrentThreadAffinity(affinity));
+  EXPECT_EQ(affinity, GetCurrentThreadAffinity());
+}
+
+}  // namespace
+}  // namespace starkware
@@ -1,5 +1,6 @@
 #include "starkware/utils/profiling.h"
 
+#include <atomic>
 #include <utility>
 
 #include "glog/logging.h"
@@ -16,6 +17,9 @@ constexpr int kVlog = 1;
 // Start time of the prover.
 auto program_start = std::chrono::system_clock::now();
 
+// The ProfilingCollector that currently exists, if any.
+std::atomic<ProfilingCollector*> active_collector = nullptr;
+
 /*
   Appends the duration of the phase to a given output stream.
 */
@@ -54,13 +58,18 @@ ProfilingBlock::~ProfilingBlock() {
 }
 
 void ProfilingBlock::CloseBlock() {
+  auto now = std::chrono::system_clock::now();
+  ProfilingCollector* collector = active_collector;
+  if (collector != nullptr && !closed_) {
+    collector->Add(description_, now - start_time_);
+  }
   if (FLAGS_v < kVlog) {
+    closed_ = true;
     return;
   }
   ASSERT_RELEASE(!closed_, "ProfilingBlock.CloseBlock() called twice.");
 
   std::stringstream os;
-  auto now = std::chrono::system_clock::now();
 
   // Print the duration since the start time of the prover (only if not prepending the log prefix to
   // the start of each log line).
@@ -75,4 +84,24 @@ void ProfilingBlock::CloseBlock() {
   closed_ = true;
 }
 
+ProfilingCollector::ProfilingCollector() {
+  ProfilingCollector* expected = nullptr;
+  ASSERT_RELEASE(
+      active_collector.compare_exchange_strong(expected, this),
+      "Only one ProfilingCollector may exist at a time.");
+}
+
+ProfilingCollector::~ProfilingCollector() { active_collector = nullptr; }
+
+std::map<std::string, std::chrono::duration<double>> ProfilingCollector::Durations() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return durations_;
+}
+
+void ProfilingCollector::Add(
+    const std::string& description, std::chrono::duration<double> duration) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  durations_[description] += duration;
+}
+
 }  // namespace starkware
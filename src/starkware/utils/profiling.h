@@ -2,6 +2,8 @@
 #define STARKWARE_UTILS_PROFILING_H_
 
 #include <chrono>
+#include <map>
+#include <mutex>
 #include <string>
 
 namespace starkware {
@@ -49,6 +51,36 @@ class ProfilingBlock {
   bool closed_ = false;
 };
 
+/*
+  Collects the total duration of the ProfilingBlocks that are closed while the collector exists, by
+  description, regardless of the verbosity level. At most one collector may exist at a time.
+
+  This is used, for example, by benchmarks that report the time of each stage of the prover.
+*/
+class ProfilingCollector {
+ public:
+  ProfilingCollector();
+  ~ProfilingCollector();
+
+  ProfilingCollector(const ProfilingCollector&) = delete;
+  ProfilingCollector& operator=(const ProfilingCollector&) = delete;
+  ProfilingCollector(ProfilingCollector&& other) = delete;
+  ProfilingCollector& operator=(ProfilingCollector&& other) = delete;
+
+  /*
+    Returns the total duration of the blocks of each description.
+  */
+  std::map<std::string, std::chrono::duration<double>> Durations() const;
+
+ private:
+  friend class ProfilingBlock;
+
+  void Add(const std::string& description, std::chrono::duration<double> duration);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, std::chrono::duration<double>> durations_;
+};
+
 }  // namespace starkware
 
 #endif  // STARKWARE_UTILS_PROFILING_H_
@@ -20,5 +20,25 @@ TEST(Profiling, DoubleClose) {
   FLAGS_v = 0;
 }
 
+TEST(Profiling, Collector) {
+  {
+    ProfilingBlock profiling_block("not collected");
+  }
+  ProfilingCollector collector;
+  EXPECT_ASSERT(ProfilingCollector(), HasSubstr("Only one ProfilingCollector"));
+  for (size_t i = 0; i < 2; ++i) {
+    ProfilingBlock profiling_block("test block");
+  }
+  ProfilingBlock profiling_block("other block");
+  profiling_block.CloseBlock();
+  ProfilingBlock open_block("open block");
+
+  const auto durations = collector.Durations();
+  EXPECT_EQ(2U, durations.size());
+  EXPECT_EQ(1U, durations.count("test block"));
+  EXPECT_EQ(1U, durations.count("other block"));
+  EXPECT_GE(durations.at("test block").count(), 0);
+}
+
 }  // namespace
 }  // namespace starkware
@@ -0,0 +1,92 @@
+#include "starkware/utils/task_graph.h"
+
+namespace starkware {
+
+TaskGraph::Task TaskGraph::Add(std::function<void()> func, const std::vector<Task>& dependencies) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const size_t index = nodes_.size();
+  Node& node = nodes_.emplace_back();
+  node.func = std::move(func);
+  for (const Task& dependency : dependencies) {
+    // Since a task may only depend on tasks that were added before it, the graph has no cycles.
+    ASSERT_RELEASE(dependency.index_ < index, "Invalid dependency.");
+    Node& dependency_node = nodes_[dependency.index_];
+    if (dependency_node.done) {
+      node.failed |= dependency_node.failed;
+    } else {
+      dependency_node.successors.push_back(index);
+      ++node.n_pending_dependencies;
+    }
+  }
+  if (node.n_pending_dependencies == 0) {
+    ready_.push_back(index);
+  }
+  return Task(index);
+}
+
+size_t TaskGraph::NumTasks() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return nodes_.size();
+}
+
+void TaskGraph::Run() {
+  // Each thread runs ready tasks until there are none. A task that becomes ready is pushed by the
+  // thread that completed its last dependency, which is still draining, so no task is left behind.
+  task_manager_->ParallelFor(
+      task_manager_->GetNumThreads(), [this](const TaskInfo& /*task_info*/) { Drain(); });
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  ASSERT_RELEASE(n_done_ == nodes_.size(), "Not all the tasks of the graph were executed.");
+  if (eptr_ != nullptr) {
+    std::rethrow_exception(eptr_);
+  }
+}
+
+void TaskGraph::Drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!ready_.empty()) {
+    const size_t index = ready_.back();
+    ready_.pop_back();
+    Node& node = nodes_[index];
+    if (node.failed) {
+      // A dependency failed, skip the task.
+      Complete(index, true);
+      continue;
+    }
+
+    // Release the function after running it, as it may hold resources.
+    std::function<void()> func = std::move(node.func);
+    lock.unlock();
+    bool failed = false;
+    try {
+      func();
+    } catch (...) {
+      failed = true;
+      lock.lock();
+      if (eptr_ == nullptr) {
+        eptr_ = std::current_exception();
+      }
+      lock.unlock();
+    }
+    func = nullptr;
+    lock.lock();
+    Complete(index, failed);
+  }
+}
+
+void TaskGraph::Complete(size_t index, bool failed) {
+  Node& node = nodes_[index];
+  node.done = true;
+  node.failed = failed;
+  ++n_done_;
+  for (size_t successor : node.successors) {
+    Node& successor_node = nodes_[successor];
+    successor_node.failed |= failed;
+    if (--successor_node.n_pending_dependencies == 0) {
+      ready_.push_back(successor);
+    }
+  }
+  node.successors.clear();
+}
+
+}  // namespace starkware
@@ -0,0 +1,152 @@
+#ifndef STARKWARE_UTILS_TASK_GRAPH_H_
+#define STARKWARE_UTILS_TASK_GRAPH_H_
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "starkware/error_handling/error_handling.h"
+#include "starkware/utils/task_manager.h"
+
+namespace starkware {
+
+template <typename T>
+class TaskFuture;
+
+/*
+  A graph of tasks with dependencies, executed on the threads of a TaskManager.
+
+  Unlike a sequence of ParallelFor calls, where each stage waits for all the iterations of the
+  previous stage, a task starts as soon as the tasks it depends on are done. This allows independent
+  stages to overlap, e.g. hashing the LDE of one coset while the LDE of another coset is computed.
+
+  Usage:
+    TaskGraph graph;
+    TaskGraph::Task a = graph.Add([]() { ... });
+    TaskFuture<size_t> b = graph.AddWithResult([]() { return size_t(5); }, {a});
+    graph.Then(b, [](size_t value) { ... });
+    graph.Run();
+
+  Tasks may also be added by running tasks (a task added during Run() may depend on any task,
+  including completed ones). Tasks may call ParallelFor.
+
+  Run() returns once all the tasks are done. If a task throws, the tasks that depend on it (directly
+  or indirectly) are skipped, and the first exception is rethrown by Run().
+
+  Ready tasks are executed in LIFO order, so a task that became ready because its dependency was
+  just completed is usually executed next, by the same thread. In a graph of chains (e.g.,
+  LDE -> hash for every coset) this bounds the number of chains that are in progress at the same
+  time, and hence the memory held by their intermediate results.
+*/
+class TaskGraph {
+ public:
+  /*
+    A handle to a task in the graph.
+  */
+  class Task {
+   public:
+    Task() = default;
+
+   private:
+    friend class TaskGraph;
+    explicit Task(size_t index) : index_(index) {}
+
+    size_t index_ = 0;
+  };
+
+  explicit TaskGraph(TaskManager* task_manager = &TaskManager::GetInstance())
+      : task_manager_(task_manager) {}
+
+  /*
+    Adds a task that runs func after all the dependencies are done.
+  */
+  Task Add(std::function<void()> func, const std::vector<Task>& dependencies = {});
+
+  /*
+    Same as Add(), but func returns a value, which is available through the returned future once the
+    task is done.
+  */
+  template <typename Func>
+  TaskFuture<std::invoke_result_t<Func>> AddWithResult(
+      Func func, const std::vector<Task>& dependencies = {});
+
+  /*
+    Adds a continuation: a task that runs func with the value of future once it is available.
+    Returns a future for the value returned by func, or a Task if func returns void.
+  */
+  template <typename T, typename Func>
+  auto Then(const TaskFuture<T>& future, Func func);
+
+  /*
+    Runs all the tasks of the graph, and returns when they are done. Should be called once.
+  */
+  void Run();
+
+  size_t NumTasks() const;
+
+ private:
+  struct Node {
+    std::function<void()> func;
+    size_t n_pending_dependencies = 0;
+    std::vector<size_t> successors;
+    bool done = false;
+    // Set if the task, or one of its dependencies, threw an exception.
+    bool failed = false;
+  };
+
+  /*
+    Runs ready tasks until there are no ready tasks.
+  */
+  void Drain();
+
+  /*
+    Marks a task as done and makes its successors ready if all their dependencies are done. Should
+    be called with mutex_ held.
+  */
+  void Complete(size_t index, bool failed);
+
+  TaskManager* task_manager_;
+
+  mutable std::mutex mutex_;
+  // A deque keeps references to the nodes valid while tasks are added.
+  std::deque<Node> nodes_;
+  // Tasks whose dependencies are done, used as a stack.
+  std::vector<size_t> ready_;
+  size_t n_done_ = 0;
+  std::exception_ptr eptr_ = nullptr;
+};
+
+/*
+  The value of a task of a TaskGraph. The value may be read once the task is done, i.e., by the
+  tasks that depend on it or after TaskGraph::Run() returned.
+*/
+template <typename T>
+class TaskFuture {
+ public:
+  TaskGraph::Task GetTask() const { return task_; }
+
+  const T& Get() const {
+    ASSERT_RELEASE(value_->has_value(), "The value of the task is not available yet.");
+    return **value_;
+  }
+
+ private:
+  friend class TaskGraph;
+  TaskFuture(TaskGraph::Task task, std::shared_ptr<std::optional<T>> value)
+      : task_(task), value_(std::move(value)) {}
+
+  TaskGraph::Task task_;
+  std::shared_ptr<std::optional<T>> value_;
+};
+
+}  // namespace starkware
+
+#include "starkware/utils/task_graph.inl"
+
+#endif  // STARKWARE_UTILS_TASK_GRAPH_H_
@@ -0,0 +1,26 @@
+namespace starkware {
+
+template <typename Func>
+TaskFuture<std::invoke_result_t<Func>> TaskGraph::AddWithResult(
+    Func func, const std::vector<Task>& dependencies) {
+  using T = std::invoke_result_t<Func>;
+  static_assert(!std::is_void_v<T>, "Use Add() for tasks that do not return a value.");
+  auto value = std::make_shared<std::optional<T>>();
+  const Task task =
+      Add([value, func = std::move(func)]() mutable { value->emplace(func()); }, dependencies);
+  return TaskFuture<T>(task, std::move(value));
+}
+
+template <typename T, typename Func>
+auto TaskGraph::Then(const TaskFuture<T>& future, Func func) {
+  auto continuation = [value = future.value_, func = std::move(func)]() mutable {
+    return func(**value);
+  };
+  if constexpr (std::is_void_v<std::invoke_result_t<Func, const T&>>) {
+    return Add(std::move(continuation), {future.GetTask()});
+  } else {
+    return AddWithResult(std::move(continuation), {future.GetTask()});
+  }
+}
+
+}  // namespace starkware
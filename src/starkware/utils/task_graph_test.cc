@@ -0,0 +1,128 @@
+#include "starkware/utils/task_graph.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "starkware/error_handling/test_utils.h"
+
+namespace starkware {
+namespace {
+
+using testing::ElementsAre;
+using testing::HasSubstr;
+
+class TaskGraphTest : public ::testing::TestWithParam<bool> {
+ public:
+  TaskGraphTest() : manager(TaskManager::CreateInstanceForTesting(4, GetParam())) {}
+
+  TaskManager manager;
+};
+
+TEST_P(TaskGraphTest, Chain) {
+  TaskGraph graph(&manager);
+  std::vector<size_t> order;
+  std::mutex mutex;
+  TaskGraph::Task prev;
+  for (size_t i = 0; i < 10; ++i) {
+    auto func = [&order, &mutex, i]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      order.push_back(i);
+    };
+    prev = i == 0 ? graph.Add(func) : graph.Add(func, {prev});
+  }
+  graph.Run();
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
+TEST_P(TaskGraphTest, ManyChains) {
+  // Every chain computes (i + 1) * 2 in two dependent steps, and a final task sums the results.
+  constexpr size_t kNChains = 100;
+  TaskGraph graph(&manager);
+  std::vector<uint64_t> values(kNChains);
+  std::vector<TaskGraph::Task> last_steps;
+  for (size_t i = 0; i < kNChains; ++i) {
+    const TaskGraph::Task first = graph.Add([&values, i]() { values[i] = i + 1; });
+    last_steps.push_back(graph.Add([&values, i]() { values[i] *= 2; }, {first}));
+  }
+  uint64_t sum = 0;
+  graph.Add(
+      [&values, &sum]() {
+        for (uint64_t value : values) {
+          sum += value;
+        }
+      },
+      last_steps);
+  graph.Run();
+  EXPECT_EQ(kNChains * (kNChains + 1), sum);
+  EXPECT_EQ(2 * kNChains + 1, graph.NumTasks());
+}
+
+TEST_P(TaskGraphTest, Futures) {
+  TaskGraph graph(&manager);
+  const TaskFuture<uint64_t> a = graph.AddWithResult([]() { return UINT64_C(3); });
+  const TaskFuture<uint64_t> b = graph.AddWithResult([]() { return UINT64_C(4); });
+  const TaskFuture<uint64_t> sum =
+      graph.AddWithResult([&a, &b]() { return a.Get() + b.Get(); }, {a.GetTask(), b.GetTask()});
+  const TaskFuture<std::string> str =
+      graph.Then(sum, [](uint64_t value) { return std::to_string(value); });
+  std::string result;
+  graph.Then(str, [&result](const std::string& value) { result = value; });
+  EXPECT_ASSERT(sum.Get(), HasSubstr("not available"));
+  graph.Run();
+  EXPECT_EQ(7U, sum.Get());
+  EXPECT_EQ("7", str.Get());
+  EXPECT_EQ("7", result);
+}
+
+TEST_P(TaskGraphTest, AddDuringRun) {
+  TaskGraph graph(&manager);
+  std::atomic<uint64_t> sum = 0;
+  const TaskGraph::Task first = graph.Add([&]() {
+    for (uint64_t i = 0; i < 10; ++i) {
+      graph.Add([&sum, i]() { sum += i; });
+    }
+  });
+  graph.Add([&]() { graph.Add([&sum]() { sum += 100; }, {first}); }, {first});
+  graph.Run();
+  EXPECT_EQ(145U, sum);
+  EXPECT_EQ(13U, graph.NumTasks());
+}
+
+TEST_P(TaskGraphTest, NestedParallelFor) {
+  TaskGraph graph(&manager);
+  std::vector<std::atomic<uint64_t>> counts(10);
+  std::vector<TaskGraph::Task> tasks;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    tasks.push_back(graph.Add([this, &counts, i]() {
+      manager.ParallelFor(100, [&counts, i](const TaskInfo& task_info) {
+        counts[i] += task_info.end_idx - task_info.start_idx;
+      });
+    }));
+  }
+  graph.Run();
+  for (const auto& count : counts) {
+    EXPECT_EQ(100U, count);
+  }
+}
+
+TEST_P(TaskGraphTest, Exception) {
+  TaskGraph graph(&manager);
+  bool dependent_ran = false;
+  bool independent_ran = false;
+  const TaskGraph::Task failing = graph.Add([]() { THROW_STARKWARE_EXCEPTION("Task failed."); });
+  const TaskGraph::Task dependent = graph.Add([&]() { dependent_ran = true; }, {failing});
+  graph.Add([&]() { dependent_ran = true; }, {dependent});
+  graph.Add([&]() { independent_ran = true; });
+  EXPECT_ASSERT(graph.Run(), HasSubstr("Task failed."));
+  EXPECT_FALSE(dependent_ran);
+  EXPECT_TRUE(independent_ran);
+}
+
+INSTANTIATE_TEST_CASE_P(, TaskGraphTest, ::testing::Bool());
+
+}  // namespace
+}  // namespace starkware
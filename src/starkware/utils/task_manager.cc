@@ -1,52 +1,431 @@
 #include "starkware/utils/task_manager.h"
 
+#include <time.h>
+
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
 #include <utility>
 
 #include "glog/logging.h"
+#include "third_party/jsoncpp/json/json.h"
 
 #include "starkware/math/math.h"
+#include "starkware/utils/numa_topology.h"
+#include "starkware/utils/work_stealing_deque.h"
 
 DEFINE_uint32(n_threads, std::thread::hardware_concurrency(), "Number of threads to use.");
 
+DEFINE_bool(
+    work_stealing, true,
+    "Schedule tasks with per-thread work-stealing deques rather than with a single global queue.");
+
+DEFINE_string(
+    thread_affinity, "none",
+    "Pinning of the task manager threads to CPUs: none, compact (fill the NUMA nodes one after the "
+    "other), scatter (round-robin over the NUMA nodes), or a CPU list such as 0-7,16-23.");
+
+DEFINE_uint32(
+    idle_spin_us, 50,
+    "With the work-stealing backend, the time in microseconds that a thread that ran out of tasks "
+    "keeps looking for new tasks before it goes to sleep. 0 means go to sleep right away.");
+
+DEFINE_string(
+    task_manager_stats_file, "",
+    "If not empty, scheduling statistics of the task manager are collected and written to this "
+    "file, as JSON, at exit.");
+
 namespace starkware {
 
-TaskManager::TaskManager(const size_t n_threads) {
+namespace {
+
+uint64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+/*
+  The statistics of a single thread. Only the thread itself writes them (except for the shared
+  entry of the threads that are not part of the pool).
+*/
+struct TaskManager::WorkerStats {
+  std::atomic<uint64_t> busy_ns{0};
+  std::atomic<uint64_t> idle_ns{0};
+  std::atomic<uint64_t> wait_ns{0};
+  std::atomic<uint64_t> n_tasks{0};
+  std::atomic<uint64_t> n_steals{0};
+};
+
+class TaskManager::CallTimer {
+ public:
+  explicit CallTimer(TaskManager* task_manager)
+      : task_manager_(task_manager),
+        enabled_(task_manager->stats_enabled_.load(std::memory_order_relaxed)),
+        start_ns_(enabled_ ? NowNs() : 0),
+        depth_(parallel_for_depth + 1),
+        tag_(stats_tag),
+        context_(task_context) {}
+
+  ~CallTimer() {
+    if (!enabled_) {
+      return;
+    }
+    const uint64_t wall_ns = NowNs() - start_ns_;
+    std::unique_lock<std::mutex> lock(task_manager_->stats_mutex_);
+    CallSiteStats& stats = task_manager_->call_site_stats_[std::string(tag_)];
+    stats.n_calls++;
+    stats.n_chunks += n_chunks_;
+    stats.wall_ns += wall_ns;
+    stats.chunk_ns += chunk_ns.load();
+    if (task_manager_->n_calls_per_depth_.size() <= depth_) {
+      task_manager_->n_calls_per_depth_.resize(depth_ + 1);
+    }
+    task_manager_->n_calls_per_depth_[depth_]++;
+  }
+
+  CallTimer(const CallTimer&) = delete;
+  CallTimer& operator=(const CallTimer&) = delete;
+
+  void SetNumChunks(uint64_t n_chunks) { n_chunks_ = n_chunks; }
+  size_t Depth() const { return depth_; }
+  std::string_view Tag() const { return tag_; }
+  void* Context() const { return context_; }
+
+  // The total time of the chunks of the call.
+  std::atomic<uint64_t> chunk_ns{0};
+
+ private:
+  TaskManager* const task_manager_;
+  const bool enabled_;
+  const uint64_t start_ns_;
+  const size_t depth_;
+  const std::string_view tag_;
+  void* const context_;
+  uint64_t n_chunks_ = 0;
+};
+
+/*
+  Also makes the chunk, and the nested ParallelFor calls of the chunk, inherit the depth, the tag
+  and the task context of the call of the chunk.
+*/
+class TaskManager::ChunkTimer {
+ public:
+  ChunkTimer(TaskManager* task_manager, CallTimer* call_timer)
+      : call_timer_(call_timer),
+        prev_depth_(parallel_for_depth),
+        prev_tag_(stats_tag),
+        prev_context_(task_context),
+        stats_(
+            task_manager->stats_enabled_.load(std::memory_order_relaxed)
+                ? &task_manager->CurrentWorkerStats()
+                : nullptr) {
+    parallel_for_depth = call_timer->Depth();
+    stats_tag = call_timer->Tag();
+    task_context = call_timer->Context();
+    if (stats_ != nullptr) {
+      start_ns_ = NowNs();
+      start_wait_ns_ = stats_->wait_ns;
+      n_running_chunks++;
+    }
+  }
+
+  ~ChunkTimer() {
+    parallel_for_depth = prev_depth_;
+    stats_tag = prev_tag_;
+    task_context = prev_context_;
+    if (stats_ == nullptr) {
+      return;
+    }
+    // The time the thread waited for nested calls is not counted.
+    const uint64_t elapsed_ns = NowNs() - start_ns_ - (stats_->wait_ns - start_wait_ns_);
+    stats_->n_tasks++;
+    // The time of a chunk that runs while an outer chunk waits is counted as part of the outer
+    // chunk.
+    if (--n_running_chunks == 0) {
+      stats_->busy_ns += elapsed_ns;
+    }
+    call_timer_->chunk_ns += elapsed_ns;
+  }
+
+  ChunkTimer(const ChunkTimer&) = delete;
+  ChunkTimer& operator=(const ChunkTimer&) = delete;
+
+ private:
+  CallTimer* const call_timer_;
+  const size_t prev_depth_;
+  const std::string_view prev_tag_;
+  void* const prev_context_;
+  WorkerStats* const stats_;
+  uint64_t start_ns_ = 0;
+  uint64_t start_wait_ns_ = 0;
+};
+
+class TaskManager::IdleTimer {
+ public:
+  /*
+    waiting should be true if the thread waits for the chunks of its own ParallelFor call, and
+    false if it has nothing to do.
+  */
+  IdleTimer(TaskManager* task_manager, bool waiting)
+      : stats_(
+            task_manager->stats_enabled_.load(std::memory_order_relaxed)
+                ? &task_manager->CurrentWorkerStats()
+                : nullptr),
+        waiting_(waiting),
+        start_ns_(stats_ == nullptr ? 0 : NowNs()) {}
+
+  ~IdleTimer() {
+    if (stats_ != nullptr) {
+      (waiting_ ? stats_->wait_ns : stats_->idle_ns) += NowNs() - start_ns_;
+    }
+  }
+
+  IdleTimer(const IdleTimer&) = delete;
+  IdleTimer& operator=(const IdleTimer&) = delete;
+
+ private:
+  WorkerStats* const stats_;
+  const bool waiting_;
+  const uint64_t start_ns_;
+};
+
+void TaskManager::StatsMutex::LockWithStats() {
+  const uint64_t start_ns = NowNs();
+  mutex_.lock();
+  lock_time_ns_ = NowNs();
+  locked_with_stats_ = true;
+  n_acquisitions++;
+  wait_ns += lock_time_ns_ - start_ns;
+}
+
+void TaskManager::StatsMutex::UnlockWithStats() {
+  hold_ns += NowNs() - lock_time_ns_;
+  locked_with_stats_ = false;
+  mutex_.unlock();
+}
+
+/*
+  The state shared by the chunks of a single ParallelFor call, in the work-stealing backend.
+  It lives on the stack of the thread that invoked ParallelFor.
+*/
+struct TaskManager::WorkStealingTaskGroup {
+  const void* func;
+  RunRangeFn run_range;
+  uint64_t max_chunk_size_for_lambda;
+  std::atomic<size_t> n_pending_chunks;
+  std::mutex exception_mutex;
+  std::exception_ptr eptr = nullptr;
+  // The job of the ParallelFor call, or nullptr.
+  TaskJob* job = nullptr;
+  CallTimer* call_timer = nullptr;
+};
+
+/*
+  A range of iterations of a ParallelFor call, executed by a single thread.
+*/
+struct TaskManager::WorkStealingChunk {
+  WorkStealingTaskGroup* group;
+  uint64_t start_idx;
+  uint64_t end_idx;
+};
+
+/*
+  The scheduling state of a single thread of the pool.
+*/
+struct TaskManager::WorkerState {
+  explicit WorkerState(size_t chunk_stack_capacity) : chunk_stack(chunk_stack_capacity) {}
+
+  WorkStealingDeque<WorkStealingChunk> deque;
+
+  // Preallocated storage for the chunks of the ParallelFor calls made by this thread. Since nested
+  // calls return in reverse order, it is used as a stack.
+  std::vector<WorkStealingChunk> chunk_stack;
+  size_t chunk_stack_size = 0;
+};
+
+TaskManager::TaskManager(
+    const size_t n_threads, bool work_stealing, const std::string& thread_affinity)
+    : work_stealing_(work_stealing),
+      owner_thread_id_(std::this_thread::get_id()),
+      idle_spin_ns_(
+          std::chrono::nanoseconds(std::chrono::microseconds(FLAGS_idle_spin_us)).count()) {
   ASSERT_RELEASE(n_threads > 0, "Number of threads must be at least 1.");
 
+  // Assign a CPU (and hence a NUMA node) to each thread.
+  std::vector<size_t> worker_cpus;
+  worker_nodes_.assign(n_threads, 0);
+  if (thread_affinity != "none") {
+    const NumaTopology topology = NumaTopology::Detect();
+    worker_cpus = topology.AssignCpus(n_threads, thread_affinity);
+    n_numa_nodes_ = topology.NumNodes();
+    for (size_t i = 0; i < n_threads; i++) {
+      worker_nodes_[i] = topology.NodeOfCpu(worker_cpus[i]);
+    }
+    // The thread that created the TaskManager is worker 0. Its original affinity is restored by
+    // the destructor.
+    owner_affinity_ = GetCurrentThreadAffinity();
+    LOG_IF(WARNING, !SetCurrentThreadAffinity({worker_cpus[0]}))
+        << "Failed to pin thread 0 to CPU " << worker_cpus[0] << ".";
+  }
+  node_n_threads_.assign(n_numa_nodes_, 0);
+  for (size_t node : worker_nodes_) {
+    node_n_threads_[node]++;
+  }
+  node_chunks_.resize(n_numa_nodes_);
+
   SetWorkerIdForCurrentThread(0);
+  for (size_t i = 0; i <= n_threads; i++) {
+    worker_stats_.push_back(std::make_unique<WorkerStats>());
+  }
+  if (work_stealing_) {
+    // All the deques must exist before the workers start stealing from them.
+    // A ParallelFor call creates at most kTaskRedundancyFactor * n_threads chunks.
+    const size_t chunk_stack_capacity = kChunkStackDepth * kTaskRedundancyFactor * n_threads;
+    for (size_t i = 0; i < n_threads; i++) {
+      worker_states_.push_back(std::make_unique<WorkerState>(chunk_stack_capacity));
+    }
+  }
+  workers_.reserve(n_threads - 1);
   for (size_t i = 0; i < n_threads - 1; i++) {
-    workers_.emplace_back([this, id = i + 1]() {
+    const bool pin = !worker_cpus.empty();
+    const size_t cpu = pin ? worker_cpus[i + 1] : 0;
+    workers_.emplace_back([this, id = i + 1, pin, cpu]() {
       SetWorkerIdForCurrentThread(id);
-      TaskRunner(&new_pending_task_, &continue_running_);
+      if (pin) {
+        LOG_IF(WARNING, !SetCurrentThreadAffinity({cpu}))
+            << "Failed to pin thread " << id << " to CPU " << cpu << ".";
+      }
+      worker_of = this;
+      if (work_stealing_) {
+        WorkStealingRunner(id, nullptr);
+      } else {
+        TaskRunner(&new_pending_task_, &continue_running_);
+      }
     });
   }
 }
 
 TaskManager::~TaskManager() {
   {
-    std::unique_lock<std::mutex> cv_lock(mutex_);
+    StatsLock cv_lock(mutex_);
     // Log rather than assert, because we don't want to throw exceptions in a destructor.
-    LOG_IF(ERROR, !tasks_.empty()) << "Threadpool destructor called while tasks are pending.";
+    LOG_IF(
+        ERROR,
+        !tasks_.empty() || !injected_chunks_.empty() || n_node_chunks_ > 0 || n_job_chunks_ > 0)
+        << "Threadpool destructor called while tasks are pending.";
     continue_running_ = 0;
     new_pending_task_.NotifyAll();
     task_group_finished_.NotifyAll();
+
+    stop_ = true;
+    ++wake_epoch_;
+    wake_cv_.notify_all();
   }
   for (auto& t : workers_) {
     t.join();
   }
+  if (!owner_affinity_.empty() && std::this_thread::get_id() == owner_thread_id_) {
+    SetCurrentThreadAffinity(owner_affinity_);
+  }
+}
+void TaskManager::InitSingleton() {
+  singleton = new TaskManager(FLAGS_n_threads, FLAGS_work_stealing, FLAGS_thread_affinity);
+  if (!FLAGS_task_manager_stats_file.empty()) {
+    singleton->EnableStats(true);
+    std::atexit([]() {
+      std::ofstream file(FLAGS_task_manager_stats_file);
+      file << singleton->GetStatsJson();
+      LOG_IF(ERROR, !file) << "Failed to write the task manager statistics to "
+                           << FLAGS_task_manager_stats_file << ".";
+    });
+  }
 }
-void TaskManager::InitSingleton() { singleton = new TaskManager(FLAGS_n_threads); }
 
-TaskManager TaskManager::CreateInstanceForTesting(size_t n_threads) {
-  return TaskManager(n_threads);
+TaskManager::WorkerStats& TaskManager::CurrentWorkerStats() {
+  const size_t deque_index = CurrentDequeIndex();
+  return *worker_stats_[deque_index == kNoDeque ? worker_stats_.size() - 1 : deque_index];
+}
+
+void TaskManager::ResetStats() {
+  for (const auto& stats : worker_stats_) {
+    stats->busy_ns = 0;
+    stats->idle_ns = 0;
+    stats->wait_ns = 0;
+    stats->n_tasks = 0;
+    stats->n_steals = 0;
+  }
+  mutex_.n_acquisitions = 0;
+  mutex_.wait_ns = 0;
+  mutex_.hold_ns = 0;
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  call_site_stats_.clear();
+  n_calls_per_depth_.clear();
+}
+
+std::string TaskManager::GetStatsJson() {
+  Json::Value root(Json::objectValue);
+  root["n_threads"] = Json::UInt64(GetNumThreads());
+  root["backend"] = work_stealing_ ? "work_stealing" : "global_queue";
+
+  Json::Value& workers = root["workers"] = Json::Value(Json::arrayValue);
+  for (size_t i = 0; i < worker_stats_.size(); ++i) {
+    const WorkerStats& stats = *worker_stats_[i];
+    Json::Value worker(Json::objectValue);
+    worker["worker_id"] = i + 1 < worker_stats_.size() ? Json::Value(Json::UInt64(i))
+                                                       : Json::Value("external");
+    worker["busy_ns"] = Json::UInt64(stats.busy_ns);
+    worker["idle_ns"] = Json::UInt64(stats.idle_ns);
+    worker["wait_ns"] = Json::UInt64(stats.wait_ns);
+    worker["n_tasks"] = Json::UInt64(stats.n_tasks);
+    worker["n_steals"] = Json::UInt64(stats.n_steals);
+    workers.append(worker);
+  }
+
+  Json::Value& mutex = root["mutex"];
+  mutex["n_acquisitions"] = Json::UInt64(mutex_.n_acquisitions);
+  mutex["wait_ns"] = Json::UInt64(mutex_.wait_ns);
+  mutex["hold_ns"] = Json::UInt64(mutex_.hold_ns);
+
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  Json::Value& depth = root["depth"] = Json::Value(Json::arrayValue);
+  // Depth 0 is not used.
+  for (size_t d = 1; d < n_calls_per_depth_.size(); ++d) {
+    Json::Value entry(Json::objectValue);
+    entry["depth"] = Json::UInt64(d);
+    entry["n_calls"] = Json::UInt64(n_calls_per_depth_[d]);
+    depth.append(entry);
+  }
+
+  Json::Value& call_sites = root["call_sites"] = Json::Value(Json::objectValue);
+  for (const auto& [tag, stats] : call_site_stats_) {
+    Json::Value& call_site = call_sites[tag.empty() ? "untagged" : tag];
+    call_site["n_calls"] = Json::UInt64(stats.n_calls);
+    call_site["n_chunks"] = Json::UInt64(stats.n_chunks);
+    call_site["wall_ns"] = Json::UInt64(stats.wall_ns);
+    call_site["chunk_ns"] = Json::UInt64(stats.chunk_ns);
+  }
+  return root.toStyledString();
+}
+
+TaskManager TaskManager::CreateInstanceForTesting(
+    size_t n_threads, bool work_stealing, const std::string& thread_affinity) {
+  return TaskManager(n_threads, work_stealing, thread_affinity);
 }
 
 void TaskManager::TaskRunner(CvWithWaitersCount* cv, const size_t* siblings_counter) {
   for (;;) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (*siblings_counter > 0 && tasks_.empty()) {
-      cv->Wait(&lock);
+    StatsLock lock(mutex_);
+    if (*siblings_counter > 0 && tasks_.empty()) {
+      IdleTimer idle_timer(this, /*waiting=*/siblings_counter != &continue_running_);
+      while (*siblings_counter > 0 && tasks_.empty()) {
+        cv->Wait(&lock);
+      }
     }
 
     if (*siblings_counter == 0) {
@@ -79,28 +458,72 @@ void TaskManager::TaskRunner(CvWithWaitersCount* cv, const size_t* siblings_coun
   }
 }
 
-/*
-  Returns the equivelent of std::min(start_idx + chunk_size, end_idx) while taking care of
-  uint64_t overflow in start_idx + chunk_size.
-*/
-static uint64_t GetTaskEndIdx(uint64_t start_idx, uint64_t chunk_size, uint64_t end_idx) {
-  uint64_t res = start_idx + chunk_size;
-  if (res < start_idx || res > end_idx) {
-    res = end_idx;
-  }
-  return res;
-}
-
 void TaskManager::ParallelFor(
     uint64_t start_idx, uint64_t end_idx, const std::function<void(const TaskInfo&)>& func,
     uint64_t max_chunk_size_for_lambda, uint64_t min_work_chunk) {
-  uint64_t split_size = std::max(
-      min_work_chunk, DivCeil(end_idx - start_idx, kTaskRedundancyFactor * GetNumThreads()));
+  ParallelFor<std::function<void(const TaskInfo&)>>(
+      start_idx, end_idx, func, max_chunk_size_for_lambda, min_work_chunk);
+}
+
+uint64_t TaskManager::GetSplitSize(uint64_t n_iterations, uint64_t min_work_chunk) {
+  return std::max(min_work_chunk, DivCeil(n_iterations, kTaskRedundancyFactor * GetNumThreads()));
+}
+
+uint64_t TaskManager::GetAdaptiveSplitSize(
+    std::string_view tag, uint64_t n_iterations, uint64_t min_work_chunk) {
+  const uint64_t default_split_size = GetSplitSize(n_iterations, min_work_chunk);
+  double iteration_time_ns = 0;
+  {
+    std::unique_lock<std::mutex> lock(adaptive_mutex_);
+    const auto it = adaptive_iteration_time_ns_.find(tag);
+    if (it == adaptive_iteration_time_ns_.end()) {
+      return default_split_size;
+    }
+    iteration_time_ns = it->second;
+  }
+
+  // Iterations that take less than a nanosecond are treated as taking a nanosecond.
+  iteration_time_ns = std::max(iteration_time_ns, 1.0);
+  const auto n_iterations_in = [iteration_time_ns](std::chrono::nanoseconds duration) {
+    return std::max<uint64_t>(static_cast<uint64_t>(duration.count() / iteration_time_ns), 1);
+  };
+  const uint64_t min_split_size = n_iterations_in(kAdaptiveMinChunkDuration);
+  const uint64_t max_split_size =
+      std::max(n_iterations_in(kAdaptiveMaxChunkDuration), min_split_size);
+  return std::clamp(default_split_size, min_split_size, max_split_size);
+}
+
+void TaskManager::RecordAdaptiveTime(
+    std::string_view tag, uint64_t n_iterations, std::chrono::nanoseconds total_time) {
+  const double iteration_time_ns =
+      static_cast<double>(total_time.count()) / static_cast<double>(n_iterations);
+  std::unique_lock<std::mutex> lock(adaptive_mutex_);
+  const auto it = adaptive_iteration_time_ns_.find(tag);
+  if (it == adaptive_iteration_time_ns_.end()) {
+    adaptive_iteration_time_ns_.emplace(std::string(tag), iteration_time_ns);
+  } else {
+    // An exponential moving average, so that the learned time follows changes in the input sizes
+    // and in the load of the machine, while smoothing out noisy measurements.
+    it->second = (it->second + iteration_time_ns) / 2;
+  }
+}
+
+std::chrono::duration<double, std::nano> TaskManager::GetAdaptiveIterationTime(
+    std::string_view tag) {
+  std::unique_lock<std::mutex> lock(adaptive_mutex_);
+  const auto it = adaptive_iteration_time_ns_.find(tag);
+  return std::chrono::duration<double, std::nano>(
+      it == adaptive_iteration_time_ns_.end() ? 0 : it->second);
+}
 
+void TaskManager::ParallelForGlobalQueue(
+    uint64_t start_idx, uint64_t end_idx, const std::function<void(const TaskInfo&)>& func,
+    uint64_t max_chunk_size_for_lambda, uint64_t split_size) {
   size_t siblings_counter = 0;
   std::exception_ptr eptr = nullptr;
+  CallTimer call_timer(this);
 
-  std::unique_lock<std::mutex> cv_lock(mutex_);
+  StatsLock cv_lock(mutex_);
 
   for (uint64_t task_end_idx, task_idx = start_idx; task_idx < end_idx; task_idx = task_end_idx) {
     ++siblings_counter;
@@ -109,23 +532,27 @@ void TaskManager::ParallelFor(
 
     uint64_t chunk_size = max_chunk_size_for_lambda;
     tasks_.emplace_back(
-        [this, &func, task_idx, task_end_idx, chunk_size, &siblings_counter, &eptr] {
+        [this, &func, task_idx, task_end_idx, chunk_size, &siblings_counter, &eptr,
+         &call_timer] {
           std::exception_ptr exception = nullptr;
-          struct TaskInfo info {};
-          uint64_t i;
-          for (i = task_idx; i < task_end_idx; i = info.end_idx) {
-            info.start_idx = i;
-            info.end_idx = GetTaskEndIdx(i, chunk_size, task_end_idx);
-
-            try {
-              func(info);
-            } catch (...) {
-              exception = std::current_exception();
-              break;
+          {
+            ChunkTimer chunk_timer(this, &call_timer);
+            struct TaskInfo info {};
+            uint64_t i;
+            for (i = task_idx; i < task_end_idx; i = info.end_idx) {
+              info.start_idx = i;
+              info.end_idx = GetTaskEndIdx(i, chunk_size, task_end_idx);
+
+              try {
+                func(info);
+              } catch (...) {
+                exception = std::current_exception();
+                break;
+              }
             }
           }
 
-          std::unique_lock<std::mutex> lock(mutex_);
+          StatsLock lock(mutex_);
           if (exception != nullptr && eptr == nullptr) {
             eptr = exception;
           }
@@ -137,6 +564,7 @@ void TaskManager::ParallelFor(
         });
   }
 
+  call_timer.SetNumChunks(siblings_counter);
   cv_lock.unlock();
   TaskRunner(&task_group_finished_, &siblings_counter);
 
@@ -149,8 +577,452 @@ void TaskManager::ParallelFor(
   }
 }
 
+void TaskManager::ParallelForWorkStealing(
+    uint64_t start_idx, uint64_t end_idx, const void* func, RunRangeFn run_range,
+    uint64_t max_chunk_size_for_lambda, uint64_t split_size) {
+  if (start_idx >= end_idx) {
+    return;
+  }
+  const uint64_t n_chunks = DivCeil(end_idx - start_idx, split_size);
+  CallTimer call_timer(this);
+  call_timer.SetNumChunks(n_chunks);
+  const size_t deque_index = CurrentDequeIndex();
+  TaskJob* const job = CurrentJob();
+  WorkerState* state = deque_index == kNoDeque ? nullptr : worker_states_[deque_index].get();
+
+  // The deques hold pointers to the chunks. This is safe since this function returns only after
+  // all the chunks are done.
+  std::vector<WorkStealingChunk> heap_chunks;
+  bool use_chunk_stack = false;
+  WorkStealingChunk* chunks = AcquireChunks(state, n_chunks, &heap_chunks, &use_chunk_stack);
+
+  WorkStealingTaskGroup group{
+      func, run_range, max_chunk_size_for_lambda, {n_chunks}, {}, nullptr, job, &call_timer};
+  uint64_t task_idx = start_idx;
+  for (uint64_t chunk_idx = 0; chunk_idx < n_chunks; ++chunk_idx) {
+    const uint64_t task_end_idx = GetTaskEndIdx(task_idx, split_size, end_idx);
+    chunks[chunk_idx] = {&group, task_idx, task_end_idx};
+    task_idx = task_end_idx;
+  }
+
+  if (job != nullptr) {
+    PushToJob(job, gsl::make_span(chunks, n_chunks));
+  } else if (state == nullptr) {
+    StatsLock lock(mutex_);
+    for (uint64_t chunk_idx = 0; chunk_idx < n_chunks; ++chunk_idx) {
+      injected_chunks_.push_back(&chunks[chunk_idx]);
+    }
+    n_injected_chunks_ += n_chunks;
+  } else {
+    // Push in reverse order, so that the current thread starts with the first chunk, while other
+    // threads steal from the end of the range.
+    for (uint64_t chunk_idx = n_chunks; chunk_idx > 0; --chunk_idx) {
+      state->deque.Push(&chunks[chunk_idx - 1]);
+    }
+  }
+  if (!short_calls) {
+    WakeSleepingThreads();
+  }
+
+  WorkStealingRunner(deque_index, &group);
+  if (use_chunk_stack) {
+    state->chunk_stack_size -= n_chunks;
+  }
+
+  ASSERT_RELEASE(
+      group.n_pending_chunks == 0, "WorkStealingRunner returned before all chunks completed.");
+  if (group.eptr != nullptr) {
+    std::rethrow_exception(group.eptr);
+  }
+}
+
+void TaskManager::ParallelForNodeAffineWorkStealing(
+    uint64_t start_idx, uint64_t end_idx, const void* func, RunRangeFn run_range,
+    uint64_t max_chunk_size_for_lambda) {
+  if (start_idx >= end_idx) {
+    return;
+  }
+  const uint64_t n_iterations = end_idx - start_idx;
+  const size_t deque_index = CurrentDequeIndex();
+  WorkerState* state = deque_index == kNoDeque ? nullptr : worker_states_[deque_index].get();
+
+  // Split the range into one block per node, and split each block into chunks according to the
+  // number of threads of the node.
+  std::vector<uint64_t> block_starts(n_numa_nodes_ + 1);
+  std::vector<uint64_t> block_split_sizes(n_numa_nodes_);
+  uint64_t n_chunks = 0;
+  for (size_t node = 0; node <= n_numa_nodes_; ++node) {
+    // Computed as a 128 bit number to avoid an overflow.
+    block_starts[node] =
+        start_idx +
+        static_cast<uint64_t>(static_cast<__uint128_t>(n_iterations) * node / n_numa_nodes_);
+  }
+  for (size_t node = 0; node < n_numa_nodes_; ++node) {
+    const uint64_t block_size = block_starts[node + 1] - block_starts[node];
+    block_split_sizes[node] = std::max<uint64_t>(
+        DivCeil(block_size, kTaskRedundancyFactor * std::max<size_t>(node_n_threads_[node], 1)),
+        1);
+    n_chunks += DivCeil(block_size, block_split_sizes[node]);
+  }
+
+  CallTimer call_timer(this);
+  call_timer.SetNumChunks(n_chunks);
+  std::vector<WorkStealingChunk> heap_chunks;
+  bool use_chunk_stack = false;
+  WorkStealingChunk* chunks = AcquireChunks(state, n_chunks, &heap_chunks, &use_chunk_stack);
+  WorkStealingTaskGroup group{
+      func, run_range, max_chunk_size_for_lambda, {n_chunks}, {}, nullptr, nullptr, &call_timer};
+
+  uint64_t chunk_idx = 0;
+  for (size_t node = 0; node < n_numa_nodes_; ++node) {
+    const uint64_t first_chunk_idx = chunk_idx;
+    for (uint64_t task_end_idx, task_idx = block_starts[node]; task_idx < block_starts[node + 1];
+         task_idx = task_end_idx) {
+      task_end_idx = GetTaskEndIdx(task_idx, block_split_sizes[node], block_starts[node + 1]);
+      chunks[chunk_idx++] = {&group, task_idx, task_end_idx};
+    }
+    PushToNode(node, gsl::make_span(chunks + first_chunk_idx, chunk_idx - first_chunk_idx));
+  }
+  ASSERT_RELEASE(chunk_idx == n_chunks, "Wrong number of chunks.");
+  WakeSleepingThreads();
+
+  WorkStealingRunner(deque_index, &group);
+  if (use_chunk_stack) {
+    state->chunk_stack_size -= n_chunks;
+  }
+
+  ASSERT_RELEASE(
+      group.n_pending_chunks == 0, "WorkStealingRunner returned before all chunks completed.");
+  if (group.eptr != nullptr) {
+    std::rethrow_exception(group.eptr);
+  }
+}
+
+TaskManager::WorkStealingChunk* TaskManager::AcquireChunks(
+    WorkerState* state, size_t n_chunks, std::vector<WorkStealingChunk>* heap_chunks,
+    bool* used_chunk_stack) {
+  *used_chunk_stack =
+      state != nullptr && state->chunk_stack_size + n_chunks <= state->chunk_stack.size();
+  if (*used_chunk_stack) {
+    WorkStealingChunk* chunks = &state->chunk_stack[state->chunk_stack_size];
+    state->chunk_stack_size += n_chunks;
+    return chunks;
+  }
+  heap_chunks->resize(n_chunks);
+  return heap_chunks->data();
+}
+
+void TaskManager::PushToNode(size_t node, gsl::span<WorkStealingChunk> chunks) {
+  StatsLock lock(mutex_);
+  // Chunks are popped from the back, so push in reverse order to run them in order.
+  std::vector<WorkStealingChunk*>& queue =
+      node_n_threads_[node] > 0 ? node_chunks_[node] : injected_chunks_;
+  for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+    queue.push_back(&*it);
+  }
+  if (node_n_threads_[node] > 0) {
+    n_node_chunks_ += chunks.size();
+  } else {
+    n_injected_chunks_ += chunks.size();
+  }
+}
+
+TaskJob* TaskManager::CurrentJob() const {
+  return current_job != nullptr && current_job->task_manager_ == this ? current_job : nullptr;
+}
+
+void TaskManager::PushToJob(TaskJob* job, gsl::span<WorkStealingChunk> chunks) {
+  StatsLock lock(mutex_);
+  // Chunks are popped from the back, so push in reverse order to run them in order.
+  for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+    job->chunks_.push_back(&*it);
+  }
+  n_job_chunks_ += chunks.size();
+}
+
+TaskManager::WorkStealingChunk* TaskManager::PopFromJobs() {
+  if (n_job_chunks_ == 0) {
+    return nullptr;
+  }
+  StatsLock lock(mutex_);
+  TaskJob* best_job = nullptr;
+  for (TaskJob* job : jobs_) {
+    if (job->chunks_.empty()) {
+      continue;
+    }
+    const size_t max_threads = job->options_.max_threads;
+    if (job != current_job && max_threads != 0 && job->n_active_threads_ >= max_threads) {
+      continue;
+    }
+    if (best_job == nullptr || job->options_.priority > best_job->options_.priority) {
+      best_job = job;
+      continue;
+    }
+    // Compare the CPU time per weight, computed as 128 bit numbers to avoid an overflow.
+    if (job->options_.priority == best_job->options_.priority &&
+        static_cast<__uint128_t>(job->cpu_time_ns_) * best_job->options_.weight <
+            static_cast<__uint128_t>(best_job->cpu_time_ns_) * job->options_.weight) {
+      best_job = job;
+    }
+  }
+  if (best_job == nullptr) {
+    return nullptr;
+  }
+
+  WorkStealingChunk* chunk = best_job->chunks_.back();
+  best_job->chunks_.pop_back();
+  --n_job_chunks_;
+  if (best_job != current_job) {
+    ++best_job->n_active_threads_;
+  }
+  return chunk;
+}
+
+TaskJob* TaskManager::SwitchJob(TaskJob* job) {
+  TaskJob* const prev_job = current_job;
+  if (prev_job != nullptr || job != nullptr) {
+    timespec cpu_time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+    const uint64_t now_ns = static_cast<uint64_t>(cpu_time.tv_sec) * 1000000000 +
+                            static_cast<uint64_t>(cpu_time.tv_nsec);
+    if (prev_job != nullptr) {
+      prev_job->cpu_time_ns_ += now_ns - current_job_start_cpu_time_ns;
+    }
+    current_job_start_cpu_time_ns = now_ns;
+  }
+  current_job = job;
+  return prev_job;
+}
+
+TaskManager::JobScope::JobScope(TaskJob* job)
+    : job_(job), prev_job_(job == nullptr ? nullptr : SwitchJob(job)) {
+  if (job_ != nullptr && job_ != prev_job_) {
+    ++job_->n_active_threads_;
+  }
+}
+
+TaskManager::JobScope::~JobScope() {
+  if (job_ != nullptr) {
+    SwitchJob(prev_job_);
+    if (job_ != prev_job_) {
+      --job_->n_active_threads_;
+    }
+  }
+}
+
+TaskJob::TaskJob(TaskJobOptions options, TaskManager* task_manager)
+    : task_manager_(task_manager), options_(std::move(options)) {
+  ASSERT_RELEASE(options_.weight > 0, "The weight of a job must be positive.");
+  TaskManager::StatsLock lock(task_manager_->mutex_);
+  task_manager_->jobs_.push_back(this);
+}
+
+TaskJob::~TaskJob() {
+  TaskManager::StatsLock lock(task_manager_->mutex_);
+  // Log rather than assert, because we don't want to throw exceptions in a destructor.
+  LOG_IF(ERROR, !chunks_.empty()) << "TaskJob destructor called while chunks are pending.";
+  auto& jobs = task_manager_->jobs_;
+  jobs.erase(std::remove(jobs.begin(), jobs.end(), this), jobs.end());
+}
+
+TaskManager::WorkStealingChunk* TaskManager::PopFromNode(size_t deque_index) {
+  if (deque_index == kNoDeque || n_node_chunks_ == 0) {
+    return nullptr;
+  }
+  StatsLock lock(mutex_);
+  std::vector<WorkStealingChunk*>& queue = node_chunks_[worker_nodes_[deque_index]];
+  if (queue.empty()) {
+    return nullptr;
+  }
+  WorkStealingChunk* chunk = queue.back();
+  queue.pop_back();
+  --n_node_chunks_;
+  return chunk;
+}
+
+size_t TaskManager::CurrentDequeIndex() const {
+  if (worker_of == this) {
+    return worker_id;
+  }
+  if (std::this_thread::get_id() == owner_thread_id_) {
+    return 0;
+  }
+  return kNoDeque;
+}
+
+bool TaskManager::IsDone(const WorkStealingTaskGroup* group) const {
+  return group == nullptr ? stop_.load() : group->n_pending_chunks.load() == 0;
+}
+
+void TaskManager::WorkStealingRunner(size_t deque_index, const WorkStealingTaskGroup* group) {
+  const auto is_done = [this, group]() { return IsDone(group); };
+
+  while (!is_done()) {
+    WorkStealingChunk* chunk = FindChunk(deque_index);
+    if (chunk == nullptr) {
+      IdleTimer idle_timer(this, /*waiting=*/group != nullptr);
+      chunk = SpinForChunk(deque_index, group);
+      if (chunk == nullptr) {
+        // No chunk was found. Register as a sleeping thread, and check again before going to
+        // sleep, so that a chunk pushed (or a group finished) concurrently is not missed.
+        StatsLock lock(mutex_);
+        const uint64_t wake_epoch = wake_epoch_;
+        ++n_sleeping_threads_;
+        lock.unlock();
+
+        chunk = is_done() ? nullptr : FindChunk(deque_index);
+        if (chunk == nullptr && !is_done()) {
+          lock.lock();
+          while (wake_epoch_ == wake_epoch) {
+            wake_cv_.wait(lock);
+          }
+          lock.unlock();
+        }
+        --n_sleeping_threads_;
+      }
+    }
+
+    if (chunk != nullptr) {
+      RunChunk(chunk);
+    }
+  }
+}
+
+TaskManager::WorkStealingChunk* TaskManager::SpinForChunk(
+    size_t deque_index, const WorkStealingTaskGroup* group) {
+  const int64_t spin_ns = idle_spin_ns_;
+  if (spin_ns <= 0) {
+    return nullptr;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(spin_ns);
+  while (!IsDone(group)) {
+    // Give up the CPU in every round, in case there are more threads than CPUs and the threads that
+    // are about to push new chunks (or finish the chunks of group) are waiting for it.
+    std::this_thread::yield();
+    WorkStealingChunk* chunk = FindChunk(deque_index);
+    if (chunk != nullptr) {
+      return chunk;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
+TaskManager::WorkStealingChunk* TaskManager::FindChunk(size_t deque_index) {
+  if (deque_index != kNoDeque) {
+    WorkStealingChunk* chunk = worker_states_[deque_index]->deque.Take();
+    if (chunk == nullptr) {
+      chunk = PopFromNode(deque_index);
+    }
+    if (chunk != nullptr) {
+      return chunk;
+    }
+  }
+
+  WorkStealingChunk* chunk = PopFromJobs();
+  if (chunk != nullptr) {
+    return chunk;
+  }
+
+  const size_t n_deques = worker_states_.size();
+  const size_t first_victim = deque_index == kNoDeque ? 0 : deque_index + 1;
+  bool aborted = true;
+  while (aborted) {
+    aborted = false;
+    for (size_t i = 0; i < n_deques; ++i) {
+      const size_t victim = (first_victim + i) % n_deques;
+      if (victim == deque_index) {
+        continue;
+      }
+      WorkStealingChunk* chunk = nullptr;
+      switch (worker_states_[victim]->deque.Steal(&chunk)) {
+        case WorkStealingDeque<WorkStealingChunk>::StealResult::kSuccess:
+          if (stats_enabled_.load(std::memory_order_relaxed)) {
+            CurrentWorkerStats().n_steals++;
+          }
+          return chunk;
+        case WorkStealingDeque<WorkStealingChunk>::StealResult::kAbort:
+          aborted = true;
+          break;
+        case WorkStealingDeque<WorkStealingChunk>::StealResult::kEmpty:
+          break;
+      }
+    }
+
+    if (n_injected_chunks_ > 0) {
+      StatsLock lock(mutex_);
+      if (!injected_chunks_.empty()) {
+        WorkStealingChunk* chunk = injected_chunks_.back();
+        injected_chunks_.pop_back();
+        --n_injected_chunks_;
+        return chunk;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void TaskManager::RunChunk(WorkStealingChunk* chunk) {
+  WorkStealingTaskGroup* group = chunk->group;
+  // Nested ParallelFor calls of the chunk belong to the job of the chunk. Note that the thread was
+  // added to the active threads of the job by PopFromJobs().
+  TaskJob* const job = group->job;
+  TaskJob* const prev_job = current_job;
+  const bool switch_job = job != prev_job;
+  if (switch_job) {
+    SwitchJob(job);
+  }
+  {
+    ChunkTimer chunk_timer(this, group->call_timer);
+    try {
+      group->run_range(
+          group->func, chunk->start_idx, chunk->end_idx, group->max_chunk_size_for_lambda);
+    } catch (...) {
+      std::unique_lock<std::mutex> lock(group->exception_mutex);
+      if (group->eptr == nullptr) {
+        group->eptr = std::current_exception();
+      }
+    }
+  }
+  if (switch_job) {
+    SwitchJob(prev_job);
+    if (job != nullptr) {
+      --job->n_active_threads_;
+      // Threads that skipped the job since it was at its thread cap may pick it now.
+      if (n_job_chunks_ > 0) {
+        WakeSleepingThreads();
+      }
+    }
+  }
+
+  // Note that group may be destroyed as soon as the last chunk is marked as done.
+  if (--group->n_pending_chunks == 0) {
+    WakeSleepingThreads();
+  }
+}
+
+void TaskManager::WakeSleepingThreads() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (n_sleeping_threads_ > 0) {
+    StatsLock lock(mutex_);
+    ++wake_epoch_;
+    wake_cv_.notify_all();
+  }
+}
+
 gsl::owner<TaskManager*> TaskManager::singleton;
 std::once_flag TaskManager::singleton_flag;
+std::atomic<TaskManager*> TaskManager::instance_for_testing{nullptr};
 thread_local size_t TaskManager::worker_id;
+thread_local const TaskManager* TaskManager::worker_of = nullptr;
+thread_local TaskJob* TaskManager::current_job = nullptr;
+thread_local uint64_t TaskManager::current_job_start_cpu_time_ns = 0;
+thread_local bool TaskManager::short_calls = false;
+thread_local std::string_view TaskManager::stats_tag;
+thread_local void* TaskManager::task_context = nullptr;
+thread_local size_t TaskManager::parallel_for_depth = 0;
+thread_local size_t TaskManager::n_running_chunks = 0;
 
 }  // namespace starkware
@@ -1,10 +1,17 @@
 #ifndef STARKWARE_UTILS_TASK_MANAGER_H_
 #define STARKWARE_UTILS_TASK_MANAGER_H_
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <map>
 #include <mutex>
 #include <queue>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -14,6 +21,10 @@
 #include "starkware/error_handling/error_handling.h"
 
 DECLARE_uint32(n_threads);
+DECLARE_bool(work_stealing);
+DECLARE_string(thread_affinity);
+DECLARE_uint32(idle_spin_us);
+DECLARE_string(task_manager_stats_file);
 
 namespace starkware {
 
@@ -22,6 +33,15 @@ struct TaskInfo {
   uint64_t end_idx;
 };
 
+enum class ScanType {
+  // output[i] = input[0] op ... op input[i].
+  kInclusive,
+  // output[i] = identity op input[0] op ... op input[i - 1].
+  kExclusive,
+};
+
+class TaskJob;
+
 /*
   This class manages task executions.
 
@@ -33,6 +53,30 @@ struct TaskInfo {
 
   This design makes it easier to support hierarchical parallelization, as tasks
   may invoke QueueAndWait without reducing the number of threads allocated for the task execution.
+
+  Two scheduling backends are available, selected by --work_stealing:
+  * Global queue: all the pending tasks are kept in a single queue, protected by a single mutex.
+  * Work stealing (the default): each thread keeps its own tasks in a WorkStealingDeque. A thread
+    runs the tasks it pushed in LIFO order, and when it runs out of tasks it steals from the other
+    threads. This avoids contention on a single lock when there are many threads and short tasks.
+    Tasks of ParallelFor calls from threads that are not part of the pool go to a shared queue.
+
+  The threads may be pinned to CPUs, see --thread_affinity. In that case, each thread is associated
+  with the NUMA node of its CPU, and ParallelForNodeAffine() can be used to keep the accesses of
+  each thread to memory of its own node.
+
+  Several jobs (e.g., proofs computed concurrently by a prover service) may share the threads, see
+  TaskJob.
+
+  With the work-stealing backend, a thread that runs out of tasks keeps looking for new tasks for a
+  while (see --idle_spin_us) before it goes to sleep. When ParallelFor calls follow each other
+  closely, the threads pick up the tasks of the next call without being woken up by the operating
+  system. Calls that are expected to be short may also avoid waking up sleeping threads, see
+  ShortCallScope.
+
+  Scheduling statistics (the time each thread spends running tasks, looking for tasks and waiting
+  for other threads, the contention on the lock of the queues, and totals per call site) may be
+  collected, see EnableStats() and --task_manager_stats_file.
 */
 class TaskManager {
  public:
@@ -82,7 +126,98 @@ class TaskManager {
     ParallelFor(0U, end_idx, func, max_chunk_size_for_lambda, min_work_chunk);
   }
 
+  /*
+    Same as above, for any functor (e.g., a lambda) that can be called with a TaskInfo.
+    The functor is used by reference, without type erasure into an std::function, and the loop over
+    the iterations of a chunk is compiled together with the functor. With the work-stealing backend,
+    the chunks are kept in a preallocated per-thread stack, so a call does not allocate memory.
+  */
+  template <typename Func>
+  void ParallelFor(
+      uint64_t start_idx, uint64_t end_idx, const Func& func,
+      uint64_t max_chunk_size_for_lambda = 1, uint64_t min_work_chunk = 1);
+
+  template <typename Func>
+  void ParallelFor(
+      uint64_t end_idx, const Func& func, uint64_t max_chunk_size_for_lambda = 1,
+      uint64_t min_work_chunk = 1) {
+    ParallelFor(0U, end_idx, func, max_chunk_size_for_lambda, min_work_chunk);
+  }
+
+  /*
+    Same as ParallelFor, but [start_idx, end_idx) is split into NumNumaNodes() consecutive blocks of
+    (almost) equal size, and the iterations of block i are executed only by the threads of NUMA
+    node i. Memory that is first touched in a node-affine loop is placed on the node of the touching
+    thread, so later node-affine loops over the same range access local memory.
+
+    If the threads are not pinned (or the global-queue backend is used), or the call belongs to a
+    TaskJob, this is the same as ParallelFor.
+  */
+  template <typename Func>
+  void ParallelForNodeAffine(
+      uint64_t start_idx, uint64_t end_idx, const Func& func,
+      uint64_t max_chunk_size_for_lambda = 1);
+
+  /*
+    Same as ParallelFor, but the number of iterations of each chunk is chosen at runtime, from the
+    execution times of the chunks of the previous calls with the same tag (e.g., the name of the
+    call site). func is called once per chunk, with all the iterations of the chunk.
+
+    The chunks are made long enough for the scheduling overhead to be negligible (about
+    kAdaptiveMinChunkDuration), and short enough for the load to stay balanced between the threads
+    (about kAdaptiveMaxChunkDuration). The first call with a given tag splits the range as
+    ParallelFor does with the given min_work_chunk.
+  */
+  template <typename Func>
+  void ParallelForAdaptive(
+      uint64_t start_idx, uint64_t end_idx, const Func& func, std::string_view tag,
+      uint64_t min_work_chunk = 1);
+
+  /*
+    Returns identity op map(start_idx) op map(start_idx + 1) op ... op map(end_idx - 1), where op is
+    an associative binary operation and identity is its identity element.
+
+    The range is split into blocks of block_size iterations. Each block is reduced by a single
+    thread, from left to right, and the results of the blocks are then reduced from left to right.
+    Hence the order in which op is applied depends only on block_size, and not on the number of
+    threads, so the result is deterministic even if op is only approximately associative (e.g.,
+    addition of floating point numbers). op need not be commutative.
+  */
+  template <typename T, typename MapFunc, typename ReduceOp>
+  T ParallelReduce(
+      uint64_t start_idx, uint64_t end_idx, const T& identity, const MapFunc& map,
+      const ReduceOp& op, uint64_t block_size = kReduceBlockSize);
+
+  /*
+    Computes the prefix "sums" of input with respect to the associative binary operation op, whose
+    identity element is identity, into output (see ScanType). output may be the same as input.
+
+    As in ParallelReduce(), the order in which op is applied depends on block_size, and not on the
+    number of threads.
+  */
+  template <typename T, typename Op>
+  void ParallelScan(
+      gsl::span<const T> input, gsl::span<T> output, const T& identity, const Op& op,
+      ScanType scan_type, uint64_t block_size = kReduceBlockSize);
+
+  static constexpr uint64_t kReduceBlockSize = 1024;
+
+  /*
+    Returns the average execution time of an iteration of the ParallelForAdaptive() calls with the
+    given tag, as learned so far, or 0 if there were no such calls.
+  */
+  std::chrono::duration<double, std::nano> GetAdaptiveIterationTime(std::string_view tag);
+
+  static constexpr std::chrono::nanoseconds kAdaptiveMinChunkDuration =
+      std::chrono::microseconds(20);
+  static constexpr std::chrono::nanoseconds kAdaptiveMaxChunkDuration =
+      std::chrono::milliseconds(1);
+
   static TaskManager& GetInstance() {
+    TaskManager* const instance = instance_for_testing.load(std::memory_order_acquire);
+    if (instance != nullptr) {
+      return *instance;
+    }
     std::call_once(singleton_flag, InitSingleton);
     return *singleton;
   }
@@ -93,13 +228,43 @@ class TaskManager {
   */
   size_t GetNumThreads() { return workers_.size() + 1; }
 
+  /*
+    Returns the number of NUMA nodes used by the threads. This is 1 if the threads are not pinned.
+  */
+  size_t NumNumaNodes() const { return n_numa_nodes_; }
+
+  /*
+    Returns the NUMA node of the thread with the given worker_id (see GetWorkerId()).
+  */
+  size_t GetNumaNodeOfWorker(size_t worker_id) const { return worker_nodes_.at(worker_id); }
+
   /*
     For tests settings only.
     An interface to circumvent the singleton pattern.
     Used in tests where we want to test different thread number settings.
   */
   static TaskManager CreateInstanceForTesting(
-      size_t n_threads = std::thread::hardware_concurrency());
+      size_t n_threads = std::thread::hardware_concurrency(),
+      bool work_stealing = FLAGS_work_stealing,
+      const std::string& thread_affinity = FLAGS_thread_affinity);
+
+  /*
+    For tests and benchmarks only.
+    Makes GetInstance() return task_manager until the scope ends, so that code that uses the
+    singleton runs on an instance with different settings (e.g., from CreateInstanceForTesting()).
+    Must not be created or destroyed while other threads use GetInstance().
+  */
+  class InstanceScopeForTesting {
+   public:
+    explicit InstanceScopeForTesting(TaskManager* task_manager)
+        : prev_instance_(instance_for_testing.exchange(task_manager)) {}
+    ~InstanceScopeForTesting() { instance_for_testing = prev_instance_; }
+    InstanceScopeForTesting(const InstanceScopeForTesting&) = delete;
+    InstanceScopeForTesting& operator=(const InstanceScopeForTesting&) = delete;
+
+   private:
+    TaskManager* const prev_instance_;
+  };
 
   /*
     Returns the worker_id of the current thread.
@@ -108,7 +273,121 @@ class TaskManager {
     return worker_id;  // Read worker_id from thread local storage.
   }
 
+  /*
+    Makes the ParallelFor calls of the current thread belong to job until the scope ends. Nested
+    ParallelFor calls, made by the chunks of these calls on any thread, belong to the job as well.
+    Does nothing if job is nullptr.
+  */
+  class JobScope {
+   public:
+    explicit JobScope(TaskJob* job);
+    ~JobScope();
+    JobScope(const JobScope&) = delete;
+    JobScope& operator=(const JobScope&) = delete;
+
+   private:
+    TaskJob* const job_;
+    TaskJob* const prev_job_;
+  };
+
+  /*
+    Marks the ParallelFor calls of the current thread as short until the scope ends (nested calls
+    made by their chunks on other threads are not affected). The tasks of a short call are executed
+    by the calling thread and by the threads that are looking for tasks at the time of the call;
+    sleeping threads are not woken up, since waking them up may take longer than the call itself.
+    Only affects the work-stealing backend.
+  */
+  class ShortCallScope {
+   public:
+    ShortCallScope() : prev_short_calls_(short_calls) { short_calls = true; }
+    ~ShortCallScope() { short_calls = prev_short_calls_; }
+    ShortCallScope(const ShortCallScope&) = delete;
+    ShortCallScope& operator=(const ShortCallScope&) = delete;
+
+   private:
+    const bool prev_short_calls_;
+  };
+
+  /*
+    Attributes the ParallelFor calls of the current thread to the call site tag in the statistics
+    (see EnableStats()) until the scope ends. Nested calls made by the chunks of these calls, on
+    any thread, are attributed to tag as well, unless they are inside another StatsTagScope.
+    ParallelForAdaptive() calls are attributed to their tag. tag must outlive the scope.
+  */
+  class StatsTagScope {
+   public:
+    explicit StatsTagScope(std::string_view tag) : prev_tag_(stats_tag) { stats_tag = tag; }
+    ~StatsTagScope() { stats_tag = prev_tag_; }
+    StatsTagScope(const StatsTagScope&) = delete;
+    StatsTagScope& operator=(const StatsTagScope&) = delete;
+
+   private:
+    const std::string_view prev_tag_;
+  };
+
+  /*
+    Sets the task context of the current thread until the scope ends. The task context is an
+    opaque pointer that is inherited by the chunks of the ParallelFor calls made inside the scope,
+    on any thread. This lets higher-level utilities attach state to a computation, which follows
+    it into the chunks (e.g., BufferPool::Scope). context must outlive the scope.
+  */
+  class TaskContextScope {
+   public:
+    explicit TaskContextScope(void* context) : prev_context_(task_context) {
+      task_context = context;
+    }
+    ~TaskContextScope() { task_context = prev_context_; }
+    TaskContextScope(const TaskContextScope&) = delete;
+    TaskContextScope& operator=(const TaskContextScope&) = delete;
+
+   private:
+    void* const prev_context_;
+  };
+
+  /*
+    Returns the context of the innermost TaskContextScope of the current thread, or nullptr.
+  */
+  static void* CurrentTaskContext() { return task_context; }
+
+  /*
+    Starts (or stops) collecting scheduling statistics. When the statistics are not collected, the
+    instrumentation costs a relaxed atomic load at each instrumentation point.
+  */
+  void EnableStats(bool enable) { stats_enabled_ = enable; }
+
+  /*
+    Clears the statistics collected so far.
+  */
+  void ResetStats();
+
+  /*
+    Returns the statistics collected so far, as a JSON string:
+      workers: for each thread (by worker id, and then "external" for threads that are not part of
+        the pool), the time spent running tasks ("busy_ns"), looking for tasks when there is nothing
+        to wait for ("idle_ns"), and waiting for the tasks of its own ParallelFor calls to be done
+        by other threads ("wait_ns"), and the number of tasks it executed and stole.
+      mutex: the number of acquisitions of the lock of the shared queues, and the time spent waiting
+        for it and holding it.
+      depth: the number of ParallelFor calls at each nesting depth (a call made by a task of a call
+        of depth d is of depth d + 1).
+      call_sites: for each tag (see StatsTagScope), the number of calls and tasks, the total time
+        of the calls, and the total time of their tasks (including nested calls).
+    The statistics of the TaskManager returned by GetInstance() are also written at exit to
+    --task_manager_stats_file, if given.
+  */
+  std::string GetStatsJson();
+
+  /*
+    Sets the time a thread that runs out of tasks keeps looking for new tasks before it goes to
+    sleep. The initial value is --idle_spin_us.
+  */
+  void SetIdleSpinDuration(std::chrono::nanoseconds duration) {
+    idle_spin_ns_ = duration.count();
+  }
+
  private:
+  friend class TaskJob;
+
   /*
     Sets the worker_id of the current thread.
   */
@@ -123,23 +402,94 @@ class TaskManager {
   */
   static constexpr uint64_t kTaskRedundancyFactor = 4;
 
-  explicit TaskManager(size_t n_threads);
+  TaskManager(size_t n_threads, bool work_stealing, const std::string& thread_affinity);
   static void InitSingleton();
 
+  /*
+    A mutex that measures how long threads wait for it and hold it, when the statistics are
+    collected.
+  */
+  class StatsMutex {
+   public:
+    explicit StatsMutex(const std::atomic<bool>* stats_enabled) : stats_enabled_(stats_enabled) {}
+
+    void lock() {  // NOLINT: BasicLockable.
+      if (stats_enabled_->load(std::memory_order_relaxed)) {
+        LockWithStats();
+      } else {
+        mutex_.lock();
+        locked_with_stats_ = false;
+      }
+    }
+
+    void unlock() {  // NOLINT: BasicLockable.
+      if (locked_with_stats_) {
+        UnlockWithStats();
+      } else {
+        mutex_.unlock();
+      }
+    }
+
+    std::atomic<uint64_t> n_acquisitions{0};
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> hold_ns{0};
+
+   private:
+    void LockWithStats();
+    void UnlockWithStats();
+
+    std::mutex mutex_;
+    const std::atomic<bool>* stats_enabled_;
+    // Written only by the thread that holds the mutex.
+    bool locked_with_stats_ = false;
+    uint64_t lock_time_ns_ = 0;
+  };
+
+  using StatsLock = std::unique_lock<StatsMutex>;
+
   class CvWithWaitersCount {
    public:
     /*
       This function should be called with the lock held, just like a normal condition variable.
     */
-    void Wait(std::unique_lock<std::mutex>* lock);
+    void Wait(StatsLock* lock);
     bool TryNotify();
     void NotifyAll();
 
    private:
-    std::condition_variable cv_;
+    std::condition_variable_any cv_;
     size_t n_sleeping_threads_ = 0;
   };
 
+  // Statistics, see GetStatsJson(). The classes are defined in task_manager.cc.
+  struct WorkerStats;
+  struct CallSiteStats {
+    uint64_t n_calls = 0;
+    uint64_t n_chunks = 0;
+    uint64_t wall_ns = 0;
+    uint64_t chunk_ns = 0;
+  };
+
+  /*
+    Measures a ParallelFor call, and records it in the statistics when destroyed.
+  */
+  class CallTimer;
+
+  /*
+    Measures the execution of a chunk (or of a task of the global queue) by the current thread.
+  */
+  class ChunkTimer;
+
+  /*
+    Measures the time the current thread spends looking for tasks or sleeping.
+  */
+  class IdleTimer;
+
+  /*
+    Returns the statistics of the current thread.
+  */
+  WorkerStats& CurrentWorkerStats();
+
   /*
     Run tasks from the tasks queue (tasks_) until the siblings_counter is reduced to 0.
     When the worker threads (workers_) are created they start executing WorkerTask
@@ -153,7 +503,209 @@ class TaskManager {
   */
   void TaskRunner(CvWithWaitersCount* cv, const size_t* siblings_counter);
 
-  std::mutex mutex_;
+  /*
+    Returns the number of iterations of each chunk of a ParallelFor call with n_iterations
+    iterations.
+  */
+  uint64_t GetSplitSize(uint64_t n_iterations, uint64_t min_work_chunk);
+
+  /*
+    Same as ParallelFor, with chunks of split_size iterations.
+  */
+  template <typename Func>
+  void ParallelForWithSplitSize(
+      uint64_t start_idx, uint64_t end_idx, const Func& func, uint64_t max_chunk_size_for_lambda,
+      uint64_t split_size);
+
+  void ParallelForGlobalQueue(
+      uint64_t start_idx, uint64_t end_idx, const std::function<void(const TaskInfo&)>& func,
+      uint64_t max_chunk_size_for_lambda, uint64_t split_size);
+
+  /*
+    Returns the number of iterations of each chunk of a ParallelForAdaptive() call with the given
+    tag, n_iterations iterations and min_work_chunk.
+  */
+  uint64_t GetAdaptiveSplitSize(
+      std::string_view tag, uint64_t n_iterations, uint64_t min_work_chunk);
+
+  /*
+    Records that the chunks of a ParallelForAdaptive() call with the given tag and n_iterations
+    iterations took total_time to execute.
+  */
+  void RecordAdaptiveTime(
+      std::string_view tag, uint64_t n_iterations, std::chrono::nanoseconds total_time);
+
+  /*
+    Returns the equivalent of std::min(start_idx + chunk_size, end_idx) while taking care of
+    uint64_t overflow in start_idx + chunk_size.
+  */
+  static uint64_t GetTaskEndIdx(uint64_t start_idx, uint64_t chunk_size, uint64_t end_idx) {
+    uint64_t res = start_idx + chunk_size;
+    if (res < start_idx || res > end_idx) {
+      res = end_idx;
+    }
+    return res;
+  }
+
+  // Work-stealing backend. The structs are defined in task_manager.cc.
+  struct WorkStealingTaskGroup;
+  struct WorkStealingChunk;
+  struct WorkerState;
+  static constexpr size_t kNoDeque = std::numeric_limits<size_t>::max();
+
+  /*
+    Each thread preallocates room for the chunks of kChunkStackDepth nested ParallelFor calls.
+    Deeper calls allocate their chunks on the heap.
+  */
+  static constexpr size_t kChunkStackDepth = 4;
+
+  /*
+    A type-erased call of func on the iterations [start_idx, end_idx), split into ranges of at most
+    max_chunk_size_for_lambda iterations.
+  */
+  using RunRangeFn = void (*)(
+      const void* func, uint64_t start_idx, uint64_t end_idx, uint64_t max_chunk_size_for_lambda);
+
+  template <typename Func>
+  static void RunRange(
+      const void* func, uint64_t start_idx, uint64_t end_idx, uint64_t max_chunk_size_for_lambda);
+
+  void ParallelForWorkStealing(
+      uint64_t start_idx, uint64_t end_idx, const void* func, RunRangeFn run_range,
+      uint64_t max_chunk_size_for_lambda, uint64_t split_size);
+
+  void ParallelForNodeAffineWorkStealing(
+      uint64_t start_idx, uint64_t end_idx, const void* func, RunRangeFn run_range,
+      uint64_t max_chunk_size_for_lambda);
+
+  /*
+    Returns storage for n_chunks chunks, from the chunk stack of the current thread (state) if
+    possible, and from heap_chunks otherwise. Returns whether the chunk stack was used in
+    used_chunk_stack.
+  */
+  static WorkStealingChunk* AcquireChunks(
+      WorkerState* state, size_t n_chunks, std::vector<WorkStealingChunk>* heap_chunks,
+      bool* used_chunk_stack);
+
+  /*
+    Pushes chunks to the queue of the given NUMA node, or to the shared queue if the node has no
+    threads.
+  */
+  void PushToNode(size_t node, gsl::span<WorkStealingChunk> chunks);
+
+  /*
+    Pops a chunk from the queue of the NUMA node of the given thread. Returns nullptr if the queue
+    is empty.
+  */
+  WorkStealingChunk* PopFromNode(size_t deque_index);
+
+  /*
+    Returns the index of the deque owned by the current thread, or kNoDeque if the current thread
+    is not part of the pool.
+  */
+  size_t CurrentDequeIndex() const;
+
+  /*
+    Runs chunks until all the chunks of group are done (or, if group is nullptr, until the
+    TaskManager is destroyed). deque_index is the deque of the current thread (or kNoDeque).
+  */
+  void WorkStealingRunner(size_t deque_index, const WorkStealingTaskGroup* group);
+
+  /*
+    Returns true if the chunks of group are done (or, if group is nullptr, if the TaskManager is
+    being destroyed).
+  */
+  bool IsDone(const WorkStealingTaskGroup* group) const;
+
+  /*
+    Looks for a chunk for up to idle_spin_ns_ nanoseconds, or until IsDone(group). Returns nullptr
+    if no chunk was found.
+  */
+  WorkStealingChunk* SpinForChunk(size_t deque_index, const WorkStealingTaskGroup* group);
+
+  /*
+    Takes a chunk from the deque of the current thread, or steals one from another thread.
+    Returns nullptr if no chunk was found.
+  */
+  WorkStealingChunk* FindChunk(size_t deque_index);
+
+  /*
+    Runs the iterations of chunk, and marks it as done.
+  */
+  void RunChunk(WorkStealingChunk* chunk);
+
+  /*
+    Wakes up the threads sleeping in WorkStealingRunner, if there are any.
+  */
+  void WakeSleepingThreads();
+
+  /*
+    Returns the job of the ParallelFor calls of the current thread, or nullptr.
+  */
+  TaskJob* CurrentJob() const;
+
+  /*
+    Pushes chunks to the queue of job.
+  */
+  void PushToJob(TaskJob* job, gsl::span<WorkStealingChunk> chunks);
+
+  /*
+    Pops a chunk from the queue of the job that should run next: the job with the highest priority,
+    and among those the job with the least CPU time per weight. Jobs that already run on their
+    maximal number of threads are skipped, unless the current thread already works on them.
+    Returns nullptr if there is no such chunk.
+  */
+  WorkStealingChunk* PopFromJobs();
+
+  /*
+    Makes the current thread work on job (which may be nullptr), and charges the CPU time of the
+    thread since the last switch to the previous job. Returns the previous job.
+  */
+  static TaskJob* SwitchJob(TaskJob* job);
+
+  const bool work_stealing_;
+  const std::thread::id owner_thread_id_;
+
+  // The NUMA node of each thread (indexed by worker id), and the number of threads of each node.
+  size_t n_numa_nodes_ = 1;
+  std::vector<size_t> worker_nodes_;
+  std::vector<size_t> node_n_threads_;
+  // The affinity of the thread that created the TaskManager, if it was pinned.
+  std::vector<size_t> owner_affinity_;
+
+  // The deque and the chunk stack of each thread. Index 0 belongs to the thread that created the
+  // TaskManager.
+  std::vector<std::unique_ptr<WorkerState>> worker_states_;
+  // Chunks pushed by threads that are not part of the pool. Protected by mutex_.
+  std::vector<WorkStealingChunk*> injected_chunks_;
+  // Chunks of ParallelForNodeAffine() calls, per NUMA node. Protected by mutex_.
+  std::vector<std::vector<WorkStealingChunk*>> node_chunks_;
+  std::atomic<size_t> n_node_chunks_{0};
+  // The registered jobs. Protected by mutex_.
+  std::vector<TaskJob*> jobs_;
+  // The total number of chunks in the queues of the jobs.
+  std::atomic<size_t> n_job_chunks_{0};
+  std::atomic<size_t> n_injected_chunks_{0};
+  std::atomic<size_t> n_sleeping_threads_{0};
+  // Incremented (under mutex_) whenever sleeping threads should wake up.
+  uint64_t wake_epoch_ = 0;
+  std::condition_variable_any wake_cv_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int64_t> idle_spin_ns_;
+
+  std::atomic<bool> stats_enabled_{false};
+  StatsMutex mutex_{&stats_enabled_};
+  // Indexed by worker id. The last entry is shared by the threads that are not part of the pool.
+  std::vector<std::unique_ptr<WorkerStats>> worker_stats_;
+  // Protected by stats_mutex_.
+  std::map<std::string, CallSiteStats, std::less<>> call_site_stats_;
+  std::vector<uint64_t> n_calls_per_depth_;
+  std::mutex stats_mutex_;
+
+  // The learned execution time of an iteration, in nanoseconds, for each tag of
+  // ParallelForAdaptive(). Protected by adaptive_mutex_.
+  std::map<std::string, double, std::less<>> adaptive_iteration_time_ns_;
+  std::mutex adaptive_mutex_;
 
   std::vector<std::thread> workers_;
   std::vector<std::function<void()>> tasks_;
@@ -165,7 +717,86 @@ class TaskManager {
 
   static gsl::owner<TaskManager*> singleton;
   static std::once_flag singleton_flag;
+  // The instance of the innermost InstanceScopeForTesting, or nullptr.
+  static std::atomic<TaskManager*> instance_for_testing;
   static thread_local size_t worker_id;
+  // The TaskManager whose pool the current thread belongs to, or nullptr.
+  static thread_local const TaskManager* worker_of;
+  // The job the current thread works on, or nullptr, and the CPU time of the thread when it started
+  // working on it.
+  static thread_local TaskJob* current_job;
+  static thread_local uint64_t current_job_start_cpu_time_ns;
+  // Whether the current thread is inside a ShortCallScope.
+  static thread_local bool short_calls;
+  // The call site tag of the ParallelFor calls of the current thread, see StatsTagScope.
+  static thread_local std::string_view stats_tag;
+  // The task context of the current thread, see TaskContextScope.
+  static thread_local void* task_context;
+  // The nesting depth of the chunk the current thread runs (0 if it runs no chunk).
+  static thread_local size_t parallel_for_depth;
+  // The number of chunks the current thread is running (a chunk may run other chunks while it
+  // waits for a nested call).
+  static thread_local size_t n_running_chunks;
+};
+
+/*
+  Options of a TaskJob.
+*/
+struct TaskJobOptions {
+  // Chunks of jobs with a higher priority are picked first.
+  int priority = 0;
+  // Jobs of the same priority share the threads in proportion to their weights, in CPU time.
+  uint64_t weight = 1;
+  // The maximal number of threads that may work on the job at the same time, including the threads
+  // that called ParallelFor inside a TaskManager::JobScope of the job. 0 means no limit.
+  size_t max_threads = 0;
+  std::string name;
+};
+
+/*
+  A job that shares the threads of a TaskManager with other jobs.
+
+  The chunks of the ParallelFor calls of a job (see TaskManager::JobScope) are kept in a queue of
+  the job, and an idle thread picks the job to help according to the priorities, weights and thread
+  caps of the jobs (see TaskJobOptions). The CPU time the threads spend on the job is accounted.
+
+  ParallelFor calls that do not belong to any job are scheduled as before, and are preferred by the
+  thread that made them. Jobs are supported by the work-stealing backend only: with the global
+  queue backend, the ParallelFor calls of all the jobs share the global queue, and only the CPU time
+  of the threads that run inside a JobScope is accounted.
+
+  A job must outlive the ParallelFor calls that belong to it.
+*/
+class TaskJob {
+ public:
+  explicit TaskJob(
+      TaskJobOptions options = TaskJobOptions(),
+      TaskManager* task_manager = &TaskManager::GetInstance());
+  ~TaskJob();
+  TaskJob(const TaskJob&) = delete;
+  TaskJob(TaskJob&&) = delete;
+  TaskJob& operator=(const TaskJob&) = delete;
+  TaskJob& operator=(TaskJob&&) = delete;
+
+  const TaskJobOptions& Options() const { return options_; }
+
+  /*
+    Returns the CPU time spent on the job so far, by all the threads.
+  */
+  std::chrono::nanoseconds CpuTime() const {
+    return std::chrono::nanoseconds(cpu_time_ns_.load());
+  }
+
+ private:
+  friend class TaskManager;
+
+  TaskManager* const task_manager_;
+  const TaskJobOptions options_;
+  std::atomic<uint64_t> cpu_time_ns_{0};
+  // The number of threads that currently work on the job.
+  std::atomic<size_t> n_active_threads_{0};
+  // The pending chunks of the job. Protected by the mutex of task_manager_.
+  std::vector<TaskManager::WorkStealingChunk*> chunks_;
 };
 
 }  // namespace starkware
@@ -1,10 +1,14 @@
 #include "starkware/utils/task_manager.h"
 
+#include <chrono>
+#include <functional>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace starkware {
 
-inline void TaskManager::CvWithWaitersCount::Wait(std::unique_lock<std::mutex>* lock) {
+inline void TaskManager::CvWithWaitersCount::Wait(StatsLock* lock) {
   // Note that n_sleeping_threads_ is protected by lock.
   ++n_sleeping_threads_;
   cv_.wait(*lock);
@@ -21,4 +25,159 @@ inline bool TaskManager::CvWithWaitersCount::TryNotify() {
 
 inline void TaskManager::CvWithWaitersCount::NotifyAll() { cv_.notify_all(); }
 
+template <typename Func>
+void TaskManager::ParallelFor(
+    uint64_t start_idx, uint64_t end_idx, const Func& func, uint64_t max_chunk_size_for_lambda,
+    uint64_t min_work_chunk) {
+  const uint64_t n_iterations = start_idx < end_idx ? end_idx - start_idx : 0;
+  ParallelForWithSplitSize(
+      start_idx, end_idx, func, max_chunk_size_for_lambda,
+      GetSplitSize(n_iterations, min_work_chunk));
+}
+
+template <typename Func>
+void TaskManager::ParallelForWithSplitSize(
+    uint64_t start_idx, uint64_t end_idx, const Func& func, uint64_t max_chunk_size_for_lambda,
+    uint64_t split_size) {
+  if constexpr (std::is_function_v<Func>) {
+    // A function (rather than a function object). Call it through a pointer.
+    ParallelForWithSplitSize(start_idx, end_idx, &func, max_chunk_size_for_lambda, split_size);
+  } else if (work_stealing_) {
+    ParallelForWorkStealing(
+        start_idx, end_idx, &func, &RunRange<Func>, max_chunk_size_for_lambda, split_size);
+  } else {
+    ParallelForGlobalQueue(
+        start_idx, end_idx, std::function<void(const TaskInfo&)>(std::cref(func)),
+        max_chunk_size_for_lambda, split_size);
+  }
+}
+
+template <typename Func>
+void TaskManager::ParallelForAdaptive(
+    uint64_t start_idx, uint64_t end_idx, const Func& func, std::string_view tag,
+    uint64_t min_work_chunk) {
+  if (start_idx >= end_idx) {
+    return;
+  }
+  const uint64_t n_iterations = end_idx - start_idx;
+
+  // Measure the time of every chunk, rather than of the whole call, so that the time the calling
+  // thread waits for other threads is not counted.
+  std::atomic<uint64_t> total_time_ns{0};
+  const auto timed_func = [&func, &total_time_ns](const TaskInfo& task_info) {
+    const auto chunk_start = std::chrono::steady_clock::now();
+    func(task_info);
+    total_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - chunk_start)
+                         .count();
+  };
+  const uint64_t split_size = GetAdaptiveSplitSize(tag, n_iterations, min_work_chunk);
+  StatsTagScope tag_scope(tag);
+  ParallelForWithSplitSize(start_idx, end_idx, timed_func, split_size, split_size);
+  RecordAdaptiveTime(tag, n_iterations, std::chrono::nanoseconds(total_time_ns.load()));
+}
+
+template <typename T, typename MapFunc, typename ReduceOp>
+T TaskManager::ParallelReduce(
+    uint64_t start_idx, uint64_t end_idx, const T& identity, const MapFunc& map,
+    const ReduceOp& op, uint64_t block_size) {
+  // The results of the blocks are written concurrently, which std::vector<bool> does not allow.
+  static_assert(!std::is_same_v<T, bool>, "ParallelReduce does not support bool.");
+  ASSERT_RELEASE(block_size > 0, "block_size must be positive.");
+  if (start_idx >= end_idx) {
+    return identity;
+  }
+  const uint64_t n_blocks = (end_idx - start_idx - 1) / block_size + 1;
+
+  std::vector<T> block_results(n_blocks, identity);
+  ParallelFor(n_blocks, [&](const TaskInfo& task_info) {
+    for (uint64_t block = task_info.start_idx; block < task_info.end_idx; ++block) {
+      const uint64_t block_start = start_idx + block * block_size;
+      const uint64_t block_end = GetTaskEndIdx(block_start, block_size, end_idx);
+      T result = identity;
+      for (uint64_t i = block_start; i < block_end; ++i) {
+        result = op(std::move(result), map(i));
+      }
+      block_results[block] = std::move(result);
+    }
+  });
+
+  T result = identity;
+  for (T& block_result : block_results) {
+    result = op(std::move(result), std::move(block_result));
+  }
+  return result;
+}
+
+template <typename T, typename Op>
+void TaskManager::ParallelScan(
+    gsl::span<const T> input, gsl::span<T> output, const T& identity, const Op& op,
+    ScanType scan_type, uint64_t block_size) {
+  static_assert(!std::is_same_v<T, bool>, "ParallelScan does not support bool.");
+  ASSERT_RELEASE(block_size > 0, "block_size must be positive.");
+  ASSERT_RELEASE(input.size() == output.size(), "The sizes of input and output do not match.");
+  if (input.empty()) {
+    return;
+  }
+  const uint64_t n_blocks = (input.size() - 1) / block_size + 1;
+
+  // Compute the "sum" of every block but the last, and then the prefix of each block.
+  std::vector<T> block_prefixes(n_blocks, identity);
+  ParallelFor(n_blocks - 1, [&](const TaskInfo& task_info) {
+    for (uint64_t block = task_info.start_idx; block < task_info.end_idx; ++block) {
+      T result = identity;
+      for (uint64_t i = block * block_size; i < (block + 1) * block_size; ++i) {
+        result = op(std::move(result), input[i]);
+      }
+      block_prefixes[block + 1] = std::move(result);
+    }
+  });
+  for (uint64_t block = 1; block < n_blocks; ++block) {
+    block_prefixes[block] = op(block_prefixes[block - 1], block_prefixes[block]);
+  }
+
+  ParallelFor(n_blocks, [&](const TaskInfo& task_info) {
+    for (uint64_t block = task_info.start_idx; block < task_info.end_idx; ++block) {
+      T prefix = std::move(block_prefixes[block]);
+      const uint64_t block_end = GetTaskEndIdx(block * block_size, block_size, input.size());
+      for (uint64_t i = block * block_size; i < block_end; ++i) {
+        // Read input[i] before output[i] is written, as they may be the same element.
+        T value = input[i];
+        if (scan_type == ScanType::kInclusive) {
+          prefix = op(std::move(prefix), std::move(value));
+          output[i] = prefix;
+        } else {
+          output[i] = prefix;
+          prefix = op(std::move(prefix), std::move(value));
+        }
+      }
+    }
+  });
+}
+
+template <typename Func>
+void TaskManager::ParallelForNodeAffine(
+    uint64_t start_idx, uint64_t end_idx, const Func& func, uint64_t max_chunk_size_for_lambda) {
+  if constexpr (std::is_function_v<Func>) {
+    ParallelForNodeAffine(start_idx, end_idx, &func, max_chunk_size_for_lambda);
+  } else if (work_stealing_ && n_numa_nodes_ > 1 && CurrentJob() == nullptr) {
+    ParallelForNodeAffineWorkStealing(
+        start_idx, end_idx, &func, &RunRange<Func>, max_chunk_size_for_lambda);
+  } else {
+    ParallelFor(start_idx, end_idx, func, max_chunk_size_for_lambda);
+  }
+}
+
+template <typename Func>
+void TaskManager::RunRange(
+    const void* func, uint64_t start_idx, uint64_t end_idx, uint64_t max_chunk_size_for_lambda) {
+  const Func& typed_func = *static_cast<const Func*>(func);
+  TaskInfo info{};
+  for (uint64_t i = start_idx; i < end_idx; i = info.end_idx) {
+    info.start_idx = i;
+    info.end_idx = GetTaskEndIdx(i, max_chunk_size_for_lambda, end_idx);
+    typed_func(info);
+  }
+}
+
 }  // namespace starkware
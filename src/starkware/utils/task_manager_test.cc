@@ -1,11 +1,18 @@
 #include "starkware/utils/task_manager.h"
 
+#include <atomic>
+#include <chrono>
 #include <numeric>
+#include <optional>
 #include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "third_party/cppitertools/range.hpp"
+#include "third_party/jsoncpp/json/json.h"
 
 #include "starkware/error_handling/test_utils.h"
 
@@ -15,9 +22,16 @@ namespace {
 
 using testing::HasSubstr;
 
-class TaskManagerTest : public ::testing::TestWithParam<size_t> {
+/*
+  The test parameters are the number of threads and whether to use the work-stealing backend.
+*/
+class TaskManagerTest : public ::testing::TestWithParam<std::tuple<size_t, bool>> {
  public:
-  TaskManagerTest() : manager(TaskManager::CreateInstanceForTesting(GetParam())) {}
+  TaskManagerTest()
+      : manager(TaskManager::CreateInstanceForTesting(
+            std::get<0>(GetParam()), std::get<1>(GetParam()))) {}
+
+  static size_t NumThreads() { return std::get<0>(GetParam()); }
 
   TaskManager manager;
 };
@@ -73,7 +87,7 @@ TEST_P(TaskManagerTest, NestedException) {
 
 TEST_P(TaskManagerTest, ThreadIds) {
   std::set<std::thread::id> ids = {std::this_thread::get_id()};
-  size_t max_thread_count = GetParam();
+  size_t max_thread_count = NumThreads();
   std::mutex m;
   Barrier barrier(max_thread_count);
 
@@ -88,7 +102,7 @@ TEST_P(TaskManagerTest, ThreadIds) {
 
 TEST_P(TaskManagerTest, Singleon) {
   std::set<TaskManager*> managers;
-  size_t max_thread_count = GetParam();
+  size_t max_thread_count = NumThreads();
   std::mutex m;
 
   this->manager.ParallelFor(4 * max_thread_count, [&m, &managers](const TaskInfo& /*unused*/) {
@@ -100,7 +114,7 @@ TEST_P(TaskManagerTest, Singleon) {
   EXPECT_EQ(1U, managers.size());
 }
 
-TEST_P(TaskManagerTest, GetNumThreads) { EXPECT_EQ(GetParam(), this->manager.GetNumThreads()); }
+TEST_P(TaskManagerTest, GetNumThreads) { EXPECT_EQ(NumThreads(), this->manager.GetNumThreads()); }
 
 TEST_P(TaskManagerTest, WorkerId) {
   std::vector<size_t> ids(this->manager.GetNumThreads());
@@ -121,10 +135,376 @@ TEST_P(TaskManagerTest, WorkerId) {
   }
 }
 
-std::set<size_t> n_threads_option = {1, std::thread::hardware_concurrency()};
+TEST_P(TaskManagerTest, NestedParallelFor) {
+  constexpr uint64_t kOuter = 50;
+  constexpr uint64_t kInner = 200;
+  std::vector<std::atomic<uint64_t>> counts(kOuter * kInner);
+
+  this->manager.ParallelFor(kOuter, [&](const TaskInfo& outer) {
+    this->manager.ParallelFor(
+        kInner,
+        [&](const TaskInfo& inner) {
+          for (uint64_t i = inner.start_idx; i < inner.end_idx; ++i) {
+            counts[outer.start_idx * kInner + i]++;
+          }
+        },
+        3);
+  });
+
+  for (const auto& count : counts) {
+    ASSERT_EQ(1U, count);
+  }
+}
+
+TEST_P(TaskManagerTest, ParallelForFromOtherThread) {
+  // A thread which is not part of the pool may also call ParallelFor.
+  std::atomic<uint64_t> sum = 0;
+  std::thread thread([&]() {
+    this->manager.ParallelFor(1000, [&](const TaskInfo& task_info) { sum += task_info.start_idx; });
+  });
+  thread.join();
+  EXPECT_EQ(999U * 1000U / 2, sum);
+}
+
+/*
+  A functor that cannot be copied, and hence cannot be wrapped in an std::function.
+*/
+class NonCopyableSum {
+ public:
+  explicit NonCopyableSum(const std::vector<uint64_t>& values) : values_(values) {}
+  NonCopyableSum(const NonCopyableSum&) = delete;
+  NonCopyableSum& operator=(const NonCopyableSum&) = delete;
+  NonCopyableSum(NonCopyableSum&&) = delete;
+  NonCopyableSum& operator=(NonCopyableSum&&) = delete;
+  ~NonCopyableSum() = default;
+
+  void operator()(const TaskInfo& task_info) const {
+    for (size_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
+      sum_ += values_[i];
+    }
+  }
+
+  uint64_t Sum() const { return sum_; }
+
+ private:
+  const std::vector<uint64_t>& values_;
+  mutable std::atomic<uint64_t> sum_ = 0;
+};
+
+TEST_P(TaskManagerTest, ParallelForFunctor) {
+  std::vector<uint64_t> v(1000);
+  std::generate(v.begin(), v.end(), std::rand);
+
+  const NonCopyableSum func(v);
+  this->manager.ParallelFor(v.size(), func, 10);
+  EXPECT_EQ(std::accumulate(v.begin(), v.end(), UINT64_C(0)), func.Sum());
+}
+
+TEST_P(TaskManagerTest, ParallelForNodeAffine) {
+  std::vector<uint64_t> v(1000);
+  std::generate(v.begin(), v.end(), std::rand);
+  const uint64_t expected_sum = std::accumulate(v.begin(), v.end(), UINT64_C(0));
+
+  for (const std::string affinity : {"none", "compact", "scatter"}) {
+    TaskManager pinned_manager =
+        TaskManager::CreateInstanceForTesting(NumThreads(), std::get<1>(GetParam()), affinity);
+    const NonCopyableSum func(v);
+    pinned_manager.ParallelForNodeAffine(0, v.size(), func, 10);
+    EXPECT_EQ(expected_sum, func.Sum()) << "affinity: " << affinity;
+  }
+}
+
+TEST_P(TaskManagerTest, ParallelForAdaptive) {
+  // Each iteration takes at least kIterationTime, so once the time is learned, a chunk has at most
+  // kAdaptiveMaxChunkDuration / kIterationTime iterations.
+  constexpr std::chrono::microseconds kIterationTime(20);
+  constexpr uint64_t kNIterations = 1000;
+  const uint64_t max_split_size = TaskManager::kAdaptiveMaxChunkDuration / kIterationTime;
+  EXPECT_EQ(0, this->manager.GetAdaptiveIterationTime("test").count());
+
+  for (size_t call = 0; call < 2; ++call) {
+    std::mutex mutex;
+    std::vector<uint64_t> counts(kNIterations);
+    uint64_t max_chunk_size = 0;
+    this->manager.ParallelForAdaptive(
+        0, kNIterations,
+        [&](const TaskInfo& task_info) {
+          const auto end_time =
+              std::chrono::steady_clock::now() +
+              kIterationTime * (task_info.end_idx - task_info.start_idx);
+          while (std::chrono::steady_clock::now() < end_time) {
+          }
+          std::unique_lock<std::mutex> lock(mutex);
+          for (uint64_t i = task_info.start_idx; i < task_info.end_idx; ++i) {
+            ++counts[i];
+          }
+          max_chunk_size = std::max(max_chunk_size, task_info.end_idx - task_info.start_idx);
+        },
+        "test");
+    EXPECT_EQ(std::vector<uint64_t>(kNIterations, 1), counts);
+    EXPECT_GE(this->manager.GetAdaptiveIterationTime("test"), kIterationTime);
+    if (call > 0) {
+      EXPECT_LE(max_chunk_size, max_split_size);
+    }
+  }
+  EXPECT_EQ(0, this->manager.GetAdaptiveIterationTime("other_test").count());
+}
+
+TEST_P(TaskManagerTest, ParallelForAdaptiveMinWorkChunk) {
+  // Before the time of an iteration is learned, the range is not split below min_work_chunk.
+  constexpr uint64_t kNIterations = 1000;
+  std::atomic<uint64_t> n_chunks = 0;
+  this->manager.ParallelForAdaptive(
+      0, kNIterations, [&n_chunks](const TaskInfo& /*task_info*/) { ++n_chunks; },
+      "min_work_chunk_test", /*min_work_chunk=*/kNIterations);
+  EXPECT_EQ(1U, n_chunks);
+}
+
+TEST_P(TaskManagerTest, InstanceScopeForTesting) {
+  TaskManager* const singleton = &TaskManager::GetInstance();
+  {
+    TaskManager::InstanceScopeForTesting instance_scope(&this->manager);
+    EXPECT_EQ(&this->manager, &TaskManager::GetInstance());
+    // The threads of the instance see it as well.
+    std::atomic<size_t> n_matches = 0;
+    this->manager.ParallelFor(100, [&](const TaskInfo& /*task_info*/) {
+      if (&TaskManager::GetInstance() == &this->manager) {
+        ++n_matches;
+      }
+    });
+    EXPECT_EQ(100U, n_matches);
+  }
+  EXPECT_EQ(singleton, &TaskManager::GetInstance());
+}
+
+TEST_P(TaskManagerTest, IdlePolicy) {
+  // Consecutive calls, with and without spinning before going to sleep, and with short calls.
+  std::vector<uint64_t> v(1000);
+  std::generate(v.begin(), v.end(), std::rand);
+  const uint64_t expected_sum = std::accumulate(v.begin(), v.end(), UINT64_C(0));
+
+  for (const auto idle_spin : {std::chrono::microseconds(0), std::chrono::microseconds(50)}) {
+    this->manager.SetIdleSpinDuration(idle_spin);
+    for (const bool short_calls : {false, true}) {
+      std::optional<TaskManager::ShortCallScope> scope;
+      if (short_calls) {
+        scope.emplace();
+      }
+      for (size_t call = 0; call < 20; ++call) {
+        const NonCopyableSum func(v);
+        this->manager.ParallelFor(v.size(), func, 10);
+        EXPECT_EQ(expected_sum, func.Sum());
+      }
+
+      // Nested calls made by the chunks of a short call.
+      std::atomic<uint64_t> count = 0;
+      this->manager.ParallelFor(10, [&](const TaskInfo& /*task_info*/) {
+        this->manager.ParallelFor(
+            100, [&count](const TaskInfo& task_info) {
+              count += task_info.end_idx - task_info.start_idx;
+            });
+      });
+      EXPECT_EQ(1000U, count);
+    }
+  }
+}
+
+TEST_P(TaskManagerTest, ParallelReduce) {
+  std::vector<uint64_t> v(10000);
+  std::generate(v.begin(), v.end(), std::rand);
+  const auto map = [&v](uint64_t i) { return v[i]; };
+  const auto add = [](uint64_t a, uint64_t b) { return a + b; };
+  EXPECT_EQ(
+      std::accumulate(v.begin(), v.end(), UINT64_C(0)),
+      this->manager.ParallelReduce(0, v.size(), UINT64_C(0), map, add));
+  EXPECT_EQ(
+      std::accumulate(v.begin() + 10, v.begin() + 3000, UINT64_C(0)),
+      this->manager.ParallelReduce(10, 3000, UINT64_C(0), map, add, 7));
+  EXPECT_EQ(5U, this->manager.ParallelReduce(10, 10, UINT64_C(5), map, add));
+
+  // A non-commutative operation.
+  const auto concat = [](const std::string& a, const std::string& b) { return a + b; };
+  std::string expected;
+  for (uint64_t i = 0; i < 3000; ++i) {
+    expected += std::to_string(i % 10);
+  }
+  EXPECT_EQ(
+      expected,
+      this->manager.ParallelReduce(
+          0, 3000, std::string(), [](uint64_t i) { return std::to_string(i % 10); }, concat, 100));
+}
+
+TEST_P(TaskManagerTest, ParallelScan) {
+  std::vector<uint64_t> v(5000);
+  std::generate(v.begin(), v.end(), std::rand);
+  const auto add = [](uint64_t a, uint64_t b) { return a + b; };
+
+  for (const uint64_t block_size : {1, 3, 1024, 10000}) {
+    std::vector<uint64_t> expected(v.size());
+    std::vector<uint64_t> output(v.size());
+    std::inclusive_scan(v.begin(), v.end(), expected.begin(), add);
+    this->manager.ParallelScan<uint64_t>(v, output, 0, add, ScanType::kInclusive, block_size);
+    EXPECT_EQ(expected, output);
+
+    std::exclusive_scan(v.begin(), v.end(), expected.begin(), UINT64_C(0), add);
+    this->manager.ParallelScan<uint64_t>(v, output, 0, add, ScanType::kExclusive, block_size);
+    EXPECT_EQ(expected, output);
+
+    // In place.
+    output = v;
+    this->manager.ParallelScan<uint64_t>(output, output, 0, add, ScanType::kExclusive, block_size);
+    EXPECT_EQ(expected, output);
+  }
+
+  // A non-commutative operation.
+  const std::vector<std::string> strings = {"a", "b", "c", "d", "e"};
+  std::vector<std::string> prefixes(strings.size());
+  this->manager.ParallelScan<std::string>(
+      strings, prefixes, "", [](const std::string& a, const std::string& b) { return a + b; },
+      ScanType::kInclusive, 2);
+  EXPECT_EQ((std::vector<std::string>{"a", "ab", "abc", "abcd", "abcde"}), prefixes);
+
+  std::vector<uint64_t> empty;
+  this->manager.ParallelScan<uint64_t>(empty, empty, 0, add, ScanType::kInclusive);
+}
+
+TEST_P(TaskManagerTest, ParallelReduceDeterministic) {
+  // Floating point addition is not associative, so the result depends on the order of the
+  // additions. It should not depend on the number of threads.
+  std::vector<double> v(100000);
+  for (size_t i = 0; i < v.size(); ++i) {
+    v[i] = (i % 2 == 0 ? 1e10 : 1e-10) * (std::rand() % 1000);
+  }
+  const auto map = [&v](uint64_t i) { return v[i]; };
+  const auto add = [](double a, double b) { return a + b; };
+  TaskManager single_thread_manager =
+      TaskManager::CreateInstanceForTesting(1, std::get<1>(GetParam()));
+  const double expected = single_thread_manager.ParallelReduce(0, v.size(), 0.0, map, add);
+  std::vector<double> expected_prefixes(v.size());
+  single_thread_manager.ParallelScan<double>(
+      v, expected_prefixes, 0.0, add, ScanType::kInclusive);
+
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(expected, this->manager.ParallelReduce(0, v.size(), 0.0, map, add));
+    std::vector<double> prefixes(v.size());
+    this->manager.ParallelScan<double>(v, prefixes, 0.0, add, ScanType::kInclusive);
+    EXPECT_EQ(expected_prefixes, prefixes);
+  }
+}
+
+Json::Value GetStats(TaskManager* manager) {
+  Json::Value stats;
+  std::istringstream(manager->GetStatsJson()) >> stats;
+  return stats;
+}
+
+TEST_P(TaskManagerTest, Stats) {
+  this->manager.EnableStats(true);
+  {
+    TaskManager::StatsTagScope tag_scope("outer");
+    this->manager.ParallelFor(4, [&](const TaskInfo& /*task_info*/) {
+      this->manager.ParallelFor(10, [](const TaskInfo& /*task_info*/) {});
+    });
+  }
+  this->manager.ParallelFor(10, [](const TaskInfo& /*task_info*/) {});
+
+  const Json::Value stats = GetStats(&this->manager);
+  EXPECT_EQ(NumThreads(), stats["n_threads"].asUInt64());
+  ASSERT_EQ(NumThreads() + 1, stats["workers"].size());
+  EXPECT_EQ("external", stats["workers"][Json::ArrayIndex(NumThreads())]["worker_id"].asString());
+  EXPECT_TRUE(stats["mutex"].isMember("hold_ns"));
+
+  // The nested calls are of depth 2, and are attributed to the tag of the outer call.
+  ASSERT_EQ(2U, stats["depth"].size());
+  EXPECT_EQ(2U, stats["depth"][0]["n_calls"].asUInt64());
+  EXPECT_EQ(4U, stats["depth"][1]["n_calls"].asUInt64());
+  EXPECT_EQ(5U, stats["call_sites"]["outer"]["n_calls"].asUInt64());
+  EXPECT_EQ(1U, stats["call_sites"]["untagged"]["n_calls"].asUInt64());
+
+  // Every chunk is executed by some thread.
+  uint64_t n_tasks = 0;
+  for (const Json::Value& worker : stats["workers"]) {
+    n_tasks += worker["n_tasks"].asUInt64();
+  }
+  EXPECT_EQ(
+      stats["call_sites"]["outer"]["n_chunks"].asUInt64() +
+          stats["call_sites"]["untagged"]["n_chunks"].asUInt64(),
+      n_tasks);
+
+  this->manager.ResetStats();
+  EXPECT_TRUE(GetStats(&this->manager)["call_sites"].empty());
+  this->manager.EnableStats(false);
+  this->manager.ParallelFor(10, [](const TaskInfo& /*task_info*/) {});
+  EXPECT_TRUE(GetStats(&this->manager)["call_sites"].empty());
+}
+
+TEST_P(TaskManagerTest, Jobs) {
+  // Two jobs run ParallelFor calls (with nested calls) concurrently, from two other threads.
+  TaskJob job_a(TaskJobOptions{/*priority=*/1, /*weight=*/1, /*max_threads=*/0, "a"}, &manager);
+  TaskJob job_b(TaskJobOptions{/*priority=*/0, /*weight=*/2, /*max_threads=*/0, "b"}, &manager);
+  std::atomic<uint64_t> sum_a = 0;
+  std::atomic<uint64_t> sum_b = 0;
+  const auto run_job = [this](TaskJob* job, std::atomic<uint64_t>* sum) {
+    TaskManager::JobScope scope(job);
+    this->manager.ParallelFor(10, [&](const TaskInfo& outer) {
+      this->manager.ParallelFor(
+          1000, [&](const TaskInfo& inner) { *sum += inner.start_idx + outer.start_idx; });
+    });
+  };
+  std::thread thread_a(run_job, &job_a, &sum_a);
+  std::thread thread_b(run_job, &job_b, &sum_b);
+  thread_a.join();
+  thread_b.join();
+
+  const uint64_t expected_sum = 10 * (999 * 1000 / 2) + 1000 * (9 * 10 / 2);
+  EXPECT_EQ(expected_sum, sum_a);
+  EXPECT_EQ(expected_sum, sum_b);
+  EXPECT_GT(job_a.CpuTime().count(), 0);
+  EXPECT_GT(job_b.CpuTime().count(), 0);
+  EXPECT_EQ("a", job_a.Options().name);
+}
+
+TEST_P(TaskManagerTest, JobMaxThreads) {
+  TaskJob job(TaskJobOptions{/*priority=*/0, /*weight=*/1, /*max_threads=*/2, "capped"}, &manager);
+  std::atomic<size_t> n_running = 0;
+  std::atomic<size_t> max_running = 0;
+  {
+    TaskManager::JobScope scope(&job);
+    this->manager.ParallelFor(
+        NumThreads() * 8, [&](const TaskInfo& /*task_info*/) {
+          const size_t running = ++n_running;
+          size_t prev_max = max_running;
+          while (running > prev_max && !max_running.compare_exchange_weak(prev_max, running)) {
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+          --n_running;
+        });
+  }
+  // The cap is enforced by the work-stealing backend only.
+  if (std::get<1>(GetParam())) {
+    EXPECT_LE(max_running, 2U);
+  }
+}
+
+TEST_P(TaskManagerTest, JobException) {
+  TaskJob job(TaskJobOptions(), &manager);
+  TaskManager::JobScope scope(&job);
+  EXPECT_ASSERT(
+      this->manager.ParallelFor(
+          100, [](const TaskInfo& /*task_info*/) { THROW_STARKWARE_EXCEPTION("Job failed."); }),
+      HasSubstr("Job failed."));
+}
+
+std::set<size_t> n_threads_option = {1, 4, std::thread::hardware_concurrency()};
+
+std::string ParamName(const testing::TestParamInfo<std::tuple<size_t, bool>>& info) {
+  return std::to_string(std::get<0>(info.param)) +
+         (std::get<1>(info.param) ? "_WorkStealing" : "_GlobalQueue");
+}
 
 INSTANTIATE_TEST_CASE_P(
-    , TaskManagerTest, ::testing::ValuesIn(n_threads_option), testing::PrintToStringParamName());
+    , TaskManagerTest,
+    ::testing::Combine(::testing::ValuesIn(n_threads_option), ::testing::Bool()), ParamName);
 
 }  // namespace
 
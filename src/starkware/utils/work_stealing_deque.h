@@ -0,0 +1,157 @@
+#ifndef STARKWARE_UTILS_WORK_STEALING_DEQUE_H_
+#define STARKWARE_UTILS_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "starkware/error_handling/error_handling.h"
+#include "starkware/math/math.h"
+
+namespace starkware {
+
+/*
+  A Chase-Lev work-stealing deque of pointers.
+
+  The owner thread pushes and takes items at the bottom of the deque (LIFO), while any other thread
+  may steal items from the top (FIFO). Push() and Take() may only be called by the owner, Steal()
+  may be called concurrently by any thread. The deque grows as needed. Arrays that were replaced by
+  a larger one are kept until the deque is destroyed, since a concurrent Steal() may still read
+  them.
+
+  The implementation follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop,
+  Cohen and Zappa Nardelli, PPoPP 2013).
+*/
+template <typename T>
+class WorkStealingDeque {
+ public:
+  enum class StealResult { kSuccess, kEmpty, kAbort };
+
+  explicit WorkStealingDeque(size_t log_initial_capacity = 8) {
+    arrays_.push_back(std::make_unique<Array>(log_initial_capacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+
+  /*
+    Owner only. Adds an item at the bottom of the deque.
+  */
+  void Push(T* item) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Array* array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<int64_t>(array->Capacity()) - 1) {
+      array = Grow(array, top, bottom);
+    }
+    array->Put(bottom, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  /*
+    Owner only. Removes and returns the item at the bottom of the deque, or nullptr if the deque is
+    empty.
+  */
+  T* Take() {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* array = array_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // The deque is empty.
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T* item = array->Get(bottom);
+    if (top == bottom) {
+      // This is the last item, compete with the thieves on it.
+      if (!top_.compare_exchange_strong(
+              top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /*
+    Any thread. Tries to remove the item at the top of the deque. On success, the item is written to
+    item_out. kAbort means that the steal lost a race with another thread, and the deque may still
+    contain items.
+  */
+  StealResult Steal(T** item_out) {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return StealResult::kEmpty;
+    }
+
+    Array* array = array_.load(std::memory_order_acquire);
+    T* item = array->Get(top);
+    if (!top_.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return StealResult::kAbort;
+    }
+    *item_out = item;
+    return StealResult::kSuccess;
+  }
+
+  /*
+    Any thread. Returns true if the deque seems empty. The result may be stale.
+  */
+  bool Empty() const {
+    const int64_t top = top_.load(std::memory_order_relaxed);
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    return top >= bottom;
+  }
+
+ private:
+  /*
+    A circular array whose capacity is a power of two.
+  */
+  class Array {
+   public:
+    explicit Array(size_t log_capacity)
+        : mask_((uint64_t(1) << log_capacity) - 1), items_(mask_ + 1) {}
+
+    size_t Capacity() const { return mask_ + 1; }
+
+    T* Get(int64_t index) const {
+      return items_[static_cast<uint64_t>(index) & mask_].load(std::memory_order_relaxed);
+    }
+
+    void Put(int64_t index, T* item) {
+      items_[static_cast<uint64_t>(index) & mask_].store(item, std::memory_order_relaxed);
+    }
+
+   private:
+    const uint64_t mask_;
+    std::vector<std::atomic<T*>> items_;
+  };
+
+  Array* Grow(Array* array, int64_t top, int64_t bottom) {
+    const size_t log_capacity = SafeLog2(array->Capacity()) + 1;
+    arrays_.push_back(std::make_unique<Array>(log_capacity));
+    Array* new_array = arrays_.back().get();
+    for (int64_t i = top; i < bottom; ++i) {
+      new_array->Put(i, array->Get(i));
+    }
+    array_.store(new_array, std::memory_order_release);
+    return new_array;
+  }
+
+  std::atomic<int64_t> top_{0};
+  std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_{nullptr};
+
+  // All the arrays allocated by the deque. Accessed only by the owner.
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+}  // namespace starkware
+
+#endif  // STARKWARE_UTILS_WORK_STEALING_DEQUE_H_
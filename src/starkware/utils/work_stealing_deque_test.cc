@@ -0,0 +1,81 @@
+#include "starkware/utils/work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace starkware {
+namespace {
+
+using StealResult = WorkStealingDeque<int>::StealResult;
+
+TEST(WorkStealingDeque, TakeAndSteal) {
+  WorkStealingDeque<int> deque(1);
+  std::vector<int> items = {0, 1, 2, 3, 4};
+  EXPECT_TRUE(deque.Empty());
+  // Push more items than the initial capacity.
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_FALSE(deque.Empty());
+
+  // The owner takes from the bottom, thieves steal from the top.
+  EXPECT_EQ(&items[4], deque.Take());
+  int* stolen = nullptr;
+  EXPECT_EQ(StealResult::kSuccess, deque.Steal(&stolen));
+  EXPECT_EQ(&items[0], stolen);
+  EXPECT_EQ(&items[3], deque.Take());
+  EXPECT_EQ(&items[2], deque.Take());
+  EXPECT_EQ(&items[1], deque.Take());
+  EXPECT_EQ(nullptr, deque.Take());
+  EXPECT_EQ(StealResult::kEmpty, deque.Steal(&stolen));
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDeque, ConcurrentSteal) {
+  constexpr size_t kNItems = 100000;
+  constexpr size_t kNThieves = 3;
+  WorkStealingDeque<size_t> deque(2);
+  std::vector<size_t> items(kNItems);
+  std::vector<std::atomic<size_t>> counts(kNItems);
+  std::atomic<bool> done = false;
+
+  std::vector<std::thread> thieves;
+  for (size_t i = 0; i < kNThieves; ++i) {
+    thieves.emplace_back([&]() {
+      while (!done || !deque.Empty()) {
+        size_t* item = nullptr;
+        if (deque.Steal(&item) == WorkStealingDeque<size_t>::StealResult::kSuccess) {
+          counts[*item]++;
+        }
+      }
+    });
+  }
+
+  // The owner pushes all the items, and takes some of them.
+  for (size_t i = 0; i < kNItems; ++i) {
+    items[i] = i;
+    deque.Push(&items[i]);
+    if (i % 3 == 0) {
+      size_t* item = deque.Take();
+      if (item != nullptr) {
+        counts[*item]++;
+      }
+    }
+  }
+  done = true;
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  // Each item was taken exactly once.
+  for (const auto& count : counts) {
+    ASSERT_EQ(1U, count);
+  }
+}
+
+}  // namespace
+}  // namespace starkware